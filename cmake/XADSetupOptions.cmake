@@ -62,11 +62,13 @@ if(MSVC)
 endif()
 
 # Tape options: these end up in Config.hpp, a cmake-generated file
-option(XAD_TAPE_REUSE_SLOTS "Reuse slots in tape that have become free (slower, less memory)" OFF)
+option(XAD_TAPE_REUSE_SLOTS "Reuse slots in tape that have become free (slightly slower, less memory)" OFF)
 option(XAD_NO_THREADLOCAL "Disable thread-local tape - only for single-threaded tape use" OFF)
 option(XAD_USE_STRONG_INLINE "Use forced inlining for higher performance, at a higher compile time cost" OFF)
 option(XAD_ALLOW_INT_CONVERSION "Add real->int conversion operator, potentially missing to track dependencies" ON)
 option(XAD_REDUCED_MEMORY "Reduce memory required for tape, at a slight performance cost" OFF)
+option(XAD_TAPE_COMPRESSED "Store the tape in a compressed encoding (less memory, slower recording)" OFF)
+option(XAD_TAPE_FLOAT_MULTIPLIERS "Store the multipliers of double tapes in single precision (less memory, less accurate)" OFF)
 option(XAD_ENABLE_JIT "Enable JIT compilation support (record-once, compile-once, evaluate-many)" OFF)
 
 if(XAD_ENABLE_JIT)
@@ -76,3 +78,11 @@ endif()
 if(XAD_REDUCED_MEMORY)
     message(STATUS "Using reduced memory for tape storage at a slight performance cost")
 endif()
+
+if(XAD_TAPE_COMPRESSED)
+    message(STATUS "Using compressed tape storage")
+endif()
+
+if(XAD_TAPE_FLOAT_MULTIPLIERS)
+    message(STATUS "Using single-precision multipliers in double tapes")
+endif()
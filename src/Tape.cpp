@@ -33,7 +33,6 @@
 #include <XAD/UnaryOperators.hpp>
 
 #include <iostream>
-#include <numeric>
 #include <sstream>
 
 #if 0
@@ -63,8 +62,9 @@ Tape<T, N>::Tape(Tape&& o) noexcept
       derivatives_(std::move(o.derivatives_)),
       checkpoints_(std::move(o.checkpoints_)),
       callbacks_(std::move(o.callbacks_)),
+      slotFloor_(o.slotFloor_),
 #ifdef XAD_TAPE_REUSE_SLOTS
-      reusable_ranges_(std::move(o.reusable_ranges_)),
+      reusable_slots_(std::move(o.reusable_slots_)),
 #endif
       nestedRecordings_(std::move(o.nestedRecordings_)),
       currentRec_(o.currentRec_)
@@ -83,8 +83,9 @@ Tape<T, N>& Tape<T, N>::operator=(Tape&& o) noexcept
     derivatives_ = std::move(o.derivatives_);
     checkpoints_ = std::move(o.checkpoints_);
     callbacks_ = std::move(o.callbacks_);
+    slotFloor_ = o.slotFloor_;
 #ifdef XAD_TAPE_REUSE_SLOTS
-    reusable_ranges_ = std::move(o.reusable_ranges_);
+    reusable_slots_ = std::move(o.reusable_slots_);
 #endif
     nestedRecordings_ = std::move(o.nestedRecordings_);
     currentRec_ = o.currentRec_;
@@ -109,8 +110,9 @@ void Tape<T, N>::clearAll()
     statement_.clear();
     derivatives_.clear();
     checkpoints_.clear();
+    slotFloor_ = 0;
 #ifdef XAD_TAPE_REUSE_SLOTS
-    reusable_ranges_.clear();
+    reusable_slots_.clear();
 #endif
     while (!nestedRecordings_.empty()) nestedRecordings_.pop();
     statement_.push_back(std::make_pair(size_type(operations_.size()), slot_type(INVALID_SLOT)));
@@ -124,150 +126,14 @@ typename Tape<T, N>::size_type Tape<T, N>::getNumVariables() const
     return currentRec_->numDerivatives_;
 }
 
-#ifdef XAD_TAPE_REUSE_SLOTS
-template <class T, std::size_t N>
-typename Tape<T, N>::slot_type Tape<T, N>::registerVariableReuseSlots()
-{
-    // at the end
-    if (currentRec_->startRange_ == reusable_ranges_.end())
-        return registerVariableAtEnd();
-
-    // insert in a reusable slot
-    auto& first_range = *currentRec_->startRange_;
-    auto ret = first_range.insert();
-    if (first_range.isClosed())
-    {
-        if (currentRec_->latestRange_ == currentRec_->startRange_)
-            currentRec_->latestRange_ = reusable_ranges_.end();
-        auto nextRange = currentRec_->startRange_;
-        ++nextRange;
-        reusable_ranges_.erase(currentRec_->startRange_);
-        currentRec_->startRange_ = nextRange;
-        currentRec_->latestRange_ = nextRange;
-    }
-    return ret;
-}
-
-template <class T, std::size_t N>
-void Tape<T, N>::unregisterVariableReuseSlots(slot_type slot)
-{
-    --currentRec_->numDerivatives_;
-    if (slot == currentRec_->iDerivative_ - 1)  // it's at the end of the tape
-    {
-        --currentRec_->iDerivative_;
-        // if this brings us into a re-usable range, delete the last range and update iDerivative_
-        if (currentRec_->startRange_ != reusable_ranges_.end())
-        {
-            auto& last_range = reusable_ranges_.back();
-            if (currentRec_->iDerivative_ == last_range.second())
-            {
-                currentRec_->iDerivative_ = last_range.first();
-                auto it = reusable_ranges_.end();
-                --it;
-                if (currentRec_->latestRange_ == it)
-                    currentRec_->latestRange_ = reusable_ranges_.end();
-                if (it == currentRec_->startRange_)
-                {
-                    reusable_ranges_.pop_back();
-                    currentRec_->startRange_ = reusable_ranges_.end();
-                }
-                else
-                    reusable_ranges_.pop_back();
-            }
-        }
-    }
-    else  // not at the end of the tape
-    {
-        // unregistering in the middle of the tape requires inserting the slot into a reusable slot
-        // list at the right point
-        slot_range_type::ExpandResult status = slot_range_type::FAILED;
-        // if element is at start or end of an existing range, expand
-        if (currentRec_->startRange_ != reusable_ranges_.end() &&
-            currentRec_->latestRange_ != reusable_ranges_.end())
-        {
-            auto& currentRange = *currentRec_->latestRange_;
-            status = currentRange.expand(slot);
-        }
-
-        // if expanding failed, look over the other ranges to see if it fits
-        if (status == slot_range_type::FAILED)
-        {
-#ifndef NDEBUG
-            // make sure startRange is valid
-            bool isValid = currentRec_->startRange_ == reusable_ranges_.end();
-            for (auto it = reusable_ranges_.begin(), eit = reusable_ranges_.end(); it != eit; ++it)
-                isValid = isValid || currentRec_->startRange_ == it;
-            assert(isValid && "startRange is invalid");
-#endif
-            if (reusable_ranges_.empty() || slot > reusable_ranges_.back().second())
-            {
-                // insert a new range at the end
-                reusable_ranges_.emplace_back(slot, slot + 1);
-                currentRec_->latestRange_ = reusable_ranges_.end();
-                --currentRec_->latestRange_;
-                if (reusable_ranges_.size() == 1)
-                    currentRec_->startRange_ = currentRec_->latestRange_;
-            }
-            else
-            {
-                // it must fit into another range now - using binary search
-                auto it = std::lower_bound(currentRec_->startRange_, reusable_ranges_.end(), slot,
-                                           [](const slot_range_type& range, slot_type s)
-                                           { return range.second() < s; });
-                status = it->expand(slot);
-                if (status != slot_range_type::FAILED)
-                {
-                    currentRec_->latestRange_ = it;
-                }
-                else
-                {
-                    // insert a new range
-                    currentRec_->latestRange_ = reusable_ranges_.emplace(it, slot, slot + 1);
-                    if (it == currentRec_->startRange_)
-                        currentRec_->startRange_ = currentRec_->latestRange_;
-                }
-            }
-        }
-        // check if ranges can now be merged
-        if (status == slot_range_type::START &&
-            currentRec_->latestRange_ != currentRec_->startRange_)
-        {
-            auto it = currentRec_->latestRange_;
-            --it;
-            if (currentRec_->latestRange_->isJoinableStart(*it))
-            {
-                // merge two ranges
-                currentRec_->latestRange_->joinStart(*it);
-                if (it == currentRec_->startRange_)
-                    ++currentRec_->startRange_;
-                reusable_ranges_.erase(it);
-            }
-        }
-        else if (status == slot_range_type::END)
-        {
-            auto it = currentRec_->latestRange_;
-            ++it;
-            if (it != reusable_ranges_.end() && currentRec_->latestRange_->isJoinableEnd(*it))
-            {
-                currentRec_->latestRange_->joinEnd(*it);
-                if (currentRec_->startRange_ == it)
-                    ++currentRec_->startRange_;
-                reusable_ranges_.erase(it);
-            }
-        }
-    }
-}
-#endif
 
 template <class T, std::size_t N>
 std::string Tape<T, N>::getReusableSlotsString() const
 {
 #ifdef XAD_TAPE_REUSE_SLOTS
     std::stringstream sstr;
-    for (auto& i : reusable_ranges_)
-    {
-        sstr << i << ", ";
-    }
+    reusable_slots_.forEachRange([&sstr](slot_type first, slot_type last)
+                                 { sstr << slot_range_type(first, last) << ", "; });
     return sstr.str();
 #else
     return "";
@@ -278,7 +144,7 @@ template <class T, std::size_t N>
 typename Tape<T, N>::size_type Tape<T, N>::getNumReusableSlotSections() const
 {
 #ifdef XAD_TAPE_REUSE_SLOTS
-    return size_type(reusable_ranges_.size());
+    return size_type(reusable_slots_.numRanges());
 #else
     return 1U;
 #endif
@@ -288,8 +154,7 @@ template <class T, std::size_t N>
 typename Tape<T, N>::size_type Tape<T, N>::getNumReusableSlots() const
 {
 #ifdef XAD_TAPE_REUSE_SLOTS
-    return std::accumulate(reusable_ranges_.begin(), reusable_ranges_.end(), size_type(),
-                           [](size_type a, const slot_range_type& b) { return a + b.size(); });
+    return size_type(reusable_slots_.size());
 #else
     return 0U;
 #endif
@@ -319,7 +184,7 @@ void Tape<T, N>::foldSubrecording()
                          [=](const chkpt_type& ckpt, slot_type pos) { return ckpt.first < pos; });
     checkpoints_.erase(it, checkpoints_.end());
 #ifdef XAD_TAPE_REUSE_SLOTS
-    reusable_ranges_.erase(prev.startRange_, reusable_ranges_.end());
+    reusable_slots_.truncate(prev.reuseStart_);
 #endif
 }
 
@@ -337,8 +202,7 @@ void Tape<T, N>::newNestedRecording()
 {
     SubRecording newr(*currentRec_);
 #ifdef XAD_TAPE_REUSE_SLOTS
-    newr.startRange_ = reusable_ranges_.end();
-    newr.latestRange_ = newr.startRange_;
+    newr.reuseStart_ = reusable_slots_.position();
 #endif
     // clearDerivativesAfter(position_type(statement_.size())-1);
     derivatives_.resize(currentRec_->prevMax_);
@@ -376,10 +240,95 @@ void Tape<T, N>::newRecording()
     currentRec_->derivativesInitialized_ = false;
 }
 
+template <class T, std::size_t N>
+typename Tape<T, N>::size_type Tape<T, N>::compact(const std::vector<active_type*>& keep)
+{
+    if (nestedRecordings_.size() > 1 || !checkpoints_.empty())
+        throw Exception("tapes with checkpoints or nested recordings cannot be compacted");
+    if (isSpilling())
+        throw Exception("tapes spilling to disk cannot be compacted");
+#ifdef XAD_TAPE_COMPRESSED
+    (void)keep;
+    throw Exception("compressed tapes cannot be compacted");
+#else
+
+    // Replays the reverse sweep, handing out a new slot to each value of a variable when its
+    // adjoint is first accumulated and recycling it once the statement assigning that value
+    // has consumed it. Kept variables hold the first slots for the whole sweep.
+    const slot_type oldMax = currentRec_->maxDerivative_;
+    std::vector<slot_type> live(oldMax, INVALID_SLOT);  // old slot -> new slot
+    std::vector<slot_type> freeSlots;
+    slot_type count = 0;
+    std::vector<slot_type> keptSlots(keep.size(), INVALID_SLOT);
+    for (std::size_t i = 0; i < keep.size(); ++i)
+    {
+        slot_type s = keep[i]->slot_;
+        if (s == INVALID_SLOT)
+            continue;
+        if (s >= oldMax)
+            throw OutOfRange("variable to keep is not recorded on this tape");
+        if (live[s] == INVALID_SLOT)
+            live[s] = count++;
+        keptSlots[i] = live[s];
+    }
+    const slot_type numKept = count;
+
+    auto allocate = [&]()
+    {
+        if (freeSlots.empty())
+            return count++;
+        slot_type s = freeSlots.back();
+        freeSlots.pop_back();
+        return s;
+    };
+
+    for (std::size_t i = statement_.size() - 1; i > 0; --i)
+    {
+        auto& st = statement_[i];
+        slot_type target = live[st.second];
+        if (target == INVALID_SLOT)
+        {
+            // never read - any slot works, as its adjoint is zero
+            target = allocate();
+            freeSlots.push_back(target);
+        }
+        else if (target >= numKept)
+        {
+            freeSlots.push_back(target);
+            live[st.second] = INVALID_SLOT;
+        }
+        st.second = target;
+        operations_.for_each_slot(statement_[i - 1].first, st.first,
+                                  [&](slot_type& s)
+                                  {
+                                      if (live[s] == INVALID_SLOT)
+                                          live[s] = allocate();
+                                      s = live[s];
+                                  });
+    }
+
+    for (std::size_t i = 0; i < keep.size(); ++i)
+        if (keptSlots[i] != INVALID_SLOT)
+            keep[i]->slot_ = keptSlots[i];
+
+    // variables not kept still hold old slots, so new ones are handed out above them
+    currentRec_->iDerivative_ = (std::max)(currentRec_->iDerivative_, oldMax);
+    slotFloor_ = currentRec_->iDerivative_;
+#ifdef XAD_TAPE_REUSE_SLOTS
+    reusable_slots_.clear();
+    currentRec_->reuseStart_ = 0;
+#endif
+    currentRec_->maxDerivative_ = count;
+    currentRec_->derivativesInitialized_ = false;
+    std::vector<derivative_type>().swap(derivatives_);
+    return count;
+#endif
+}
+
 template <class T, std::size_t N>
 typename Tape<T, N>::size_type Tape<T, N>::getNumOperations() const
 {
-    return size_type(operations_.size());
+    return size_type(detail::numOperations(operations_));
 }
 
 template <class T, std::size_t N>
@@ -454,7 +403,7 @@ void Tape<T, N>::printStatus() const
     */
     /*
   #ifdef XAD_TAPE_REUSE_SLOTS
-    if (!reusable_ranges_.empty()) {
+    if (!reusable_slots_.empty()) {
       std::cout << "\n*** Gaps: ********\n";
       std::cout << getReusableSlotsString() << std::endl;
     }
@@ -470,7 +419,7 @@ void Tape<T, N>::printStatus() const
     }
     std::cout << "XAD Tape Info:\n"
               << "   Statements: " << statement_.size() - 1 << "\n"
-              << "   Operations: " << operations_.size() << "\n"
+              << "   Operations: " << detail::numOperations(operations_) << "\n"
               << "   Total der : " << currentRec_->maxDerivative_ << "\n"
               << "   Der alloc : " << derivatives_.size() << "\n"
               << "   curr der  : " << currentRec_->numDerivatives_ << "\n"
@@ -540,6 +489,21 @@ void Tape<T, N>::computeAdjointsToImpl(position_type pos, position_type start)
 
     if (pos == start)
         return;
+#ifdef XAD_TAPE_COMPRESSED
+    // the statements are decoded backwards from start
+    statement_.for_each_reverse(pos, start,
+                                [&](slot_type begin, slot_type end, slot_type lhs)
+                                {
+                                    auto a = derivatives_[lhs];
+                                    derivatives_[lhs] = derivative_type();
+                                    if (a != derivative_type())
+                                    {
+                                        operations_.for_each(
+                                            begin, end, [&](const T& mul, slot_type slot)
+                                            { derivatives_[slot] += mul * a; });
+                                    }
+                                });
+#else
     using s_type = typename TapeContainerTraits<T, slot_type>::statements_type;
     auto startchunk = s_type::getHighPart(start);
     auto idx = s_type::getLowPart(start);
@@ -556,6 +520,14 @@ void Tape<T, N>::computeAdjointsToImpl(position_type pos, position_type start)
     {
         if (chunk_it == chunk_eit + 1)
             endidx = endcidx;
+        if (XAD_VERY_UNLIKELY(statement_.spilling()))
+        {
+            // the last statement of the chunk before is read as well
+            auto c = size_type(chunk_it - statement_.chunk_begin());
+            statement_.load_chunk(c);
+            if (c > 0)
+                statement_.load_chunk(c - 1);
+        }
 
         for (auto it = (*chunk_it) + idx, eit = (*chunk_it) + endidx; it != eit; --it)
         {
@@ -584,17 +556,16 @@ void Tape<T, N>::computeAdjointsToImpl(position_type pos, position_type start)
 
         idx = chunksz - 1;
     }
+#endif
 }
 
 template <class T, std::size_t N>
 std::size_t Tape<T, N>::getMemory() const
 {
-    return sizeof(T) * (operations_.size() + derivatives_.size()) +
-           sizeof(slot_type) * (operations_.size() +
-                                // statement_endpoint_.size() + statement_slot_.size()
-                                2 * statement_.size())
+    return sizeof(T) * derivatives_.size() + detail::operationsMemory(operations_) +
+           detail::statementsMemory(statement_)
 #ifdef XAD_TAPE_REUSE_SLOTS
-           + sizeof(reusable_ranges_.front()) * reusable_ranges_.size()
+           + reusable_slots_.memory()
 #endif
            + checkpoints_.size() * sizeof(chkpt_type) +
            nestedRecordings_.size() * sizeof(nestedRecordings_.top())
@@ -602,6 +573,28 @@ std::size_t Tape<T, N>::getMemory() const
         ;
 }
 
+template <class T, std::size_t N>
+void Tape<T, N>::enableSpill(const std::string& directory)
+{
+    operations_.enable_spill(directory);
+    try
+    {
+        statement_.enable_spill(directory);
+    }
+    catch (...)
+    {
+        operations_.disable_spill();
+        throw;
+    }
+}
+
+template <class T, std::size_t N>
+void Tape<T, N>::disableSpill()
+{
+    operations_.disable_spill();
+    statement_.disable_spill();
+}
+
 template <class T, std::size_t N>
 void Tape<T, N>::clearDerivatives()
 {
@@ -648,25 +641,7 @@ void Tape<T, N>::resetTo(position_type pos)
         checkpoints_.erase(newend, checkpoints_.end());
     }
 #ifdef XAD_TAPE_REUSE_SLOTS
-    if (!reusable_ranges_.empty())
-    {
-        auto it = reusable_ranges_.end();
-        --it;
-        while (!reusable_ranges_.empty() && it->second() >= currentRec_->maxDerivative_)
-        {
-            if (it->first() >= currentRec_->maxDerivative_)
-            {
-                auto it2 = it;
-                --it2;
-                reusable_ranges_.erase(it);
-                it = it2;
-            }
-            else
-            {
-                it->second(currentRec_->maxDerivative_);
-            }
-        }
-    }
+    reusable_slots_.eraseFrom(currentRec_->maxDerivative_);
 #endif
 
     // clearDerivatives(getPosition());
@@ -710,7 +685,7 @@ bool Tape<T, N>::haveCallbacks() const
 template <class T, std::size_t N>
 void Tape<T, N>::clearDerivativesAfter(position_type pos)
 {
-    auto& st = statement_[pos];
+    auto st = statement_[pos];
     derivatives_.resize(st.second + 1);
     currentRec_->maxDerivative_ = st.second + 1;
 }
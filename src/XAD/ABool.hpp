@@ -68,8 +68,17 @@ class ABool
     slot_type slot() const { return slot_; }
     bool hasSlot() const { return slot_ != INVALID_SLOT; }
 
-    // Allow seamless use in existing bool contexts (for tape mode)
-    operator bool() const { return passive_; }
+    // Allow seamless use in existing bool contexts (for tape mode).
+    // While recording, this bakes the branch taken into the graph, so it is noted on the JIT.
+    operator bool() const
+    {
+        if (hasSlot())
+        {
+            if (auto* jit = jit_type::getActive())
+                jit->noteBakedCondition();
+        }
+        return passive_;
+    }
 
     // Core API: Conditional selection
     // Returns: trueVal if condition is true, falseVal otherwise.
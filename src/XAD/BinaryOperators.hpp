@@ -92,30 +92,34 @@ XAD_INLINE auto fma(const T1& a, const T2& b, const T3& c) -> decltype(a * b + c
     return a * b + c;
 }
 
-/////////// comparisons - they just return bool
+/////////// comparisons - they just return bool, noting the condition on an active JIT compiler
 
 #define XAD_COMPARE_OPERATOR(op)                                                                   \
     template <class Scalar, class Expr1, class Expr2, class DerivativeType>                        \
     XAD_INLINE bool operator op(const Expression<Scalar, Expr1, DerivativeType>& a,                \
                                 const Expression<Scalar, Expr2, DerivativeType>& b)                \
     {                                                                                              \
+        detail::noteJITCondition(a, b);                                                            \
         return value(a) op value(b);                                                               \
     }                                                                                              \
     template <class Scalar, class Expr, class DerivativeType>                                      \
     XAD_INLINE bool operator op(const typename ExprTraits<Expr>::value_type& a,                    \
                                 const Expression<Scalar, Expr, DerivativeType>& b)                 \
     {                                                                                              \
+        detail::noteJITCondition(a, b);                                                            \
         return value(a) op value(b);                                                               \
     }                                                                                              \
     template <class Scalar, class Expr, class DerivativeType>                                      \
     XAD_INLINE bool operator op(const Expression<Scalar, Expr, DerivativeType>& a,                 \
                                 const typename ExprTraits<Expr>::value_type& b)                    \
     {                                                                                              \
+        detail::noteJITCondition(a, b);                                                            \
         return value(a) op value(b);                                                               \
     }                                                                                              \
     template <class Scalar, std::size_t M = 1>                                                     \
     XAD_INLINE bool operator op(const AReal<Scalar, M>& a, const AReal<Scalar, M>& b)              \
     {                                                                                              \
+        detail::noteJITCondition(a, b);                                                            \
         return value(a) op value(b);                                                               \
     }                                                                                              \
     template <class Scalar, std::size_t N>                                                         \
@@ -183,12 +187,14 @@ XAD_INLINE auto fma(const T1& a, const T2& b, const T3& c) -> decltype(a * b + c
     XAD_INLINE bool operator op(typename ExprTraits<Expr>::nested_type a,                          \
                                 const Expression<Scalar, Expr, DerivativeType>& b)                 \
     {                                                                                              \
+        detail::noteJITCondition(b);                                                               \
         return a op value(b);                                                                      \
     }                                                                                              \
     template <class Scalar, class Expr, class DerivativeType>                                      \
     XAD_INLINE bool operator op(const Expression<Scalar, Expr, DerivativeType>& a,                 \
                                 typename ExprTraits<Expr>::nested_type b)                          \
     {                                                                                              \
+        detail::noteJITCondition(a);                                                               \
         return value(a) op b;                                                                      \
     }
 
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <XAD/AlignedAllocator.hpp>
+#include <XAD/ChunkSpill.hpp>
 #include <XAD/Exceptions.hpp>
 #include <XAD/Macros.hpp>
 #include <type_traits>
@@ -33,6 +34,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace xad
@@ -60,7 +62,10 @@ class ChunkContainer
     }
 
     ChunkContainer(ChunkContainer&& o) noexcept
-        : chunkList_(std::move(o.chunkList_)), chunk_(o.chunk_), idx_(o.idx_)
+        : chunkList_(std::move(o.chunkList_)),
+          chunk_(o.chunk_),
+          idx_(o.idx_),
+          spill_(std::move(o.spill_))
     {
         o.chunk_ = 0;
         o.idx_ = 0;
@@ -71,6 +76,7 @@ class ChunkContainer
         if (this != &o)
         {
             _free_memory();
+            spill_ = std::move(o.spill_);
             chunkList_ = std::move(o.chunkList_);
             chunk_ = o.chunk_;
             idx_ = o.idx_;
@@ -93,6 +99,11 @@ class ChunkContainer
             size_type d = nc - chunkList_.size();
             for (size_type i = 0; i < d; ++i)
             {
+                if (spill_)  // given a buffer when written to
+                {
+                    chunkList_.push_back(nullptr);
+                    continue;
+                }
                 char* chunk = reinterpret_cast<char*>(
                     AllocHelper::aligned_alloc(ALIGNMENT, sizeof(value_type) * chunk_size));
                 if (chunk == NULL)
@@ -142,6 +153,38 @@ class ChunkContainer
         destructAllImpl<std::is_trivially_destructible<value_type>::value>::make(this, size_type(0),
                                                                                  size());
         chunk_ = idx_ = 0;
+        if (spill_)
+            spill_->truncate(0, chunkList_, false);
+    }
+
+    // keep the completed chunks in a file in the given directory from now on
+    void enable_spill(const std::string& directory)
+    {
+        if (!std::is_trivially_copy_constructible<value_type>::value ||
+            !std::is_trivially_destructible<value_type>::value)
+            throw Exception("only containers of trivially copyable types can be spilled");
+        disable_spill();
+        spill_.reset(new detail::ChunkSpill<AllocHelper>(
+            directory, sizeof(value_type) * chunk_size, std::size_t(ALIGNMENT)));
+        spill_->writing(chunk_, chunkList_);
+    }
+    // read all chunks back into memory and stop spilling
+    void disable_spill()
+    {
+        if (!spill_)
+            return;
+        spill_->restoreAll(chunkList_);
+        spill_.reset();
+    }
+    bool spilling() const { return spill_ != nullptr; }
+    size_type spilled_chunks() const { return spill_ ? spill_->spilled() : 0; }
+    size_type spilled_bytes() const { return spill_ ? spill_->bytes() : 0; }
+
+    // make sure chunk c is in memory, for access through the chunk iterators
+    void load_chunk(size_type c)
+    {
+        if (XAD_VERY_UNLIKELY(chunkList_[c] == nullptr))
+            restore(c);
     }
 
     size_type capacity() const { return getNumElements(chunkList_.capacity()); }
@@ -158,6 +201,8 @@ class ChunkContainer
         {
             ++chunk_;
             idx_ = idx_ - chunk_size;
+            if (spill_)
+                spill_->writing(chunk_, chunkList_);
         }
     }
 
@@ -178,6 +223,8 @@ class ChunkContainer
         {
             ++chunk_;
             idx_ = 0;
+            if (spill_)
+                spill_->writing(chunk_, chunkList_);
         }
         ::new (reinterpret_cast<value_type*>(chunkList_[chunk_]) + idx_) value_type(v);
         ++idx_;
@@ -208,11 +255,16 @@ class ChunkContainer
                                                                                      size());
             chunk_ = getHighPart(s);
             idx_ = getLowPart(s);
+            if (spill_)
+                spill_->truncate(chunk_, chunkList_, true);
             return;
         }
 
         // now we have something bigger
         reserve(s);
+        if (spill_)
+            spill_->allocate(chunk_, (std::min)(getHighPart(s) + 1, chunkList_.size()),
+                             chunkList_);
         auto start_chunk = chunk_;
         auto end_chunk = getHighPart(s);
         auto start_idx = idx_;
@@ -242,13 +294,17 @@ class ChunkContainer
         {
             idx_ = chunk_size;
             chunk_ = end_chunk - 1;
-            return;
         }
-
-        // otherwise fill the last chunk
-        std::uninitialized_fill_n(reinterpret_cast<value_type*>(chunkList_[end_chunk]), end_idx, v);
-        chunk_ = end_chunk;
-        idx_ = end_idx;
+        else
+        {
+            // otherwise fill the last chunk
+            std::uninitialized_fill_n(reinterpret_cast<value_type*>(chunkList_[end_chunk]),
+                                      end_idx, v);
+            chunk_ = end_chunk;
+            idx_ = end_idx;
+        }
+        if (spill_)
+            spill_->writing(chunk_, chunkList_);
     }
 
     template <class It>
@@ -290,6 +346,8 @@ class ChunkContainer
         {
             auto n_second = n - n_first;
             ++chunk_;
+            if (spill_)
+                spill_->writing(chunk_, chunkList_);
             std::uninitialized_copy_n(first + n_first, n_second,
                                       reinterpret_cast<value_type*>(chunkList_[chunk_]));
             idx_ = n_second;
@@ -353,11 +411,14 @@ class ChunkContainer
 
     reference operator[](size_type i)
     {
+        load_chunk(getHighPart(i));
         return reinterpret_cast<pointer>(chunkList_[getHighPart(i)])[getLowPart(i)];
     }
 
     const_reference operator[](size_type i) const
     {
+        if (XAD_VERY_UNLIKELY(chunkList_[getHighPart(i)] == nullptr))
+            restore(getHighPart(i));
         return reinterpret_cast<const_pointer>(chunkList_[getHighPart(i)])[getLowPart(i)];
     }
 
@@ -370,23 +431,23 @@ class ChunkContainer
     static size_type getNumElements(size_type chunks) { return chunks * chunk_size; }
 
   private:
-    std::vector<char*> chunkList_;
+    // chunks spilled to a file are null, and read back on access
+    mutable std::vector<char*> chunkList_;
     size_type chunk_, idx_;
+    std::unique_ptr<detail::ChunkSpill<AllocHelper>> spill_;
+
+    XAD_NEVER_INLINE void restore(size_type c) const { spill_->restore(c, chunkList_); }
 
     void check_space()
     {
         if (XAD_VERY_LIKELY(chunk_ == chunkList_.size() - 1))
         {
-            char* chunk = reinterpret_cast<char*>(
-                AllocHelper::aligned_alloc(ALIGNMENT, sizeof(value_type) * chunk_size));
-            if (chunk == nullptr)
-            {
-                throw std::bad_alloc();
-            }
-            chunkList_.push_back(chunk);
+            reserve(getNumElements(chunkList_.size() + 1));
         }
         ++chunk_;
         idx_ = 0;
+        if (spill_)
+            spill_->writing(chunk_, chunkList_);
     }
 
     void check_space(size_type i) { reserve(chunk_ * chunk_size + idx_ + i); }
@@ -0,0 +1,336 @@
+/*******************************************************************************
+
+   ChunkSpill, used by the tape containers to keep completed chunks in a file
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#pragma once
+
+#include <XAD/AlignedAllocator.hpp>
+#include <XAD/Exceptions.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace xad
+{
+namespace detail
+{
+
+// the containers hold their chunks either as raw pointers or as unique_ptrs
+inline char* chunkPtr(char* p) { return p; }
+template <class D>
+char* chunkPtr(const std::unique_ptr<char, D>& p)
+{
+    return p.get();
+}
+inline char* takeChunk(char*& p)
+{
+    char* r = p;
+    p = nullptr;
+    return r;
+}
+template <class D>
+char* takeChunk(std::unique_ptr<char, D>& p)
+{
+    return p.release();
+}
+inline void setChunk(char*& p, char* v) { p = v; }
+template <class D>
+void setChunk(std::unique_ptr<char, D>& p, char* v)
+{
+    p.reset(v);
+}
+
+// Keeps the leading, completed chunks of a tape container in a file rather than in memory.
+// Chunks are written in the background as they are completed during recording, and read
+// back one by one when they are accessed again, normally in reverse during the adjoint
+// sweep - the chunk before is then read in the background. Only a few restored chunks are
+// held in memory at a time, so the memory use is bounded by a handful of chunks plus the
+// chunk being written. File operations run one at a time, each waiting for the last.
+// Buffers are freed through the call operator of AllocHelper, as it is the chunk deleter.
+template <class AllocHelper = AlignedAllocator>
+class ChunkSpill
+{
+  public:
+    static const std::size_t MAX_RESIDENT = 3;  // restored chunks held in memory
+    static const std::size_t MAX_POOLED = 2;    // free chunk buffers kept for re-use
+
+    ChunkSpill(const std::string& directory, std::size_t chunkBytes, std::size_t alignment)
+        : chunkBytes_(chunkBytes), alignment_(alignment)
+    {
+        static std::atomic<unsigned long> counter(0);
+        path_ = directory;
+        if (!path_.empty() && path_.back() != '/' && path_.back() != '\\')
+            path_ += '/';
+        path_ += "xad-tape-" + std::to_string(reinterpret_cast<std::uintptr_t>(this)) + "-" +
+                 std::to_string(counter++) + ".bin";
+        file_.open(path_.c_str(),
+                   std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file_)
+            throw Exception("cannot create tape spill file " + path_);
+    }
+
+    ChunkSpill(const ChunkSpill&) = delete;
+    ChunkSpill& operator=(const ChunkSpill&) = delete;
+
+    ~ChunkSpill()
+    {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+        }
+        release(prefetchBuf_);
+        for (auto p : pool_) AllocHelper()(p);
+        file_.close();
+        std::remove(path_.c_str());
+    }
+
+    // chunks [0, spilled()) are held in the file
+    std::size_t spilled() const { return spilled_; }
+    // bytes written to the file
+    std::size_t bytes() const { return fileChunks_ * chunkBytes_; }
+    const std::string& path() const { return path_; }
+
+    // chunk c is being written to: spills the completed chunks before it
+    template <class Chunks>
+    void writing(std::size_t c, Chunks& chunks)
+    {
+        for (; spilled_ < c; ++spilled_)
+        {
+            wait();
+            char* data = takeChunk(chunks[spilled_]);
+            assert(data != nullptr);
+            writeBuf_ = data;
+            std::size_t pos = spilled_;
+            pending_ = std::async(std::launch::async, [this, pos, data]() { write(pos, data); });
+            fileChunks_ = (std::max)(fileChunks_, spilled_ + 1);
+        }
+        allocate(c, c + 1, chunks);
+    }
+
+    // gives the chunks in [first, last) that are not in memory a buffer to be written to
+    template <class Chunks>
+    void allocate(std::size_t first, std::size_t last, Chunks& chunks)
+    {
+        for (std::size_t c = first; c < last; ++c)
+            if (chunkPtr(chunks[c]) == nullptr)
+                setChunk(chunks[c], buffer());
+    }
+
+    // reads spilled chunk c back into memory, and chunk c - 1 in the background
+    template <class Chunks>
+    void restore(std::size_t c, Chunks& chunks)
+    {
+        assert(c < spilled_);
+        if (chunkPtr(chunks[c]) == nullptr)
+        {
+            wait();
+            char* data;
+            if (prefetchBuf_ != nullptr && prefetchChunk_ == c)
+            {
+                data = prefetchBuf_;
+                prefetchBuf_ = nullptr;
+            }
+            else
+            {
+                data = buffer();
+                try
+                {
+                    read(c, data);
+                }
+                catch (...)
+                {
+                    release(data);
+                    throw;
+                }
+            }
+            setChunk(chunks[c], data);
+            resident_.push_back(c);
+            while (resident_.size() > MAX_RESIDENT)
+            {
+                release(takeChunk(chunks[resident_.front()]));
+                resident_.erase(resident_.begin());
+            }
+        }
+        else
+        {
+            auto it = std::find(resident_.begin(), resident_.end(), c);
+            if (it != resident_.end())
+            {
+                resident_.erase(it);
+                resident_.push_back(c);
+            }
+        }
+
+        if (c > 0 && chunkPtr(chunks[c - 1]) == nullptr &&
+            !(prefetchBuf_ != nullptr && prefetchChunk_ == c - 1))
+        {
+            wait();
+            release(prefetchBuf_);
+            prefetchBuf_ = buffer();
+            prefetchChunk_ = c - 1;
+            char* data = prefetchBuf_;
+            pending_ = std::async(std::launch::async, [this, c, data]() { read(c - 1, data); });
+        }
+    }
+
+    // the container has been resized back into chunk c, which is written to again from
+    // now on - it is read back if its contents are kept, and later chunks are dropped
+    template <class Chunks>
+    void truncate(std::size_t c, Chunks& chunks, bool keepContents)
+    {
+        if (c >= spilled_)
+            return;
+        wait();
+        if (prefetchBuf_ != nullptr && prefetchChunk_ >= c)
+        {
+            release(prefetchBuf_);
+            prefetchBuf_ = nullptr;
+        }
+        for (std::size_t r : resident_)
+            if (r != c)
+                release(takeChunk(chunks[r]));
+        resident_.clear();
+        if (chunkPtr(chunks[c]) == nullptr)
+        {
+            setChunk(chunks[c], buffer());
+            if (keepContents)
+                read(c, chunkPtr(chunks[c]));
+        }
+        spilled_ = c;
+    }
+
+    // reads all spilled chunks back into memory, to stop spilling
+    template <class Chunks>
+    void restoreAll(Chunks& chunks)
+    {
+        wait();
+        for (std::size_t c = 0; c < spilled_; ++c)
+        {
+            if (chunkPtr(chunks[c]) == nullptr)
+            {
+                if (prefetchBuf_ != nullptr && prefetchChunk_ == c)
+                {
+                    setChunk(chunks[c], prefetchBuf_);
+                    prefetchBuf_ = nullptr;
+                    continue;
+                }
+                setChunk(chunks[c], buffer());
+                read(c, chunkPtr(chunks[c]));
+            }
+        }
+        resident_.clear();
+        spilled_ = 0;
+    }
+
+  private:
+    // completes the pending file operation, rethrowing its errors
+    void wait()
+    {
+        if (pending_.valid())
+        {
+            try
+            {
+                pending_.get();
+            }
+            catch (...)
+            {
+                release(writeBuf_);
+                writeBuf_ = nullptr;
+                release(prefetchBuf_);
+                prefetchBuf_ = nullptr;
+                throw;
+            }
+        }
+        release(writeBuf_);
+        writeBuf_ = nullptr;
+    }
+
+    void write(std::size_t c, const char* data)
+    {
+        file_.seekp(std::streamoff(c) * std::streamoff(chunkBytes_));
+        file_.write(data, std::streamsize(chunkBytes_));
+        file_.flush();
+        if (!file_)
+            throw Exception("failed to write tape chunk to " + path_);
+    }
+
+    void read(std::size_t c, char* data)
+    {
+        file_.seekg(std::streamoff(c) * std::streamoff(chunkBytes_));
+        file_.read(data, std::streamsize(chunkBytes_));
+        if (!file_)
+            throw Exception("failed to read tape chunk from " + path_);
+    }
+
+    char* buffer()
+    {
+        if (!pool_.empty())
+        {
+            char* p = pool_.back();
+            pool_.pop_back();
+            return p;
+        }
+        char* p = reinterpret_cast<char*>(AllocHelper::aligned_alloc(alignment_, chunkBytes_));
+        if (p == nullptr)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    void release(char* p)
+    {
+        if (p == nullptr)
+            return;
+        if (pool_.size() < MAX_POOLED)
+            pool_.push_back(p);
+        else
+            AllocHelper()(p);
+    }
+
+    std::size_t chunkBytes_, alignment_;
+    std::string path_;
+    std::fstream file_;
+    std::future<void> pending_;
+    char* writeBuf_ = nullptr;     // the chunk being written by pending_
+    char* prefetchBuf_ = nullptr;  // the chunk read by pending_, or read already
+    std::size_t prefetchChunk_ = 0;
+    std::size_t spilled_ = 0;
+    std::size_t fileChunks_ = 0;
+    std::vector<std::size_t> resident_;  // restored chunks, least recently used first
+    std::vector<char*> pool_;
+};
+
+}  // namespace detail
+}  // namespace xad
@@ -25,6 +25,9 @@
 #pragma once
 #include <XAD/BinaryOperators.hpp>
 #include <XAD/Expression.hpp>
+#ifdef XAD_ENABLE_JIT
+#include <XAD/JITComplexKernels.hpp>
+#endif
 #include <XAD/Literals.hpp>
 #include <XAD/Traits.hpp>
 #include <XAD/UnaryOperators.hpp>
@@ -392,6 +395,20 @@ XAD_INLINE typename xad::ExprTraits<Derived>::value_type arg_impl(
 template <class T>
 XAD_INLINE T arg_impl(const std::complex<T>& z);
 
+#ifdef XAD_ENABLE_JIT
+// Records exp, log or sqrt of z as a pair of complex JIT nodes (CExp, CLog, CSqrt)
+// if a JIT compiler is recording z, returning false otherwise
+template <class T>
+XAD_INLINE bool recordJITComplex(JITOpCode, const std::complex<T>&, std::complex<T>&)
+{
+    return false;
+}
+
+template <class T, std::size_t N>
+XAD_INLINE bool recordJITComplex(JITOpCode op, const std::complex<xad::AReal<T, N>>& z,
+                                 std::complex<xad::AReal<T, N>>& result);
+#endif
+
 #if (defined(_MSC_VER) && (_MSC_VER < 1920) || (defined(__GNUC__) && __GNUC__ < 7)) &&             \
     !defined(__clang__)
 template <class Scalar, class Derived, class Deriv>
@@ -1765,6 +1782,11 @@ XAD_INLINE complex<xad::FReal<T, N>> exp(const complex<xad::FReal<T, N>>& z)
 template <class T, std::size_t N = 1>
 XAD_INLINE complex<xad::AReal<T, N>> log(const complex<xad::AReal<T, N>>& z)
 {
+#ifdef XAD_ENABLE_JIT
+    complex<xad::AReal<T, N>> recorded;
+    if (xad::detail::recordJITComplex(xad::JITOpCode::CLog, z, recorded))
+        return recorded;
+#endif
     return complex<xad::AReal<T, N>>(log(xad::detail::abs_impl(z)), xad::detail::arg_impl(z));
 }
 
@@ -2283,6 +2305,11 @@ XAD_INLINE std::complex<T> exp_impl(const std::complex<T>& z)
     using std::exp;
     using std::sin;
     typedef typename xad::ExprTraits<T>::nested_type nested;
+#ifdef XAD_ENABLE_JIT
+    std::complex<T> recorded;
+    if (recordJITComplex(JITOpCode::CExp, z, recorded))
+        return recorded;
+#endif
     if (xad::isinf(z.real()))
     {
         if (z.real() > 0.0)
@@ -2330,6 +2357,11 @@ template <class T>
 XAD_INLINE std::complex<T> sqrt_impl(const std::complex<T>& z)
 {
     typedef typename xad::ExprTraits<T>::nested_type nested;
+#ifdef XAD_ENABLE_JIT
+    std::complex<T> recorded;
+    if (recordJITComplex(JITOpCode::CSqrt, z, recorded))
+        return recorded;
+#endif
     if (xad::isinf(z.real()) && z.real() < 0.0)
     {
         if (xad::isfinite(z.imag()) && z.imag() > 0.0)
@@ -2631,6 +2663,51 @@ XAD_INLINE T arg_impl(const std::complex<T>& z)
     return atan2(z.imag(), z.real());
 }
 
+#ifdef XAD_ENABLE_JIT
+// higher-order types are not recorded by the JIT
+template <class T, std::size_t N>
+XAD_INLINE bool recordJITComplex(JITOpCode, const std::complex<xad::AReal<T, N>>&,
+                                 std::complex<xad::AReal<T, N>>&, std::false_type)
+{
+    return false;
+}
+
+template <class T, std::size_t N>
+XAD_INLINE bool recordJITComplex(JITOpCode op, const std::complex<xad::AReal<T, N>>& z,
+                                 std::complex<xad::AReal<T, N>>& result, std::true_type)
+{
+    typedef xad::AReal<T, N> areal_type;
+    auto* jit = xad::JITCompiler<T, N>::getActive();
+    if (!jit || areal_type::tape_type::getActive())
+        return false;
+    const areal_type& re = z.real();
+    const areal_type& im = z.imag();
+    if (!re.shouldRecord() && !im.shouldRecord())
+        return false;
+    // special values keep the handling of the generic implementation
+    const T a = re.getValue(), b = im.getValue();
+    if (!std::isfinite(a) || !std::isfinite(b))
+        return false;
+
+    uint32_t sa = re.shouldRecord() ? re.getSlot() : jit->recordConstant(double(a));
+    uint32_t sb = im.shouldRecord() ? im.getSlot() : jit->recordConstant(double(b));
+    result = std::complex<areal_type>(
+        jit->recordValueNode(op, sa, sb, 0.0, jitComplexEvaluate(op, a, b, 0.0)),
+        jit->recordValueNode(op, sa, sb, 1.0, jitComplexEvaluate(op, a, b, 1.0)));
+    return true;
+}
+
+template <class T, std::size_t N>
+XAD_INLINE bool recordJITComplex(JITOpCode op, const std::complex<xad::AReal<T, N>>& z,
+                                 std::complex<xad::AReal<T, N>>& result)
+{
+    return recordJITComplex(
+        op, z, result,
+        std::integral_constant<bool,
+                               std::is_same<T, typename xad::ExprTraits<T>::nested_type>::value>());
+}
+#endif
+
 template <class Scalar, class Derived, class Deriv>
 XAD_INLINE typename xad::ExprTraits<Derived>::value_type arg_impl(
     const xad::Expression<Scalar, Derived, Deriv>& x)
@@ -0,0 +1,585 @@
+/*******************************************************************************
+
+   Compressed tape containers, with variable-length encoded operations
+   and statements.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#pragma once
+
+#include <XAD/AlignedAllocator.hpp>
+#include <XAD/Exceptions.hpp>
+#include <XAD/Macros.hpp>
+
+#include <cassert>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xad
+{
+namespace detail
+{
+
+// LEB128 varints: 7 bits per byte, least significant first, with the high bit set on all
+// but the last byte. As the byte before a varint always has the high bit clear, they can
+// be read backwards as well.
+XAD_FORCE_INLINE unsigned char* putVarint(unsigned char* p, std::uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = static_cast<unsigned char>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<unsigned char>(v);
+    return p;
+}
+
+XAD_FORCE_INLINE std::uint64_t getVarint(const unsigned char*& p)
+{
+    if (XAD_LIKELY(*p < 0x80))
+        return *p++;
+    std::uint64_t v = *p & 0x7fu;
+    unsigned shift = 7;
+    while (*p++ & 0x80)
+    {
+        v |= std::uint64_t(*p & 0x7fu) << shift;
+        shift += 7;
+    }
+    return v;
+}
+
+// reads the varint ending before p, leaving p at its first byte
+XAD_FORCE_INLINE std::uint64_t getVarintBack(const unsigned char*& p)
+{
+    std::uint64_t v = *--p;
+    if (XAD_LIKELY(p[-1] < 0x80))
+        return v;
+    while (p[-1] & 0x80)
+    {
+        --p;
+        v = (v << 7) | (*p & 0x7fu);
+    }
+    return v;
+}
+
+// signed difference to - from in modular arithmetic, zigzag-encoded so small magnitudes
+// of either sign give small values
+template <class S>
+XAD_FORCE_INLINE std::uint64_t zigzag(S from, S to)
+{
+    typedef typename std::make_unsigned<S>::type U;
+    typedef typename std::make_signed<S>::type I;
+    const std::int64_t d =
+        static_cast<I>(static_cast<U>(static_cast<U>(to) - static_cast<U>(from)));
+    return (static_cast<std::uint64_t>(d) << 1) ^ static_cast<std::uint64_t>(d >> 63);
+}
+
+// the difference encoded by zigzag, to be added in modular arithmetic
+template <class S>
+XAD_FORCE_INLINE typename std::make_unsigned<S>::type unzigzag(std::uint64_t z)
+{
+    typedef typename std::make_unsigned<S>::type U;
+    return static_cast<U>((z >> 1) ^ (std::uint64_t(0) - (z & 1)));
+}
+
+// difference to - from in modular arithmetic, for values that do not decrease
+template <class S>
+XAD_FORCE_INLINE typename std::make_unsigned<S>::type difference(S from, S to)
+{
+    typedef typename std::make_unsigned<S>::type U;
+    return static_cast<U>(static_cast<U>(to) - static_cast<U>(from));
+}
+
+template <class S>
+XAD_FORCE_INLINE S addDelta(S from, typename std::make_unsigned<S>::type d)
+{
+    typedef typename std::make_unsigned<S>::type U;
+    return static_cast<S>(static_cast<U>(static_cast<U>(from) + d));
+}
+
+template <class S>
+XAD_FORCE_INLINE S subDelta(S from, typename std::make_unsigned<S>::type d)
+{
+    typedef typename std::make_unsigned<S>::type U;
+    return static_cast<S>(static_cast<U>(static_cast<U>(from) - d));
+}
+
+// multiplier types stored bitwise by the compressed operations - not std::is_floating_point,
+// as it is specialised for the active types
+template <class T>
+struct is_compressible_multiplier
+    : std::integral_constant<bool, std::is_same<T, float>::value ||
+                                       std::is_same<T, double>::value ||
+                                       std::is_same<T, long double>::value>
+{
+};
+
+// Byte stream held in chunks, addressed by position = chunk * ChunkBytes + offset.
+// Each chunk starts with a zero byte, so that varints can be read backwards up to
+// the start of its data, and records never straddle chunks.
+template <std::size_t ChunkBytes, class AllocHelper>
+class ByteChunks
+{
+  public:
+    typedef std::size_t size_type;
+    static const std::size_t ALIGNMENT = 128;
+    static const size_type DATA_START = 1;
+
+    ByteChunks() { clear(); }
+
+    size_type position() const { return chunk_ * ChunkBytes + idx_; }
+    size_type chunk() const { return chunk_; }
+    size_type chunks() const { return chunks_.size(); }
+    size_type capacity() const { return chunks_.size() * ChunkBytes; }
+
+    // a pointer to write up to n bytes to, moving on to the next chunk if they do not fit
+    XAD_FORCE_INLINE unsigned char* prepare(size_type n)
+    {
+        if (XAD_VERY_UNLIKELY(idx_ + n > ChunkBytes))
+            nextChunk();
+        return data(chunk_) + idx_;
+    }
+    XAD_FORCE_INLINE void commit(unsigned char* end)
+    {
+        idx_ = static_cast<size_type>(end - data(chunk_));
+    }
+
+    // the position of the next record after a record ending at pos
+    size_type next(size_type pos) const
+    {
+        size_type c = pos / ChunkBytes;
+        return pos % ChunkBytes == end(c) && c < chunk_ ? (c + 1) * ChunkBytes + DATA_START
+                                                        : pos;
+    }
+
+    void resize(size_type pos)
+    {
+        assert(pos <= position());
+        chunk_ = pos / ChunkBytes;
+        idx_ = pos % ChunkBytes;
+        ends_.resize(chunk_);
+    }
+
+    void clear()
+    {
+        if (chunks_.empty())
+            addChunk();
+        chunk_ = 0;
+        idx_ = DATA_START;
+        ends_.clear();
+    }
+
+    XAD_FORCE_INLINE unsigned char* data(size_type c)
+    {
+        return reinterpret_cast<unsigned char*>(chunks_[c].get());
+    }
+    XAD_FORCE_INLINE const unsigned char* data(size_type c) const
+    {
+        return reinterpret_cast<const unsigned char*>(chunks_[c].get());
+    }
+    XAD_FORCE_INLINE const unsigned char* at(size_type pos) const
+    {
+        return data(pos / ChunkBytes) + pos % ChunkBytes;
+    }
+    // the end of the data in chunk c
+    XAD_FORCE_INLINE size_type end(size_type c) const { return c < chunk_ ? ends_[c] : idx_; }
+
+  private:
+    void nextChunk()
+    {
+        ends_.push_back(idx_);
+        ++chunk_;
+        if (chunk_ == chunks_.size())
+            addChunk();
+        idx_ = DATA_START;
+    }
+
+    void addChunk()
+    {
+        auto chunk = AllocHelper::aligned_alloc(ALIGNMENT, ChunkBytes);
+        if (chunk == nullptr)
+            throw std::bad_alloc();
+        chunks_.emplace_back(reinterpret_cast<char*>(chunk));
+        *data(chunks_.size() - 1) = 0;
+    }
+
+    std::vector<std::unique_ptr<char, AllocHelper>> chunks_;
+    std::vector<size_type> ends_;  // ends of the data in the chunks before chunk_
+    size_type chunk_ = 0;
+    size_type idx_ = DATA_START;
+};
+
+}  // namespace detail
+
+// Operations of the tape as a byte stream, one record per append_n call (a statement):
+// the number of operands, followed by each slot as the zigzag-encoded difference to the
+// slot before in the record (to zero for the first), shifted left by two to hold the
+// multiplier's kind - +1, -1, exactly representable as float, or any other value - with
+// the multiplier bytes following for the latter two.
+// Positions, as returned by size() and taken by for_each and resize, are byte positions
+// at record boundaries; the number of operations is given by count().
+template <class T, class S, std::size_t ChunkBytes = 1024U * 1024U * 16U,
+          class AllocHelper = detail::AlignedAllocator>
+class CompressedOperations
+{
+  public:
+    using size_type = std::size_t;
+    using mul_type = T;
+    using slot_type = S;
+    static constexpr std::size_t chunk_size = ChunkBytes;
+    static_assert(detail::is_compressible_multiplier<mul_type>::value,
+                  "compressed operations require a floating point multiplier type");
+    static_assert(std::is_integral<slot_type>::value, "S type must be an integral type");
+
+    // operands per record, so that a record always fits into a chunk
+    static constexpr std::size_t MAX_OPERANDS = 256;
+    static constexpr std::size_t MAX_RECORD_BYTES = 10 + MAX_OPERANDS * (10 + sizeof(T));
+    static_assert(ChunkBytes > 2 * MAX_RECORD_BYTES, "chunks too small for a record");
+
+    enum Kind : unsigned
+    {
+        PLUS_ONE = 0,
+        MINUS_ONE = 1,
+        FLOAT = 2,
+        FULL = 3
+    };
+
+    bool empty() const { return size() == bytes_type::DATA_START; }
+    size_type size() const { return bytes_.position(); }
+    size_type count() const { return count_; }
+    size_type capacity() const { return bytes_.capacity(); }
+    size_type chunks() const { return bytes_.chunks(); }
+    // bytes in use
+    size_type memory() const { return bytes_.chunk() * ChunkBytes + bytes_.end(bytes_.chunk()); }
+
+    void reserve(size_type) {}
+
+    // truncates to a position returned by size() before
+    void resize(size_type s)
+    {
+        assert(s <= size());
+        count_ -= numOperations(s, size());
+        bytes_.resize(s);
+    }
+
+    void clear()
+    {
+        bytes_.clear();
+        count_ = 0;
+    }
+
+    void push_back(T multiplier, S slot) { append_n(&multiplier, &slot, 1); }
+
+    template <class MulIt, class SlotIt>
+    XAD_FORCE_INLINE void append_n(MulIt muls, SlotIt slots, size_type n)
+    {
+        while (XAD_VERY_UNLIKELY(n > MAX_OPERANDS))
+        {
+            appendRecord(muls, slots, MAX_OPERANDS);
+            muls += MAX_OPERANDS;
+            slots += MAX_OPERANDS;
+            n -= MAX_OPERANDS;
+        }
+        if (n != 0)
+            appendRecord(muls, slots, n);
+    }
+
+    // Apply the given function with the signature void f(mul_type, slot_type) to
+    // all elements between positions startidx and endidx
+    template <class Func>
+    XAD_FORCE_INLINE void for_each(size_type startidx, size_type endidx, Func f) const
+    {
+        while (XAD_VERY_UNLIKELY(startidx / ChunkBytes != endidx / ChunkBytes))
+        {
+            // records in the chunk before
+            size_type c = startidx / ChunkBytes;
+            decode(bytes_.at(startidx), bytes_.data(c) + bytes_.end(c), f);
+            startidx = (c + 1) * ChunkBytes + bytes_type::DATA_START;
+        }
+        decode(bytes_.at(startidx), bytes_.at(endidx), f);
+    }
+
+    // the number of operations between positions startidx and endidx
+    size_type numOperations(size_type startidx, size_type endidx) const
+    {
+        size_type n = 0;
+        for_each(startidx, endidx, [&n](const T&, S) { ++n; });
+        return n;
+    }
+
+    void enable_spill(const std::string&)
+    {
+        throw Exception("compressed tapes cannot be spilled to disk");
+    }
+    void disable_spill() {}
+    bool spilling() const { return false; }
+    size_type spilled_chunks() const { return 0; }
+    size_type spilled_bytes() const { return 0; }
+
+  private:
+    typedef detail::ByteChunks<ChunkBytes, AllocHelper> bytes_type;
+
+    template <class MulIt, class SlotIt>
+    XAD_FORCE_INLINE void appendRecord(MulIt muls, SlotIt slots, size_type n)
+    {
+        unsigned char* p = bytes_.prepare(MAX_RECORD_BYTES);
+        if (XAD_VERY_UNLIKELY(bytes_.position() + MAX_RECORD_BYTES > MAX_POSITION))
+            throw OutOfRange("compressed tape operations exceed the range of the slot type");
+        p = detail::putVarint(p, n);
+        S prev = S();
+        for (size_type i = 0; i < n; ++i)
+        {
+            const T m = static_cast<T>(*muls++);
+            const S slot = *slots++;
+            const std::uint64_t d = detail::zigzag(prev, slot) << 2;
+            prev = slot;
+            if (m == T(1))
+                p = detail::putVarint(p, d | PLUS_ONE);
+            else if (m == T(-1))
+                p = detail::putVarint(p, d | MINUS_ONE);
+            else if (sizeof(T) > sizeof(float) && m >= -T(FLT_MAX) && m <= T(FLT_MAX) &&
+                     T(static_cast<float>(m)) == m)
+            {
+                p = detail::putVarint(p, d | FLOAT);
+                const float fm = static_cast<float>(m);
+                std::memcpy(p, &fm, sizeof(float));
+                p += sizeof(float);
+            }
+            else
+            {
+                p = detail::putVarint(p, d | FULL);
+                std::memcpy(p, &m, sizeof(T));
+                p += sizeof(T);
+            }
+        }
+        bytes_.commit(p);
+        count_ += n;
+    }
+
+    template <class Func>
+    XAD_FORCE_INLINE static void decode(const unsigned char* p, const unsigned char* e, Func& f)
+    {
+        while (p < e)
+        {
+            std::uint64_t n = detail::getVarint(p);
+            S slot = S();
+            for (; n != 0; --n)
+            {
+                const std::uint64_t code = detail::getVarint(p);
+                slot = detail::addDelta(slot, detail::unzigzag<S>(code >> 2));
+                switch (code & 3)
+                {
+                    case PLUS_ONE:
+                        f(T(1), slot);
+                        break;
+                    case MINUS_ONE:
+                        f(T(-1), slot);
+                        break;
+                    case FLOAT:
+                    {
+                        float fm;
+                        std::memcpy(&fm, p, sizeof(float));
+                        p += sizeof(float);
+                        f(T(fm), slot);
+                        break;
+                    }
+                    default:
+                    {
+                        T m;
+                        std::memcpy(&m, p, sizeof(T));
+                        p += sizeof(T);
+                        f(m, slot);
+                    }
+                }
+            }
+        }
+    }
+
+    // positions are held in S by the tape
+    static constexpr size_type MAX_POSITION =
+        sizeof(S) < sizeof(size_type) ? size_type(std::numeric_limits<S>::max())
+                                      : std::numeric_limits<size_type>::max();
+
+    bytes_type bytes_;
+    size_type count_ = 0;
+};
+
+// Statements of the tape - pairs of the end position of their operations and the slot
+// assigned - as a byte stream of the differences to the statement before: the growth of
+// the position as a varint, and the slot difference as a zigzag-encoded varint.
+// Every BLOCK statements, the byte position of the record and the statement before are
+// kept for random access. The reverse sweep reads the records backwards from the end
+// instead (see for_each_reverse).
+template <class S, std::size_t ChunkBytes = 1024U * 1024U * 16U,
+          class AllocHelper = detail::AlignedAllocator>
+class CompressedStatements
+{
+  public:
+    typedef std::size_t size_type;
+    typedef std::pair<S, S> value_type;
+    static const std::size_t chunk_size = ChunkBytes;
+    static const size_type BLOCK = 64;
+    static const size_type MAX_RECORD_BYTES = 20;
+
+    CompressedStatements() : last_() {}
+
+    size_type size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // bytes in use
+    size_type memory() const
+    {
+        return bytes_.chunk() * ChunkBytes + bytes_.end(bytes_.chunk()) +
+               keys_.size() * sizeof(Key);
+    }
+
+    void reserve(size_type) {}
+
+    XAD_FORCE_INLINE void emplace_back(S pos, S slot) { push_back(value_type(pos, slot)); }
+
+    XAD_FORCE_INLINE void push_back(const value_type& v)
+    {
+        unsigned char* p = bytes_.prepare(MAX_RECORD_BYTES);
+        if (XAD_VERY_UNLIKELY(size_ % BLOCK == 0))
+            keys_.push_back(Key{bytes_.position(), last_});
+        p = detail::putVarint(p, detail::difference(last_.first, v.first));
+        p = detail::putVarint(p, detail::zigzag(last_.second, v.second));
+        bytes_.commit(p);
+        last_ = v;
+        ++size_;
+    }
+
+    value_type operator[](size_type i) const
+    {
+        size_type pos;
+        return find(i, pos);
+    }
+
+    // truncates to the first s statements
+    void resize(size_type s)
+    {
+        assert(s <= size_);
+        if (s == size_)
+            return;
+        if (s == 0)
+        {
+            clear();
+            return;
+        }
+        size_type pos;
+        last_ = find(s - 1, pos);
+        bytes_.resize(pos);
+        keys_.resize((s + BLOCK - 1) / BLOCK);
+        size_ = s;
+    }
+
+    void clear()
+    {
+        bytes_.clear();
+        keys_.clear();
+        last_ = value_type();
+        size_ = 0;
+    }
+
+    // Calls f(begin, end, slot) for the statements from last down to first + 1 (excluded),
+    // with [begin, end) the operations of the statement, that is from the end position of
+    // the statement before to its own.
+    template <class F>
+    XAD_FORCE_INLINE void for_each_reverse(size_type first, size_type last, F f) const
+    {
+        if (last <= first)
+            return;
+        size_type pos;
+        value_type v = find(last, pos);
+        size_type c = pos / ChunkBytes;
+        const unsigned char* p = bytes_.at(pos);
+        const unsigned char* start = bytes_.data(c) + DATA_START;
+        for (size_type k = last; k > first; --k)
+        {
+            if (XAD_VERY_UNLIKELY(p == start))
+            {
+                --c;
+                start = bytes_.data(c) + DATA_START;
+                p = bytes_.data(c) + bytes_.end(c);
+            }
+            const std::uint64_t ds = detail::getVarintBack(p);
+            const std::uint64_t dp = detail::getVarintBack(p);
+            const S begin = detail::subDelta(v.first, static_cast<U>(dp));
+            f(begin, v.first, v.second);
+            v.first = begin;
+            v.second = detail::subDelta(v.second, detail::unzigzag<S>(ds));
+        }
+    }
+
+    void enable_spill(const std::string&)
+    {
+        throw Exception("compressed tapes cannot be spilled to disk");
+    }
+    void disable_spill() {}
+    bool spilling() const { return false; }
+    size_type spilled_chunks() const { return 0; }
+    size_type spilled_bytes() const { return 0; }
+
+  private:
+    typedef typename std::make_unsigned<S>::type U;
+    static const size_type DATA_START = detail::ByteChunks<ChunkBytes, AllocHelper>::DATA_START;
+
+    struct Key
+    {
+        size_type position;  // of the first record in the block
+        value_type before;   // the statement before it
+    };
+
+    // decodes statement i from the start of its block, setting pos to the end of its record
+    value_type find(size_type i, size_type& pos) const
+    {
+        assert(i < size_);
+        const Key& key = keys_[i / BLOCK];
+        value_type v = key.before;
+        pos = key.position;
+        for (size_type k = i - i % BLOCK;; ++k)
+        {
+            pos = bytes_.next(pos);
+            const unsigned char* p = bytes_.at(pos);
+            const unsigned char* p0 = p;
+            v.first = detail::addDelta(v.first, static_cast<U>(detail::getVarint(p)));
+            v.second = detail::addDelta(v.second, detail::unzigzag<S>(detail::getVarint(p)));
+            pos += static_cast<size_type>(p - p0);
+            if (k == i)
+                return v;
+        }
+    }
+
+    detail::ByteChunks<ChunkBytes, AllocHelper> bytes_;
+    std::vector<Key> keys_;
+    value_type last_;
+    size_type size_ = 0;
+};
+
+}  // namespace xad
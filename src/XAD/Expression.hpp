@@ -38,6 +38,20 @@ struct DerivInfo
     typename TapeType::slot_type slots[N];
 };
 
+template <class Scalar, class Derived, class DerivativeType>
+struct Expression;
+
+namespace detail
+{
+// Tell an active JIT compiler that a C++ condition depends on the value of recorded
+// expressions, which bakes the branch taken into the graph. Defined in Literals.hpp.
+template <class Scalar, class Derived, class DerivativeType>
+void noteJITCondition(const Expression<Scalar, Derived, DerivativeType>& expr);
+template <class Scalar, class Derived1, class Derived2, class DerivativeType>
+void noteJITCondition(const Expression<Scalar, Derived1, DerivativeType>& a,
+                      const Expression<Scalar, Derived2, DerivativeType>& b);
+}  // namespace detail
+
 /// Represents a generic expression, for the Scalar base type.
 ///
 /// It uses the CTRP pattern, where derived classes register themselves with
@@ -86,7 +100,11 @@ struct Expression
 #endif
 
     // convert to boolean
-    XAD_INLINE explicit operator bool() const { return value() != Scalar(0); }
+    XAD_INLINE explicit operator bool() const
+    {
+        detail::noteJITCondition(*this);
+        return value() != Scalar(0);
+    }
 
     /// calculate the derivatives, given a tape object
     template <class Tape, int Size>
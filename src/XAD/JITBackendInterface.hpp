@@ -30,6 +30,7 @@
 
 #include <XAD/JITGraph.hpp>
 #include <cstddef>
+#include <stdexcept>
 
 namespace xad
 {
@@ -74,11 +75,30 @@ class JITBackend
     /// Set input values for an input variable (vectorWidth() values).
     virtual void setInput(std::size_t inputIndex, const Scalar* values) = 0;
 
+    /// Set all inputs at once. values holds numInputs() * vectorWidth() elements,
+    /// vectorWidth() consecutive values per input.
+    virtual void setInputs(const Scalar* values)
+    {
+        const std::size_t w = vectorWidth();
+        for (std::size_t i = 0, n = numInputs(); i < n; ++i) setInput(i, values + i * w);
+    }
+
     /// Execute forward pass only. Output array must have numOutputs() * vectorWidth() elements.
     virtual void forward(Scalar* outputs) = 0;
 
     /// Execute forward and backward passes. Output adjoints are seeded to 1.0.
     virtual void forwardAndBackward(Scalar* outputs, Scalar* inputGradients) = 0;
+
+    /// Execute forward and backward passes for numDirections adjoint directions in one sweep.
+    /// outputAdjoints holds numOutputs() * numDirections seeds and inputGradients receives
+    /// numInputs() * numDirections values, numDirections consecutive values per output / input.
+    /// Used by JITCompiler in vector mode (N > 1); supported by scalar backends only.
+    virtual void forwardAndBackwardSeeded(Scalar* /* outputs */, const Scalar* /* outputAdjoints */,
+                                          Scalar* /* inputGradients */,
+                                          std::size_t /* numDirections */)
+    {
+        throw std::runtime_error("Backend does not support seeded multi-direction adjoints");
+    }
 };
 
 }  // namespace xad
@@ -0,0 +1,541 @@
+/*******************************************************************************
+ *
+ *   Batch interpreter JIT backend, evaluating several input sets per pass.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITBatchInterpreter.hpp>
+#include <XAD/JITGraphPasses.hpp>
+#include <XAD/JITOpKernels.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace xad
+{
+
+template <class Scalar>
+struct JITBatchInterpreter<Scalar>::Impl
+{
+    std::size_t width;                // Lanes per node
+    JITMathAccuracy accuracy;         // Tier used for the vecmath kernels
+    const JITGraph* graph = nullptr;  // Stored from compile()
+    std::vector<Scalar> inputValues;  // width values per input
+    std::vector<Scalar> nodeValues;   // width values per node
+    std::vector<Scalar> nodeAdjoints; // width adjoints per node
+    std::vector<Scalar> scratch;      // 2 * width temporaries
+    std::vector<uint32_t> schedule;   // Nodes contributing to an output, in evaluation order
+    JITBranchAnalysis branches;       // If branch guards of the nodes
+    std::vector<char> guardState;     // Per guard: 0 = not yet known, 1 = some lanes, 2 = none
+    std::vector<char> guardLanes;     // width flags per guard, set for lanes taking the branch
+
+    Impl(std::size_t w, JITMathAccuracy acc) : width(w), accuracy(acc) {}
+
+    Scalar* values(uint32_t id) { return nodeValues.data() + id * width; }
+    Scalar* adjoints(uint32_t id) { return nodeAdjoints.data() + id * width; }
+};
+
+namespace
+{
+
+// Contribution to an adjoint in a lane whose node adjoint g may be zero: the scalar
+// interpreter skips such nodes, so a NaN or infinite partial (e.g. from a branch that
+// is not taken in this lane) must not turn 0 * partial into NaN here.
+template <class Scalar>
+inline Scalar masked(Scalar g, Scalar contribution)
+{
+    return g != Scalar(0) ? contribution : Scalar(0);
+}
+
+}  // namespace
+
+template <class Scalar>
+JITBatchInterpreter<Scalar>::JITBatchInterpreter(std::size_t width, JITMathAccuracy accuracy)
+    : impl_(new Impl(width, accuracy))
+{
+    if (width == 0)
+        throw std::invalid_argument("JITBatchInterpreter width must be positive");
+}
+
+template <class Scalar>
+JITBatchInterpreter<Scalar>::~JITBatchInterpreter() = default;
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::compile(const JITGraph& graph)
+{
+    const std::size_t w = impl_->width;
+    impl_->graph = &graph;
+    impl_->inputValues.assign(graph.input_ids.size() * w, Scalar(0));
+    impl_->nodeValues.assign(graph.nodeCount() * w, Scalar(0));
+    impl_->nodeAdjoints.assign(graph.nodeCount() * w, Scalar(0));
+    impl_->scratch.assign(2 * w, Scalar(0));
+
+    impl_->branches = analyzeJITBranches(graph);
+    impl_->guardState.assign(impl_->branches.guards.size(), 0);
+    impl_->guardLanes.assign(impl_->branches.guards.size() * w, 1);
+    impl_->schedule.clear();
+    for (uint32_t id : impl_->branches.schedule)
+    {
+        // constants are broadcast once here and never re-evaluated
+        if (graph.getOpCode(id) == JITOpCode::Constant)
+        {
+            std::size_t idx = static_cast<std::size_t>(graph.nodes[id].imm);
+            if (idx >= graph.const_pool.size())
+                throw std::runtime_error("const_pool index out of bounds");
+            std::fill_n(impl_->values(id), w, static_cast<Scalar>(graph.const_pool[idx]));
+            continue;
+        }
+        impl_->schedule.push_back(id);
+    }
+}
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::reset()
+{
+    impl_->graph = nullptr;
+    impl_->inputValues.clear();
+    impl_->nodeValues.clear();
+    impl_->nodeAdjoints.clear();
+    impl_->scratch.clear();
+    impl_->schedule.clear();
+    impl_->branches = JITBranchAnalysis();
+    impl_->guardState.clear();
+    impl_->guardLanes.clear();
+}
+
+template <class Scalar>
+std::size_t JITBatchInterpreter<Scalar>::vectorWidth() const
+{
+    return impl_->width;
+}
+
+template <class Scalar>
+std::size_t JITBatchInterpreter<Scalar>::numInputs() const
+{
+    return impl_->graph ? impl_->graph->input_ids.size() : 0;
+}
+
+template <class Scalar>
+std::size_t JITBatchInterpreter<Scalar>::numOutputs() const
+{
+    return impl_->graph ? impl_->graph->output_ids.size() : 0;
+}
+
+template <class Scalar>
+JITMathAccuracy JITBatchInterpreter<Scalar>::accuracy() const
+{
+    return impl_->accuracy;
+}
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::setInput(std::size_t inputIndex, const Scalar* values)
+{
+    if (!impl_->graph)
+        throw std::runtime_error("Backend not compiled");
+    if (inputIndex >= impl_->graph->input_ids.size())
+        throw std::runtime_error("Input index out of range");
+
+    std::copy_n(values, impl_->width, impl_->inputValues.data() + inputIndex * impl_->width);
+}
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::setInputs(const Scalar* values)
+{
+    if (!impl_->graph)
+        throw std::runtime_error("Backend not compiled");
+
+    std::copy_n(values, impl_->inputValues.size(), impl_->inputValues.begin());
+}
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::forward(Scalar* outputs)
+{
+    if (!impl_->graph)
+        throw std::runtime_error("Backend not compiled");
+
+    const JITGraph& graph = *impl_->graph;
+    const std::size_t w = impl_->width;
+
+    for (std::size_t i = 0; i < graph.input_ids.size(); ++i)
+        std::copy_n(impl_->inputValues.data() + i * w, w, impl_->values(graph.input_ids[i]));
+
+    // nodes exclusive to an If branch that no lane takes are skipped; in the other
+    // lanes their values are not selected and their adjoints are masked
+    const std::vector<uint32_t>& nodeGuard = impl_->branches.nodeGuard;
+    std::fill(impl_->guardState.begin(), impl_->guardState.end(), char(0));
+    impl_->guardState[0] = 1;
+    for (uint32_t id : impl_->schedule)
+    {
+        if (branchTaken(nodeGuard[id]))
+            evaluateNode(id);
+    }
+
+    for (std::size_t i = 0; i < graph.output_ids.size(); ++i)
+        std::copy_n(impl_->values(graph.output_ids[i]), w, outputs + i * w);
+}
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::forwardAndBackward(Scalar* outputs, Scalar* inputGradients)
+{
+    if (!impl_->graph)
+        throw std::runtime_error("Backend not compiled");
+
+    const JITGraph& graph = *impl_->graph;
+    const std::size_t w = impl_->width;
+
+    forward(outputs);
+
+    std::fill(impl_->nodeAdjoints.begin(), impl_->nodeAdjoints.end(), Scalar(0));
+    for (std::size_t i = 0; i < graph.output_ids.size(); ++i)
+        std::fill_n(impl_->adjoints(graph.output_ids[i]), w, Scalar(1));
+
+    const std::vector<uint32_t>& schedule = impl_->schedule;
+    const std::vector<uint32_t>& nodeGuard = impl_->branches.nodeGuard;
+    for (std::size_t i = schedule.size(); i > 0; --i)
+    {
+        uint32_t id = schedule[i - 1];
+        if (impl_->guardState[nodeGuard[id]] == 1)
+            propagateAdjoint(id);
+    }
+
+    for (std::size_t i = 0; i < graph.input_ids.size(); ++i)
+        std::copy_n(impl_->adjoints(graph.input_ids[i]), w, inputGradients + i * w);
+}
+
+template <class Scalar>
+bool JITBatchInterpreter<Scalar>::branchTaken(uint32_t guardId)
+{
+    char& state = impl_->guardState[guardId];
+    if (state == 0)
+    {
+        const JITBranchGuard& guard = impl_->branches.guards[guardId];
+        const std::size_t w = impl_->width;
+        char* lanes = impl_->guardLanes.data() + guardId * w;
+        bool any = false;
+        if (branchTaken(guard.parent))
+        {
+            const char* outer = impl_->guardLanes.data() + guard.parent * w;
+            const Scalar* cond = impl_->values(impl_->graph->nodes[guard.ifNode].a);
+            for (std::size_t l = 0; l < w; ++l)
+            {
+                lanes[l] = outer[l] && (cond[l] != Scalar(0)) == guard.side;
+                any = any || lanes[l];
+            }
+        }
+        state = any ? 1 : 2;
+    }
+    return state == 1;
+}
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::evaluateNode(uint32_t nodeId)
+{
+    const JITGraph& graph = *impl_->graph;
+    const auto& node = graph.nodes[nodeId];
+    const JITOpCode op = static_cast<JITOpCode>(node.op);
+    const std::size_t w = impl_->width;
+    const JITMathAccuracy acc = impl_->accuracy;
+    Scalar* r = impl_->values(nodeId);
+
+    switch (op)
+    {
+        case JITOpCode::Input:
+        case JITOpCode::Constant:
+            return;
+        case JITOpCode::Sum:
+        case JITOpCode::Dot:
+        {
+            const uint32_t* ids = graph.operand_pool.data() + node.a;
+            const uint32_t* ys = op == JITOpCode::Dot ? ids + node.b : nullptr;
+            for (std::size_t l = 0; l < w; ++l)
+                r[l] = jitPairwiseSum(impl_->nodeValues.data() + l, w, ids, ys, node.b);
+            return;
+        }
+        default: break;
+    }
+
+    const uint32_t n = static_cast<uint32_t>(graph.nodeCount());
+    const Scalar* va = impl_->values(node.a < n ? node.a : nodeId);
+    const Scalar* vb = impl_->values(node.b < n ? node.b : nodeId);
+    const Scalar* vc = impl_->values(node.c < n ? node.c : nodeId);
+
+    switch (op)
+    {
+        case JITOpCode::Add:
+            for (std::size_t l = 0; l < w; ++l) r[l] = va[l] + vb[l];
+            break;
+        case JITOpCode::Sub:
+            for (std::size_t l = 0; l < w; ++l) r[l] = va[l] - vb[l];
+            break;
+        case JITOpCode::Mul:
+            for (std::size_t l = 0; l < w; ++l) r[l] = va[l] * vb[l];
+            break;
+        case JITOpCode::Div:
+            for (std::size_t l = 0; l < w; ++l) r[l] = va[l] / vb[l];
+            break;
+        case JITOpCode::Neg:
+            for (std::size_t l = 0; l < w; ++l) r[l] = -va[l];
+            break;
+        case JITOpCode::Square:
+            for (std::size_t l = 0; l < w; ++l) r[l] = va[l] * va[l];
+            break;
+        case JITOpCode::Recip:
+            for (std::size_t l = 0; l < w; ++l) r[l] = Scalar(1) / va[l];
+            break;
+        case JITOpCode::Abs:
+            for (std::size_t l = 0; l < w; ++l) r[l] = std::abs(va[l]);
+            break;
+        case JITOpCode::Fma:
+            for (std::size_t l = 0; l < w; ++l) r[l] = jitFusedMulAdd(va[l], vb[l], vc[l]);
+            break;
+        case JITOpCode::Fms:
+            for (std::size_t l = 0; l < w; ++l) r[l] = jitFusedMulAdd(va[l], vb[l], -vc[l]);
+            break;
+        case JITOpCode::Fnma:
+            for (std::size_t l = 0; l < w; ++l) r[l] = jitFusedMulAdd(-va[l], vb[l], vc[l]);
+            break;
+        case JITOpCode::MulMul:
+            for (std::size_t l = 0; l < w; ++l) r[l] = va[l] * vb[l] * vc[l];
+            break;
+        case JITOpCode::DivAdd:
+            for (std::size_t l = 0; l < w; ++l) r[l] = va[l] / (vb[l] + vc[l]);
+            break;
+        case JITOpCode::If:
+            for (std::size_t l = 0; l < w; ++l) r[l] = (va[l] != Scalar(0)) ? vb[l] : vc[l];
+            break;
+        case JITOpCode::CmpLT:
+            for (std::size_t l = 0; l < w; ++l) r[l] = (va[l] < vb[l]) ? Scalar(1) : Scalar(0);
+            break;
+        case JITOpCode::CmpLE:
+            for (std::size_t l = 0; l < w; ++l) r[l] = (va[l] <= vb[l]) ? Scalar(1) : Scalar(0);
+            break;
+        case JITOpCode::CmpGT:
+            for (std::size_t l = 0; l < w; ++l) r[l] = (va[l] > vb[l]) ? Scalar(1) : Scalar(0);
+            break;
+        case JITOpCode::CmpGE:
+            for (std::size_t l = 0; l < w; ++l) r[l] = (va[l] >= vb[l]) ? Scalar(1) : Scalar(0);
+            break;
+        case JITOpCode::Sqrt: vecmath::sqrt(va, r, w, acc); break;
+        case JITOpCode::Exp: vecmath::exp(va, r, w, acc); break;
+        case JITOpCode::Log: vecmath::log(va, r, w, acc); break;
+        case JITOpCode::Pow: vecmath::pow(va, vb, r, w, acc); break;
+        case JITOpCode::Sin: vecmath::sin(va, r, w, acc); break;
+        case JITOpCode::Cos: vecmath::cos(va, r, w, acc); break;
+        case JITOpCode::Erf: vecmath::erf(va, r, w, acc); break;
+        case JITOpCode::Erfc: vecmath::erfc(va, r, w, acc); break;
+        default:
+            for (std::size_t l = 0; l < w; ++l)
+                r[l] = jitEvaluateOp(op, va[l], vb[l], vc[l], node.imm);
+            break;
+    }
+}
+
+template <class Scalar>
+void JITBatchInterpreter<Scalar>::propagateAdjoint(uint32_t nodeId)
+{
+    const JITGraph& graph = *impl_->graph;
+    const auto& node = graph.nodes[nodeId];
+    const JITOpCode op = static_cast<JITOpCode>(node.op);
+    const std::size_t w = impl_->width;
+    const JITMathAccuracy acc = impl_->accuracy;
+    const Scalar* g = impl_->adjoints(nodeId);
+
+    bool any = false;
+    for (std::size_t l = 0; l < w; ++l) any = any || g[l] != Scalar(0);
+    if (!any)
+        return;
+
+    switch (op)
+    {
+        case JITOpCode::Input:
+        case JITOpCode::Constant:
+            return;
+        case JITOpCode::Sum:
+        {
+            const uint32_t* ids = graph.operand_pool.data() + node.a;
+            for (uint32_t i = 0; i < node.b; ++i)
+            {
+                Scalar* ga = impl_->adjoints(ids[i]);
+                for (std::size_t l = 0; l < w; ++l) ga[l] += g[l];
+            }
+            return;
+        }
+        case JITOpCode::Dot:
+        {
+            const uint32_t* xs = graph.operand_pool.data() + node.a;
+            const uint32_t* ys = xs + node.b;
+            for (uint32_t i = 0; i < node.b; ++i)
+            {
+                const Scalar* x = impl_->values(xs[i]);
+                const Scalar* y = impl_->values(ys[i]);
+                Scalar* gx = impl_->adjoints(xs[i]);
+                Scalar* gy = impl_->adjoints(ys[i]);
+                for (std::size_t l = 0; l < w; ++l)
+                {
+                    Scalar xl = x[l], yl = y[l];
+                    gx[l] += masked(g[l], g[l] * yl);
+                    gy[l] += masked(g[l], g[l] * xl);
+                }
+            }
+            return;
+        }
+        default: break;
+    }
+
+    const uint32_t n = static_cast<uint32_t>(graph.nodeCount());
+    const uint32_t a = node.a < n ? node.a : nodeId;
+    const uint32_t b = node.b < n ? node.b : nodeId;
+    const uint32_t c = node.c < n ? node.c : nodeId;
+    const Scalar* va = impl_->values(a);
+    const Scalar* vb = impl_->values(b);
+    const Scalar* vc = impl_->values(c);
+    const Scalar* vr = impl_->values(nodeId);
+    Scalar* ga = impl_->adjoints(a);
+    Scalar* gb = impl_->adjoints(b);
+    Scalar* gc = impl_->adjoints(c);
+    Scalar* t = impl_->scratch.data();
+    Scalar* u = t + w;
+
+    switch (op)
+    {
+        case JITOpCode::Add:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += g[l];
+            for (std::size_t l = 0; l < w; ++l) gb[l] += g[l];
+            break;
+        case JITOpCode::Sub:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += g[l];
+            for (std::size_t l = 0; l < w; ++l) gb[l] -= g[l];
+            break;
+        case JITOpCode::Mul:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * vb[l]);
+            for (std::size_t l = 0; l < w; ++l) gb[l] += masked(g[l], g[l] * va[l]);
+            break;
+        case JITOpCode::Div:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] / vb[l]);
+            for (std::size_t l = 0; l < w; ++l)
+                gb[l] -= masked(g[l], g[l] * va[l] / (vb[l] * vb[l]));
+            break;
+        case JITOpCode::Neg:
+            for (std::size_t l = 0; l < w; ++l) ga[l] -= g[l];
+            break;
+        case JITOpCode::Square:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * Scalar(2) * va[l]);
+            break;
+        case JITOpCode::Recip:
+            for (std::size_t l = 0; l < w; ++l) ga[l] -= masked(g[l], g[l] / (va[l] * va[l]));
+            break;
+        case JITOpCode::Sqrt:
+            for (std::size_t l = 0; l < w; ++l)
+                ga[l] += masked(g[l], g[l] / (Scalar(2) * vr[l]));
+            break;
+        case JITOpCode::Exp:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * vr[l]);
+            break;
+        case JITOpCode::Log:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] / va[l]);
+            break;
+        case JITOpCode::Sin:
+            vecmath::cos(va, t, w, acc);
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * t[l]);
+            break;
+        case JITOpCode::Cos:
+            vecmath::sin(va, t, w, acc);
+            for (std::size_t l = 0; l < w; ++l) ga[l] -= masked(g[l], g[l] * t[l]);
+            break;
+        case JITOpCode::Erf:
+        case JITOpCode::Erfc:
+        {
+            const Scalar k = jitTwoOverSqrtPi<Scalar>();
+            for (std::size_t l = 0; l < w; ++l) u[l] = -va[l] * va[l];
+            vecmath::exp(u, t, w, acc);
+            if (op == JITOpCode::Erf)
+                for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * k * t[l]);
+            else
+                for (std::size_t l = 0; l < w; ++l) ga[l] -= masked(g[l], g[l] * k * t[l]);
+            break;
+        }
+        case JITOpCode::Pow:
+            for (std::size_t l = 0; l < w; ++l) u[l] = vb[l] - Scalar(1);
+            vecmath::pow(va, u, t, w, acc);
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * vb[l] * t[l]);
+            vecmath::log(va, t, w, acc);
+            for (std::size_t l = 0; l < w; ++l)
+                if (va[l] > Scalar(0))
+                    gb[l] += masked(g[l], g[l] * vr[l] * t[l]);
+            break;
+        case JITOpCode::Fma:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * vb[l]);
+            for (std::size_t l = 0; l < w; ++l) gb[l] += masked(g[l], g[l] * va[l]);
+            for (std::size_t l = 0; l < w; ++l) gc[l] += g[l];
+            break;
+        case JITOpCode::Fms:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * vb[l]);
+            for (std::size_t l = 0; l < w; ++l) gb[l] += masked(g[l], g[l] * va[l]);
+            for (std::size_t l = 0; l < w; ++l) gc[l] -= g[l];
+            break;
+        case JITOpCode::Fnma:
+            for (std::size_t l = 0; l < w; ++l) ga[l] -= masked(g[l], g[l] * vb[l]);
+            for (std::size_t l = 0; l < w; ++l) gb[l] -= masked(g[l], g[l] * va[l]);
+            for (std::size_t l = 0; l < w; ++l) gc[l] += g[l];
+            break;
+        case JITOpCode::MulMul:
+            for (std::size_t l = 0; l < w; ++l) ga[l] += masked(g[l], g[l] * vb[l] * vc[l]);
+            for (std::size_t l = 0; l < w; ++l) gb[l] += masked(g[l], g[l] * va[l] * vc[l]);
+            for (std::size_t l = 0; l < w; ++l) gc[l] += masked(g[l], g[l] * va[l] * vb[l]);
+            break;
+        case JITOpCode::If:
+            for (std::size_t l = 0; l < w; ++l)
+            {
+                if (va[l] != Scalar(0))
+                    gb[l] += g[l];
+                else
+                    gc[l] += g[l];
+            }
+            break;
+        case JITOpCode::CmpLT:
+        case JITOpCode::CmpLE:
+        case JITOpCode::CmpGT:
+        case JITOpCode::CmpGE:
+        case JITOpCode::CmpEQ:
+        case JITOpCode::CmpNE:
+            break;
+        default:
+            for (std::size_t l = 0; l < w; ++l)
+                if (g[l] != Scalar(0))
+                    jitPropagateOp(op, g[l], va[l], vb[l], vc[l], vr[l], node.imm, ga[l], gb[l],
+                                   gc[l]);
+            break;
+    }
+}
+
+// Explicit instantiations
+template class JITBatchInterpreter<float>;
+template class JITBatchInterpreter<double>;
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
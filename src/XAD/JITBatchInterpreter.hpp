@@ -0,0 +1,93 @@
+/**
+ *
+ *   Batch interpreter JIT backend, evaluating several input sets per pass.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITBackendInterface.hpp>
+#include <XAD/JITGraph.hpp>
+#include <XAD/JITVectorMath.hpp>
+#include <cstddef>
+#include <memory>
+
+namespace xad
+{
+
+/**
+ * @brief JITBackend that evaluates a JITGraph for vectorWidth() input sets at once.
+ *
+ * Node values are stored lane by lane for each node, and every node is evaluated
+ * for all lanes in one tight loop that the compiler can vectorise. Transcendental
+ * functions go through the vecmath kernels with the accuracy tier chosen at
+ * construction; with JITMathAccuracy::Libm each lane is bit-identical to
+ * JITGraphInterpreter.
+ *
+ * Nodes needed only by one branch of an If are skipped when no lane selects that
+ * branch; otherwise they are evaluated for all lanes and their adjoints are
+ * masked in the lanes that take the other branch.
+ *
+ * Inputs are set with setInput(i, values), where values holds one entry per lane.
+ * Outputs and input gradients are returned lane-contiguous per output / input.
+ */
+template <class Scalar>
+class JITBatchInterpreter : public JITBackend<Scalar>
+{
+  public:
+    explicit JITBatchInterpreter(std::size_t width = 8,
+                                 JITMathAccuracy accuracy = JITMathAccuracy::Libm);
+    ~JITBatchInterpreter() override;
+
+    void compile(const JITGraph& graph) override;
+    void reset() override;
+
+    std::size_t vectorWidth() const override;
+    std::size_t numInputs() const override;
+    std::size_t numOutputs() const override;
+
+    void setInput(std::size_t inputIndex, const Scalar* values) override;
+    void setInputs(const Scalar* values) override;
+    void forward(Scalar* outputs) override;
+    void forwardAndBackward(Scalar* outputs, Scalar* inputGradients) override;
+
+    JITMathAccuracy accuracy() const;
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+
+    bool branchTaken(uint32_t guardId);
+    void evaluateNode(uint32_t nodeId);
+    void propagateAdjoint(uint32_t nodeId);
+};
+
+// Declare external explicit instantiations
+extern template class JITBatchInterpreter<float>;
+extern template class JITBatchInterpreter<double>;
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
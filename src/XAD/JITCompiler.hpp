@@ -31,10 +31,14 @@
 #include <XAD/JITBackendInterface.hpp>
 #include <XAD/JITGraph.hpp>
 #include <XAD/JITGraphInterpreter.hpp>
+#include <XAD/JITGraphStats.hpp>
+#include <XAD/JITValidation.hpp>
 #include <XAD/Macros.hpp>
 #include <XAD/Tape.hpp>
 #include <XAD/Traits.hpp>
+#include <algorithm>
 #include <complex>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -48,8 +52,6 @@ template <class Real, std::size_t N = 1>
 class JITCompiler
 {
   public:
-    static_assert(N == 1, "JITCompiler only supports scalar mode (N=1).");
-
     typedef unsigned int size_type;
     typedef unsigned int slot_type;
     typedef slot_type position_type;
@@ -58,6 +60,10 @@ class JITCompiler
     typedef JITCompiler<Real, N> jit_type;
     typedef typename DerivativesTraits<Real, N>::type derivative_type;
     typedef Tape<Real, N> tape_type;
+    /// Records the function compiled by this JIT on a tape, from the inputs in registration order
+    typedef std::function<void(const std::vector<active_type>& inputs,
+                               std::vector<active_type>& outputs)>
+        validation_function;
 
     // Default constructor - uses interpreter backend
     explicit JITCompiler(bool activate = true)
@@ -94,11 +100,24 @@ class JITCompiler
             backend_->reset();
     }
 
+    JITBackend<Real>* getBackend() const { return backend_.get(); }
+
     JITCompiler(JITCompiler&& other) noexcept
         : graph_(std::move(other.graph_)),
           backend_(std::move(other.backend_)),
           inputValues_(std::move(other.inputValues_)),
-          derivatives_(std::move(other.derivatives_))
+          derivatives_(std::move(other.derivatives_)),
+          inputBuffer_(std::move(other.inputBuffer_)),
+          outputBuffer_(std::move(other.outputBuffer_)),
+          gradientBuffer_(std::move(other.gradientBuffer_)),
+          seedBuffer_(std::move(other.seedBuffer_)),
+          inputSlotEnd_(other.inputSlotEnd_),
+          bakedConditions_(std::move(other.bakedConditions_)),
+          validation_(std::move(other.validation_)),
+          validationSampleEvery_(other.validationSampleEvery_),
+          validationTolerance_(other.validationTolerance_),
+          validationThrows_(other.validationThrows_),
+          validationStats_(other.validationStats_)
     {
         if (other.isActive())
         {
@@ -118,6 +137,17 @@ class JITCompiler
             backend_ = std::move(other.backend_);
             inputValues_ = std::move(other.inputValues_);
             derivatives_ = std::move(other.derivatives_);
+            inputBuffer_ = std::move(other.inputBuffer_);
+            outputBuffer_ = std::move(other.outputBuffer_);
+            gradientBuffer_ = std::move(other.gradientBuffer_);
+            seedBuffer_ = std::move(other.seedBuffer_);
+            inputSlotEnd_ = other.inputSlotEnd_;
+            bakedConditions_ = std::move(other.bakedConditions_);
+            validation_ = std::move(other.validation_);
+            validationSampleEvery_ = other.validationSampleEvery_;
+            validationTolerance_ = other.validationTolerance_;
+            validationThrows_ = other.validationThrows_;
+            validationStats_ = other.validationStats_;
             if (other.isActive())
             {
                 other.deactivate();
@@ -159,6 +189,7 @@ class JITCompiler
         std::size_t numInputs = inputValues_.size();
         graph_.clear();
         derivatives_.clear();
+        bakedConditions_.clear();
         if (backend_)
             backend_->reset();
         for (std::size_t i = 0; i < numInputs; ++i)
@@ -216,8 +247,71 @@ class JITCompiler
 
     uint32_t recordConstant(double value) { return graph_.addConstant(value); }
 
+    /// Records a node with operand a and immediate imm whose value is computed by the
+    /// backend, and returns a variable referring to it that holds the value v.
+    active_type recordValueNode(JITOpCode op, uint32_t a, double imm, Real v)
+    {
+        active_type result(v);
+        result.slot_ = graph_.addNode(op, a, 0, 0, imm);
+        return result;
+    }
+
+    /// As above, for a node with operands a and b.
+    active_type recordValueNode(JITOpCode op, uint32_t a, uint32_t b, double imm, Real v)
+    {
+        active_type result(v);
+        result.slot_ = graph_.addNode(op, a, b, 0, imm);
+        return result;
+    }
+
+    /// Notes that a C++ condition depended on the value of a recorded variable, so the
+    /// branch taken while recording is baked into the graph. Called by comparisons and
+    /// bool conversions of recorded variables and ABool conditions.
+    void noteBakedCondition() { bakedConditions_.push_back(graph_.nodeCount()); }
+
+    /// Number of baked conditions in the current recording. Nonzero means the graph may
+    /// only be valid for inputs that take the same branches; use ABool::If instead.
+    std::size_t numBakedConditions() const { return bakedConditions_.size(); }
+
+    /// Node count of the graph at each baked condition, to locate them in the recording.
+    const std::vector<std::size_t>& bakedConditions() const { return bakedConditions_; }
+
+    /// Validation mode: every sampleEvery-th call of computeAdjoints() also runs f on a
+    /// Tape, at the same inputs and with the same output seeds, and compares the values
+    /// and input derivatives. A relative error above tolerance is a mismatch, which
+    /// throws JITValidationError if throwOnMismatch is set and is counted either way.
+    void enableValidation(validation_function f, std::size_t sampleEvery = 1,
+                          double tolerance = 1e-10, bool throwOnMismatch = true)
+    {
+        validation_ = std::move(f);
+        validationSampleEvery_ = (std::max)(sampleEvery, std::size_t(1));
+        validationTolerance_ = tolerance;
+        validationThrows_ = throwOnMismatch;
+        validationStats_ = JITValidationStats();
+    }
+
+    void disableValidation() { validation_ = nullptr; }
+    bool isValidating() const { return bool(validation_); }
+    const JITValidationStats& validationStats() const { return validationStats_; }
+
     /// Compile the recorded graph. Must be called before execution methods.
-    void compile() { backend_->compile(graph_); }
+    /// Also sizes the buffers used by forward() and computeAdjoints(), so that
+    /// replaying the compiled graph does not allocate.
+    void compile()
+    {
+        backend_->compile(graph_);
+
+        const std::size_t width = backend_->vectorWidth();
+        inputBuffer_.assign(inputValues_.size() * width, Real());
+        outputBuffer_.assign(graph_.output_ids.size() * width, Real());
+        gradientBuffer_.assign(graph_.input_ids.size() * (N > 1 ? N : width), Real());
+        seedBuffer_.assign(N > 1 ? graph_.output_ids.size() * N : 0, Real());
+        inputSlotEnd_ = 0;
+        for (auto id : graph_.input_ids)
+            inputSlotEnd_ = (std::max)(inputSlotEnd_, std::size_t(id) + 1);
+        if (derivatives_.size() < inputSlotEnd_)
+            derivatives_.resize(inputSlotEnd_, derivative_type());
+    }
 
     std::size_t vectorWidth() const { return backend_->vectorWidth(); }
     std::size_t numInputs() const { return backend_->numInputs(); }
@@ -229,13 +323,10 @@ class JITCompiler
     }
 
     /// Execute forward pass using registered input pointers.
+    /// For backends with vectorWidth() > 1, each input value is broadcast to all lanes.
     void forward(Real* outputs)
     {
-        for (std::size_t i = 0; i < inputValues_.size(); ++i)
-        {
-            Real value = *inputValues_[i];
-            backend_->setInput(i, &value);
-        }
+        uploadRegisteredInputs();
         backend_->forward(outputs);
     }
 
@@ -245,24 +336,43 @@ class JITCompiler
     }
 
     /// Compute adjoints using registered input pointers.
+    /// Only the derivatives of the inputs are written.
+    /// In vector mode (N > 1), the output derivatives set before the call are the seeds of
+    /// the N directions, which the backend propagates in a single backward sweep.
     void computeAdjoints()
     {
-        std::size_t nInputs = graph_.input_ids.size();
-        std::size_t nOutputs = graph_.output_ids.size();
+        const std::size_t width = backend_->vectorWidth();
+        uploadRegisteredInputs();
 
-        for (std::size_t i = 0; i < inputValues_.size(); ++i)
+        // sized by compile(), so this does not allocate when replaying
+        outputBuffer_.resize(graph_.output_ids.size() * width);
+        std::size_t stride = width;
+        if (N == 1)
         {
-            Real value = *inputValues_[i];
-            backend_->setInput(i, &value);
+            gradientBuffer_.resize(graph_.input_ids.size() * width);
+            backend_->forwardAndBackward(outputBuffer_.data(), gradientBuffer_.data());
+        }
+        else
+        {
+            stride = N;
+            seedBuffer_.resize(graph_.output_ids.size() * N);
+            gradientBuffer_.resize(graph_.input_ids.size() * N);
+            for (std::size_t o = 0; o < graph_.output_ids.size(); ++o)
+                for (std::size_t d = 0; d < N; ++d)
+                    seedBuffer_[o * N + d] = component(derivative(graph_.output_ids[o]), d);
+            backend_->forwardAndBackwardSeeded(outputBuffer_.data(), seedBuffer_.data(),
+                                               gradientBuffer_.data(), N);
         }
 
-        std::vector<Real> outputs(nOutputs);
-        std::vector<Real> inputGradients(nInputs);
-        backend_->forwardAndBackward(outputs.data(), inputGradients.data());
+        // all lanes see the same inputs, so lane 0 holds the gradient
+        if (derivatives_.size() < inputSlotEnd_)
+            derivatives_.resize(inputSlotEnd_, derivative_type());
+        for (std::size_t i = 0; i < graph_.input_ids.size(); ++i)
+            for (std::size_t d = 0; d < N; ++d)
+                component(derivatives_[graph_.input_ids[i]], d) = gradientBuffer_[i * stride + d];
 
-        derivatives_.resize(graph_.nodeCount(), derivative_type());
-        for (std::size_t i = 0; i < nInputs; ++i)
-            derivatives_[graph_.input_ids[i]] = static_cast<derivative_type>(inputGradients[i]);
+        if (validation_ && validationStats_.replays++ % validationSampleEvery_ == 0)
+            validateReplay(width, stride);
     }
 
     derivative_type& derivative(slot_type s)
@@ -302,19 +412,134 @@ class JITCompiler
         graph_.clear();
         inputValues_.clear();
         derivatives_.clear();
+        bakedConditions_.clear();
         if (backend_)
             backend_->reset();
     }
 
-    std::size_t getMemory() const { return graph_.nodeCount() * 32 + derivatives_.size() * sizeof(derivative_type); }
+    std::size_t getMemory() const
+    {
+        return graph_.memory() + derivatives_.size() * sizeof(derivative_type);
+    }
+
+    /// Statistics of the recorded graph, with replay traffic estimated for Real values.
+    JITGraphStats getStats() const { return computeJITGraphStats(graph_, sizeof(Real)); }
+
     position_type getPosition() const { return static_cast<position_type>(graph_.nodeCount()); }
 
   private:
+    // Direction d of a derivative, for both scalar and vector mode
+    static Real& component(Real& d, std::size_t) { return d; }
+    static const Real& component(const Real& d, std::size_t) { return d; }
+    template <class V>
+    static auto component(V& d, std::size_t i) -> decltype(d[i])
+    {
+        return d[i];
+    }
+
+    void uploadRegisteredInputs()
+    {
+        const std::size_t width = backend_->vectorWidth();
+        const std::size_t n = inputValues_.size();
+        inputBuffer_.resize(n * width);
+        for (std::size_t i = 0; i < n; ++i)
+            std::fill_n(inputBuffer_.data() + i * width, width, *inputValues_[i]);
+        if (n == backend_->numInputs())
+        {
+            backend_->setInputs(inputBuffer_.data());
+            return;
+        }
+        // registered inputs and compiled graph disagree - let the backend check each index
+        for (std::size_t i = 0; i < n; ++i)
+            backend_->setInput(i, inputBuffer_.data() + i * width);
+    }
+
+    // Restores the tape and JIT compiler active on this thread when going out of scope
+    struct ActiveRestorer
+    {
+        tape_type* tape;
+        JITCompiler* jit;
+
+        ~ActiveRestorer()
+        {
+            tape_type::deactivateAll();
+            if (tape)
+                tape->activate();
+            active_jit_ = jit;
+        }
+    };
+
+    // Runs the validation function on a tape and compares it with the last replay,
+    // whose outputs and gradients are in the buffers with the given strides
+    void validateReplay(std::size_t outputStride, std::size_t gradientStride)
+    {
+        ++validationStats_.checks;
+        ActiveRestorer restore = {tape_type::getActive(), active_jit_};
+        tape_type::deactivateAll();
+        active_jit_ = nullptr;
+
+        tape_type tape;
+        std::vector<active_type> x(inputValues_.size()), y;
+        for (std::size_t i = 0; i < x.size(); ++i)
+            x[i] = *inputValues_[i];
+        tape.registerInputs(x);
+        tape.newRecording();
+        validation_(x, y);
+        const std::size_t numOutputs = graph_.output_ids.size();
+        if (y.size() != numOutputs)
+            throw JITValidationError("validation function returned " + std::to_string(y.size()) +
+                                     " outputs, the JIT graph has " +
+                                     std::to_string(numOutputs));
+        tape.registerOutputs(y);
+        for (std::size_t o = 0; o < numOutputs; ++o)
+            for (std::size_t d = 0; d < N; ++d)
+                component(y[o].derivative(), d) =
+                    N == 1 ? Real(1) : component(derivative(graph_.output_ids[o]), d);
+        tape.computeAdjoints();
+
+        std::string mismatch;
+        auto check = [&](double& maxError, const char* what, std::size_t index,
+                         std::size_t direction, double jit, double taped) {
+            const double error = detail::jitValidationError(jit, taped);
+            maxError = (std::max)(maxError, error);
+            if (error > validationTolerance_ && mismatch.empty())
+                mismatch = detail::jitValidationMessage(what, index, direction, jit, taped);
+        };
+        for (std::size_t o = 0; o < numOutputs; ++o)
+            check(validationStats_.maxValueError, "output", o, std::size_t(-1),
+                  double(outputBuffer_[o * outputStride]), double(value(y[o])));
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            const derivative_type taped = x[i].getDerivative();
+            for (std::size_t d = 0; d < N; ++d)
+                check(validationStats_.maxGradientError, "derivative of input", i,
+                      N == 1 ? std::size_t(-1) : d,
+                      double(gradientBuffer_[i * gradientStride + d]),
+                      double(component(taped, d)));
+        }
+        if (mismatch.empty())
+            return;
+        ++validationStats_.mismatches;
+        if (validationThrows_)
+            throw JITValidationError(mismatch);
+    }
+
     static XAD_THREAD_LOCAL JITCompiler* active_jit_;
     JITGraph graph_;
     std::unique_ptr<JITBackend<Real>> backend_;
     std::vector<const Real*> inputValues_;
     std::vector<derivative_type> derivatives_;
+    std::vector<Real> inputBuffer_;     // Registered input values, broadcast to all lanes
+    std::vector<Real> outputBuffer_;    // Outputs of computeAdjoints()
+    std::vector<Real> gradientBuffer_;  // Input gradients of computeAdjoints()
+    std::vector<Real> seedBuffer_;      // Output adjoint seeds of computeAdjoints() for N > 1
+    std::size_t inputSlotEnd_ = 0;      // One past the largest input slot
+    std::vector<std::size_t> bakedConditions_;  // Node count at each baked condition
+    validation_function validation_;
+    std::size_t validationSampleEvery_ = 1;
+    double validationTolerance_ = 0.0;
+    bool validationThrows_ = true;
+    JITValidationStats validationStats_;
     derivative_type zero_ = derivative_type();  // Thread-safe zero for out-of-range derivative access
 };
 
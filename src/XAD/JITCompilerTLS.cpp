@@ -45,13 +45,17 @@ namespace xad
 template <class Real, std::size_t N>
 XAD_THREAD_LOCAL JITCompiler<Real, N>* JITCompiler<Real, N>::active_jit_ = nullptr;
 
-// JIT is intentionally limited to scalar, first-order mode only:
-// - no vector mode (N>1)
-// - no higher-order AD types
-//
-// Therefore we only provide explicit instantiations for the scalar specializations.
-template class JITCompiler<float>;
-template class JITCompiler<double>;
+// JIT is intentionally limited to first-order mode (no higher-order AD types).
+// Besides the scalar mode, the first-order vector adjoint modes configured in
+// XAD_MODES are instantiated.
+#define MAKE_JIT_TLS(type) template class JITCompiler<type>;
+
+MAKE_JIT_TLS(float)
+MAKE_JIT_TLS(double)
+
+#include <XAD/JITInstantiations.hpp>
+
+#undef MAKE_JIT_TLS
 
 }  // namespace xad
 
@@ -0,0 +1,108 @@
+/**
+ *
+ *   Complex function kernels for JIT graph evaluation.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITGraph.hpp>
+#include <cmath>
+
+namespace xad
+{
+
+/**
+ * Real (component 0) or imaginary (component 1) part of exp, log or sqrt of the
+ * complex number a + ib, for the CExp, CLog and CSqrt opcodes.
+ *
+ * The formulas are the ones of the std::complex<AReal> functions in Complex.hpp,
+ * so that a replay reproduces the recorded values for finite arguments.
+ */
+template <class Scalar>
+Scalar jitComplexEvaluate(JITOpCode op, Scalar a, Scalar b, double component)
+{
+    const bool imag = component != 0.0;
+    switch (op)
+    {
+        case JITOpCode::CExp:
+        {
+            Scalar e = std::exp(a);
+            return imag ? e * std::sin(b) : e * std::cos(b);
+        }
+        case JITOpCode::CLog: return imag ? std::atan2(b, a) : std::log(std::hypot(a, b));
+        case JITOpCode::CSqrt:
+        {
+            Scalar r = std::sqrt(std::hypot(a, b));
+            Scalar t = std::atan2(b, a) * Scalar(0.5);
+            return imag ? r * std::sin(t) : r * std::cos(t);
+        }
+        default: return Scalar(0);
+    }
+}
+
+/**
+ * Complex derivative p + iq of exp, log or sqrt at a + ib. By the Cauchy-Riemann
+ * equations, the real part u of the result has gradient (p, -q) and the
+ * imaginary part v has gradient (q, p) with respect to (a, b).
+ */
+template <class Scalar>
+void jitComplexDerivative(JITOpCode op, Scalar a, Scalar b, Scalar& p, Scalar& q)
+{
+    switch (op)
+    {
+        case JITOpCode::CExp:
+        {
+            Scalar e = std::exp(a);
+            p = e * std::cos(b);
+            q = e * std::sin(b);
+            return;
+        }
+        case JITOpCode::CLog:
+        {
+            Scalar r2 = a * a + b * b;
+            p = a / r2;
+            q = -b / r2;
+            return;
+        }
+        case JITOpCode::CSqrt:
+        {
+            // 1 / (2 s) with s = sqrt(a + ib) and |s|^2 = |a + ib|
+            Scalar h = std::hypot(a, b);
+            Scalar u = jitComplexEvaluate(op, a, b, 0.0);
+            Scalar v = jitComplexEvaluate(op, a, b, 1.0);
+            p = u / (Scalar(2) * h);
+            q = -v / (Scalar(2) * h);
+            return;
+        }
+        default:
+            p = q = Scalar(0);
+            return;
+    }
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,229 @@
+/**
+ *
+ *   Compiled JIT kernels as external functions on a tape.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/CheckpointCallback.hpp>
+#include <XAD/JITBackendInterface.hpp>
+#include <XAD/JITCompiler.hpp>
+#include <XAD/Literals.hpp>
+#include <XAD/Tape.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace xad
+{
+
+/**
+ * Evaluates a compiled JIT kernel as an external function inside a Tape recording.
+ *
+ * The kernel is recorded and compiled once with a JITCompiler, or compiled by a
+ * backend directly. Each call() during a tape recording evaluates the kernel with
+ * the backend's forward pass and inserts a CheckpointCallback holding the input
+ * values and slots, so the tape stores one callback instead of the kernel's
+ * operations. When computeAdjoints() reaches the callback, the kernel is replayed
+ * with the adjoints of the call's outputs as seeds, and the input gradients are
+ * added to the adjoints of its inputs.
+ *
+ * The backend must have a vector width of 1. With one output in scalar mode it is
+ * replayed with forwardAndBackward(), which every backend supports; otherwise it
+ * must implement forwardAndBackwardSeeded(), which propagates all N directions of
+ * a vector tape in one sweep.
+ *
+ * The backend, and the JITExternalFunction, must outlive the adjoint computation
+ * of every tape holding calls. Calls are not thread-safe, as they share the backend.
+ */
+template <class Real, std::size_t N = 1>
+class JITExternalFunction
+{
+    static_assert(std::is_floating_point<Real>::value,
+                  "JIT external functions require a first-order tape");
+
+  public:
+    typedef Tape<Real, N> tape_type;
+    typedef AReal<Real, N> active_type;
+    typedef typename tape_type::slot_type slot_type;
+    typedef typename tape_type::derivative_type derivative_type;
+
+    explicit JITExternalFunction(JITBackend<Real>& backend) : backend_(&backend)
+    {
+        if (backend.vectorWidth() != 1)
+            throw std::invalid_argument("JIT external functions require a backend of width 1");
+    }
+
+    /// Uses the backend of the given compiler, which must have been compiled.
+    template <std::size_t M>
+    explicit JITExternalFunction(JITCompiler<Real, M>& jit)
+        : JITExternalFunction(backendOf(jit))
+    {
+    }
+
+    std::size_t numInputs() const { return backend_->numInputs(); }
+    std::size_t numOutputs() const { return backend_->numOutputs(); }
+
+    /// Evaluates the kernel for numInputs() inputs and assigns its numOutputs() outputs.
+    /// If a tape is active and an input is recorded on it, the call is recorded as a callback.
+    void call(const active_type* inputs, active_type* outputs)
+    {
+        const std::size_t nIn = numInputs(), nOut = numOutputs();
+        inputValues_.resize(nIn);
+        outputValues_.resize(nOut);
+
+        tape_type* tape = tape_type::getActive();
+        bool record = false;
+        for (std::size_t i = 0; i < nIn; ++i)
+        {
+            inputValues_[i] = inputs[i].getValue();
+            record = record || (tape && inputs[i].shouldRecord());
+        }
+        backend_->setInputs(inputValues_.data());
+        backend_->forward(outputValues_.data());
+        for (std::size_t o = 0; o < nOut; ++o) outputs[o] = outputValues_[o];
+        if (!record)
+            return;
+
+        Callback* cb = new Callback(*this, inputValues_);
+        tape->pushCallback(cb);  // owned by the tape from here
+        cb->inputSlots.resize(nIn);
+        cb->outputSlots.resize(nOut);
+        for (std::size_t i = 0; i < nIn; ++i) cb->inputSlots[i] = inputs[i].getSlot();
+        for (std::size_t o = 0; o < nOut; ++o)
+        {
+            tape->registerOutput(outputs[o]);
+            cb->outputSlots[o] = outputs[o].getSlot();
+        }
+        tape->insertCallback(cb);
+    }
+
+    /// Vector version; throws std::invalid_argument if the number of inputs does not match.
+    void call(const std::vector<active_type>& inputs, std::vector<active_type>& outputs)
+    {
+        if (inputs.size() != numInputs())
+            throw std::invalid_argument("JIT external function called with wrong number of inputs");
+        outputs.resize(numOutputs());
+        call(inputs.data(), outputs.data());
+    }
+
+  private:
+    struct Callback : CheckpointCallback<tape_type>
+    {
+        Callback(JITExternalFunction& f, const std::vector<Real>& values)
+            : function(f), inputValues(values)
+        {
+        }
+
+        void computeAdjoint(tape_type* tape) override { function.computeAdjoint(tape, *this); }
+
+        JITExternalFunction& function;
+        std::vector<Real> inputValues;
+        std::vector<slot_type> inputSlots;
+        std::vector<slot_type> outputSlots;
+    };
+
+    template <std::size_t M>
+    static JITBackend<Real>& backendOf(JITCompiler<Real, M>& jit)
+    {
+        if (!jit.getBackend())
+            throw std::invalid_argument("JIT compiler has no backend");
+        return *jit.getBackend();
+    }
+
+    // Direction d of a derivative, for both scalar and vector mode
+    static Real component(const Real& d, std::size_t) { return d; }
+    template <class V>
+    static Real component(const V& d, std::size_t i)
+    {
+        return d[i];
+    }
+
+    static void addComponent(Real& d, std::size_t, Real v) { d += v; }
+    template <class V>
+    static void addComponent(V& d, std::size_t i, Real v)
+    {
+        d[i] += v;
+    }
+
+    void computeAdjoint(tape_type* tape, const Callback& cb)
+    {
+        const std::size_t nIn = cb.inputSlots.size(), nOut = cb.outputSlots.size();
+        seeds_.resize(nOut * N);
+        outputValues_.resize(nOut);
+        gradients_.resize(nIn * N);
+
+        bool seeded = false;
+        for (std::size_t o = 0; o < nOut; ++o)
+        {
+            derivative_type adj = tape->getAndResetOutputAdjoint(cb.outputSlots[o]);
+            for (std::size_t d = 0; d < N; ++d)
+            {
+                seeds_[o * N + d] = component(adj, d);
+                seeded = seeded || seeds_[o * N + d] != Real(0);
+            }
+        }
+        if (!seeded)
+            return;
+
+        backend_->setInputs(cb.inputValues.data());
+        if (N == 1 && nOut == 1)
+        {
+            backend_->forwardAndBackward(outputValues_.data(), gradients_.data());
+            for (std::size_t i = 0; i < nIn; ++i) gradients_[i] *= seeds_[0];
+        }
+        else
+        {
+            backend_->forwardAndBackwardSeeded(outputValues_.data(), seeds_.data(),
+                                               gradients_.data(), N);
+        }
+
+        for (std::size_t i = 0; i < nIn; ++i)
+        {
+            if (cb.inputSlots[i] == tape_type::INVALID_SLOT)
+                continue;
+            if (N == 1)
+            {
+                tape->incrementAdjoint(cb.inputSlots[i], gradients_[i]);
+                continue;
+            }
+            derivative_type& adj = tape->derivative(cb.inputSlots[i]);
+            for (std::size_t d = 0; d < N; ++d) addComponent(adj, d, gradients_[i * N + d]);
+        }
+    }
+
+    JITBackend<Real>* backend_;
+    std::vector<Real> inputValues_;
+    std::vector<Real> outputValues_;
+    std::vector<Real> seeds_;
+    std::vector<Real> gradients_;
+};
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
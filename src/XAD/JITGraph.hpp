@@ -96,9 +96,82 @@ enum class JITOpCode : uint16_t
     Frexp = 55,
     Modf = 56,
     Copysign = 57,
-    SmoothAbs = 58
+    SmoothAbs = 58,
+    Sum = 59,
+    Dot = 60,
+    Fma = 61,     // a * b + c
+    Fms = 62,     // a * b - c
+    Fnma = 63,    // c - a * b
+    MulMul = 64,  // a * b * c
+    DivAdd = 65,  // a / (b + c)
+    RandUniform = 66,  // uniform draw for path a, stream and draw number packed in imm
+    RandNormal = 67,   // standard normal draw for path a, stream and draw number packed in imm
+    CExp = 68,   // real (imm 0) or imaginary (imm 1) part of exp(a + ib)
+    CLog = 69,   // real (imm 0) or imaginary (imm 1) part of log(a + ib)
+    CSqrt = 70   // real (imm 0) or imaginary (imm 1) part of sqrt(a + ib)
 };
 
+/// Number of node operands used by an opcode (stored in JITNode::a, b, c).
+/// N-ary opcodes (Sum, Dot) return -1: their operands live in JITGraph::operand_pool.
+inline int jitOpArity(JITOpCode op)
+{
+    switch (op)
+    {
+        case JITOpCode::Input:
+        case JITOpCode::Constant:
+            return 0;
+        case JITOpCode::Neg:
+        case JITOpCode::Abs:
+        case JITOpCode::Square:
+        case JITOpCode::Recip:
+        case JITOpCode::Exp:
+        case JITOpCode::Log:
+        case JITOpCode::Sqrt:
+        case JITOpCode::Sin:
+        case JITOpCode::Cos:
+        case JITOpCode::Tan:
+        case JITOpCode::Asin:
+        case JITOpCode::Acos:
+        case JITOpCode::Atan:
+        case JITOpCode::Sinh:
+        case JITOpCode::Cosh:
+        case JITOpCode::Tanh:
+        case JITOpCode::Floor:
+        case JITOpCode::Ceil:
+        case JITOpCode::Cbrt:
+        case JITOpCode::Erf:
+        case JITOpCode::Erfc:
+        case JITOpCode::Expm1:
+        case JITOpCode::Log1p:
+        case JITOpCode::Log10:
+        case JITOpCode::Log2:
+        case JITOpCode::Asinh:
+        case JITOpCode::Acosh:
+        case JITOpCode::Atanh:
+        case JITOpCode::Exp2:
+        case JITOpCode::Trunc:
+        case JITOpCode::Round:
+        case JITOpCode::Ldexp:
+        case JITOpCode::Frexp:
+        case JITOpCode::Modf:
+        case JITOpCode::RandUniform:
+        case JITOpCode::RandNormal:
+            return 1;
+        case JITOpCode::If:
+        case JITOpCode::Fma:
+        case JITOpCode::Fms:
+        case JITOpCode::Fnma:
+        case JITOpCode::MulMul:
+        case JITOpCode::DivAdd:
+            return 3;
+        case JITOpCode::Sum:
+        case JITOpCode::Dot:
+            return -1;
+        default:
+            return 2;
+    }
+}
+
 struct JITNodeFlags
 {
     static constexpr uint8_t IsActive = 0x01;
@@ -118,16 +191,25 @@ struct JITGraph
 {
     ChunkContainer<JITNode> nodes;
     std::vector<double> const_pool;
+    std::vector<uint32_t> operand_pool;  // operand lists of n-ary nodes (Sum, Dot)
     std::vector<uint32_t> input_ids;
     std::vector<uint32_t> output_ids;
 
     std::size_t nodeCount() const { return nodes.size(); }
     bool empty() const { return nodes.empty(); }
 
+    /// Bytes held by the nodes, the constant pool and the operand, input and output lists.
+    std::size_t memory() const
+    {
+        return nodes.size() * sizeof(JITNode) + const_pool.size() * sizeof(double) +
+               (operand_pool.size() + input_ids.size() + output_ids.size()) * sizeof(uint32_t);
+    }
+
     void clear()
     {
         nodes.clear();
         const_pool.clear();
+        operand_pool.clear();
         input_ids.clear();
         output_ids.clear();
     }
@@ -157,6 +239,23 @@ struct JITGraph
     uint32_t addBinary(JITOpCode op, uint32_t left, uint32_t right) { return addNode(op, left, right); }
     uint32_t addTernary(JITOpCode op, uint32_t a, uint32_t b, uint32_t c) { return addNode(op, a, b, c); }
 
+    /// Sum of n nodes. The node stores the operand_pool offset in a and the count in b.
+    uint32_t addSum(const uint32_t* ids, std::size_t n)
+    {
+        uint32_t offset = static_cast<uint32_t>(operand_pool.size());
+        operand_pool.insert(operand_pool.end(), ids, ids + n);
+        return addNode(JITOpCode::Sum, offset, static_cast<uint32_t>(n));
+    }
+
+    /// Dot product sum(x[i] * y[i]). The pool holds x[0..n) followed by y[0..n).
+    uint32_t addDot(const uint32_t* x, const uint32_t* y, std::size_t n)
+    {
+        uint32_t offset = static_cast<uint32_t>(operand_pool.size());
+        operand_pool.insert(operand_pool.end(), x, x + n);
+        operand_pool.insert(operand_pool.end(), y, y + n);
+        return addNode(JITOpCode::Dot, offset, static_cast<uint32_t>(n));
+    }
+
     uint32_t addConstant(double value)
     {
         for (std::size_t i = 0; i < const_pool.size(); ++i)
@@ -186,6 +285,34 @@ struct JITGraph
     {
         return const_pool[static_cast<std::size_t>(nodes[nodeId].imm)];
     }
+
+    /// Calls f(operandId) for every node referenced by the given node.
+    template <class F>
+    void forEachOperand(uint32_t nodeId, F f) const
+    {
+        const JITNode& n = nodes[nodeId];
+        JITOpCode op = static_cast<JITOpCode>(n.op);
+        switch (jitOpArity(op))
+        {
+            case 1: f(n.a); break;
+            case 2:
+                f(n.a);
+                f(n.b);
+                break;
+            case 3:
+                f(n.a);
+                f(n.b);
+                f(n.c);
+                break;
+            case -1:
+            {
+                std::size_t count = (op == JITOpCode::Dot) ? 2 * std::size_t(n.b) : n.b;
+                for (std::size_t i = 0; i < count; ++i) f(operand_pool[n.a + i]);
+                break;
+            }
+            default: break;
+        }
+    }
 };
 
 }  // namespace xad
@@ -27,18 +27,18 @@
 #ifdef XAD_ENABLE_JIT
 
 #include <XAD/JITGraphInterpreter.hpp>
-#include <XAD/Macros.hpp>
+#include <XAD/JITGraphPasses.hpp>
+#include <XAD/JITOpKernels.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <numeric>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
-// Provide a fallback for environments where M_PI is not defined.
-#ifndef M_PI
-#define M_PI 3.141592653589793238462643383279502884
-#endif
-
 namespace xad
 {
 
@@ -49,6 +49,337 @@ struct JITGraphInterpreter<Scalar>::Impl
     std::vector<Scalar> inputValues;  // Current input values (set via setInput)
     std::vector<Scalar> nodeValues;   // Forward pass intermediate values
     std::vector<Scalar> nodeAdjoints; // Backward pass adjoints
+    std::vector<Scalar> directionAdjoints;  // Seeded backward pass adjoints, per node and direction
+    JITBranchAnalysis branches;       // Evaluation schedule and If branch guards
+    std::vector<char> guardState;     // Per guard: 0 = not yet known, 1 = taken, 2 = not taken
+
+    typedef std::chrono::steady_clock Clock;
+    bool profiling = false;
+    double timerOverhead = 0.0;  // Seconds measured for an empty timed region
+    JITProfile profile;
+
+    double elapsed(Clock::time_point start) const
+    {
+        double s = std::chrono::duration<double>(Clock::now() - start).count() - timerOverhead;
+        return s > 0.0 ? s : 0.0;
+    }
+
+    void recordForward(uint32_t nodeId, Clock::time_point start)
+    {
+        JITOpProfile& p = profile.ops[graph->nodes[nodeId].op];
+        ++p.evaluations;
+        p.forwardSeconds += elapsed(start);
+    }
+
+    void recordBackward(uint32_t nodeId, Clock::time_point start)
+    {
+        JITOpProfile& p = profile.ops[graph->nodes[nodeId].op];
+        ++p.propagations;
+        p.backwardSeconds += elapsed(start);
+    }
+
+    // Segmented replay under a memory budget. Segment k holds the nodes with IDs in
+    // [k * segmentLength, (k + 1) * segmentLength); only the values of nodes used by a
+    // later segment, and of the outputs, are kept across segments.
+    std::size_t memoryBudget = 0;
+    std::size_t segmentLength = 0;         // 0 if the graph is replayed without segments
+    std::vector<char> live;                // Nodes that contribute to an output
+    std::vector<uint32_t> boundaryIds;     // Nodes used outside their segment, sorted
+    std::vector<Scalar> boundaryValues;
+    std::vector<Scalar> boundaryAdjoints;
+    std::vector<std::pair<uint32_t, uint32_t>> inputNodes;  // (node ID, input index), sorted
+    std::vector<Scalar> window;            // Values of the nodes of the current segment
+    std::vector<Scalar> windowAdjoints;
+    std::vector<Scalar> gathered;          // Operand values of a Sum or Dot node
+    std::vector<uint32_t> gatheredIds;     // 0, 1, 2, ... indexing gathered
+    uint32_t segmentBegin = 0;
+    uint32_t segmentEnd = 0;
+    std::size_t windowSegment = SIZE_MAX;  // Segment whose values are in window
+
+    bool segmented() const { return segmentLength != 0; }
+
+    std::size_t numSegments() const
+    {
+        return (graph->nodeCount() + segmentLength - 1) / segmentLength;
+    }
+
+    std::size_t boundarySlot(uint32_t id) const
+    {
+        return static_cast<std::size_t>(
+            std::lower_bound(boundaryIds.begin(), boundaryIds.end(), id) - boundaryIds.begin());
+    }
+
+    // Operands of the current segment's nodes are in the window or at a boundary
+    Scalar& value(uint32_t id)
+    {
+        return id >= segmentBegin ? window[id - segmentBegin] : boundaryValues[boundarySlot(id)];
+    }
+
+    Scalar& adjoint(uint32_t id)
+    {
+        return id >= segmentBegin ? windowAdjoints[id - segmentBegin]
+                                  : boundaryAdjoints[boundarySlot(id)];
+    }
+
+    // Marks the nodes used outside their segment for the given segment length
+    std::size_t markBoundaries(std::size_t length, std::vector<char>& mark) const
+    {
+        const JITGraph& g = *graph;
+        mark.assign(g.nodeCount(), 0);
+        for (auto o : g.output_ids) mark[o] = 1;
+        for (std::size_t i = 0; i < g.nodeCount(); ++i)
+        {
+            if (!live[i])
+                continue;
+            g.forEachOperand(static_cast<uint32_t>(i), [&](uint32_t operand) {
+                if (operand / length != i / length)
+                    mark[operand] = 1;
+            });
+        }
+        return static_cast<std::size_t>(std::count(mark.begin(), mark.end(), char(1)));
+    }
+
+    /**
+     * Picks the segment length for the memory budget: the longest power of two whose
+     * window plus boundary storage fits, or the one needing the least memory if none
+     * fits. Graphs whose values and adjoints fit the budget are not segmented.
+     */
+    void planSegments()
+    {
+        const JITGraph& g = *graph;
+        const std::size_t n = g.nodeCount();
+        const std::size_t perBoundary = 2 * sizeof(Scalar) + sizeof(uint32_t);
+        segmentLength = 0;
+        windowSegment = SIZE_MAX;
+        if (memoryBudget == 0 || 2 * n * sizeof(Scalar) <= memoryBudget)
+            return;
+
+        live = computeJITLiveness(g);
+        std::vector<char> mark;
+        std::size_t length = 64;
+        while (length < n) length *= 2;
+        std::size_t best = 0, bestBytes = SIZE_MAX;
+        for (length /= 2; length >= 64; length /= 2)
+        {
+            std::size_t bytes = 2 * length * sizeof(Scalar) + markBoundaries(length, mark) * perBoundary;
+            if (bytes <= memoryBudget)
+            {
+                best = length;
+                break;
+            }
+            if (bytes < bestBytes)
+            {
+                best = length;
+                bestBytes = bytes;
+            }
+        }
+        if (best == 0)
+            return;
+
+        segmentLength = best;
+        markBoundaries(segmentLength, mark);
+        boundaryIds.clear();
+        for (std::size_t i = 0; i < n; ++i)
+            if (mark[i])
+                boundaryIds.push_back(static_cast<uint32_t>(i));
+        boundaryValues.assign(boundaryIds.size(), Scalar(0));
+        boundaryAdjoints.assign(boundaryIds.size(), Scalar(0));
+        window.assign(segmentLength, Scalar(0));
+        windowAdjoints.assign(segmentLength, Scalar(0));
+
+        inputNodes.clear();
+        for (std::size_t i = 0; i < g.input_ids.size(); ++i)
+            inputNodes.push_back(std::make_pair(g.input_ids[i], static_cast<uint32_t>(i)));
+        std::sort(inputNodes.begin(), inputNodes.end());
+
+        std::size_t maxOperands = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            JITOpCode op = g.getOpCode(static_cast<uint32_t>(i));
+            if (live[i] && (op == JITOpCode::Sum || op == JITOpCode::Dot))
+                maxOperands = (std::max)(maxOperands, std::size_t(g.nodes[i].b) * 2);
+        }
+        gathered.assign(maxOperands, Scalar(0));
+        gatheredIds.resize(maxOperands);
+        std::iota(gatheredIds.begin(), gatheredIds.end(), uint32_t(0));
+    }
+
+    void clearSegments()
+    {
+        segmentLength = 0;
+        live = std::vector<char>();
+        boundaryIds = std::vector<uint32_t>();
+        boundaryValues = std::vector<Scalar>();
+        boundaryAdjoints = std::vector<Scalar>();
+        inputNodes.clear();
+        window = std::vector<Scalar>();
+        windowAdjoints = std::vector<Scalar>();
+    }
+
+    Scalar evaluateInSegment(uint32_t id)
+    {
+        const JITNode& node = graph->nodes[id];
+        const JITOpCode op = static_cast<JITOpCode>(node.op);
+        switch (op)
+        {
+            case JITOpCode::Constant:
+            {
+                std::size_t idx = static_cast<std::size_t>(node.imm);
+                if (idx >= graph->const_pool.size())
+                    throw std::runtime_error("const_pool index out of bounds");
+                return static_cast<Scalar>(graph->const_pool[idx]);
+            }
+            case JITOpCode::Sum:
+            case JITOpCode::Dot:
+            {
+                // gathered in operand order, so the summation matches the unsegmented replay
+                const uint32_t* ids = graph->operand_pool.data() + node.a;
+                const bool dot = op == JITOpCode::Dot;
+                const std::size_t count = dot ? 2 * std::size_t(node.b) : node.b;
+                for (std::size_t i = 0; i < count; ++i) gathered[i] = value(ids[i]);
+                return jitPairwiseSum(gathered.data(), 1, gatheredIds.data(),
+                                      dot ? gatheredIds.data() + node.b : nullptr, node.b);
+            }
+            default: break;
+        }
+        const int arity = jitOpArity(op);
+        Scalar va = arity >= 1 ? value(node.a) : Scalar(0);
+        Scalar vb = arity >= 2 ? value(node.b) : Scalar(0);
+        Scalar vc = arity >= 3 ? value(node.c) : Scalar(0);
+        return jitEvaluateOp(op, va, vb, vc, node.imm);
+    }
+
+    // Computes the values of segment k into the window and stores its boundary values
+    void evaluateSegment(std::size_t k)
+    {
+        const JITGraph& g = *graph;
+        segmentBegin = static_cast<uint32_t>(k * segmentLength);
+        segmentEnd = static_cast<uint32_t>((std::min)(g.nodeCount(), (k + 1) * segmentLength));
+        auto input = std::lower_bound(inputNodes.begin(), inputNodes.end(),
+                                      std::make_pair(segmentBegin, uint32_t(0)));
+        for (uint32_t id = segmentBegin; id < segmentEnd; ++id)
+        {
+            if (!live[id])
+                continue;
+            if (g.getOpCode(id) == JITOpCode::Input)
+            {
+                while (input != inputNodes.end() && input->first < id) ++input;
+                if (input != inputNodes.end() && input->first == id)
+                    window[id - segmentBegin] = inputValues[input->second];
+                continue;
+            }
+            if (profiling)
+            {
+                Clock::time_point start = Clock::now();
+                window[id - segmentBegin] = evaluateInSegment(id);
+                recordForward(id, start);
+            }
+            else
+                window[id - segmentBegin] = evaluateInSegment(id);
+        }
+        for (std::size_t slot = boundarySlot(segmentBegin);
+             slot < boundaryIds.size() && boundaryIds[slot] < segmentEnd; ++slot)
+            boundaryValues[slot] = window[boundaryIds[slot] - segmentBegin];
+        windowSegment = k;
+    }
+
+    void propagateInSegment(uint32_t id)
+    {
+        Scalar adj = windowAdjoints[id - segmentBegin];
+        if (adj == Scalar(0))
+            return;
+        const JITNode& node = graph->nodes[id];
+        const JITOpCode op = static_cast<JITOpCode>(node.op);
+        switch (op)
+        {
+            case JITOpCode::Input:
+            case JITOpCode::Constant:
+                return;
+            case JITOpCode::Sum:
+            {
+                const uint32_t* ids = graph->operand_pool.data() + node.a;
+                for (uint32_t i = 0; i < node.b; ++i) adjoint(ids[i]) += adj;
+                return;
+            }
+            case JITOpCode::Dot:
+            {
+                const uint32_t* xs = graph->operand_pool.data() + node.a;
+                const uint32_t* ys = xs + node.b;
+                for (uint32_t i = 0; i < node.b; ++i)
+                {
+                    Scalar x = value(xs[i]);
+                    Scalar y = value(ys[i]);
+                    adjoint(xs[i]) += adj * y;
+                    adjoint(ys[i]) += adj * x;
+                }
+                return;
+            }
+            default: break;
+        }
+        const int arity = jitOpArity(op);
+        Scalar unused = Scalar(0);
+        Scalar va = arity >= 1 ? value(node.a) : Scalar(0);
+        Scalar vb = arity >= 2 ? value(node.b) : Scalar(0);
+        Scalar vc = arity >= 3 ? value(node.c) : Scalar(0);
+        jitPropagateOp(op, adj, va, vb, vc, window[id - segmentBegin], node.imm,
+                       arity >= 1 ? adjoint(node.a) : unused, arity >= 2 ? adjoint(node.b) : unused,
+                       arity >= 3 ? adjoint(node.c) : unused);
+    }
+
+    // Propagates the adjoints of the segment in the window and collects its input gradients
+    void propagateSegment(Scalar* inputGradients)
+    {
+        std::fill(windowAdjoints.begin(), windowAdjoints.end(), Scalar(0));
+        for (std::size_t slot = boundarySlot(segmentBegin);
+             slot < boundaryIds.size() && boundaryIds[slot] < segmentEnd; ++slot)
+            windowAdjoints[boundaryIds[slot] - segmentBegin] = boundaryAdjoints[slot];
+
+        for (uint32_t id = segmentEnd; id > segmentBegin; --id)
+        {
+            if (!live[id - 1])
+                continue;
+            if (profiling)
+            {
+                Clock::time_point start = Clock::now();
+                propagateInSegment(id - 1);
+                recordBackward(id - 1, start);
+            }
+            else
+                propagateInSegment(id - 1);
+        }
+
+        for (auto input = std::lower_bound(inputNodes.begin(), inputNodes.end(),
+                                           std::make_pair(segmentBegin, uint32_t(0)));
+             input != inputNodes.end() && input->first < segmentEnd; ++input)
+            inputGradients[input->second] = windowAdjoints[input->first - segmentBegin];
+    }
+
+    void forwardSegments(Scalar* outputs)
+    {
+        profile.forwardPasses += profiling;
+        const std::size_t segments = numSegments();
+        for (std::size_t k = 0; k < segments; ++k) evaluateSegment(k);
+        for (std::size_t i = 0; i < graph->output_ids.size(); ++i)
+            outputs[i] = boundaryValues[boundarySlot(graph->output_ids[i])];
+    }
+
+    void forwardAndBackwardSegments(Scalar* outputs, Scalar* inputGradients)
+    {
+        forwardSegments(outputs);
+        profile.backwardPasses += profiling;
+
+        std::fill(boundaryAdjoints.begin(), boundaryAdjoints.end(), Scalar(0));
+        for (auto o : graph->output_ids) boundaryAdjoints[boundarySlot(o)] = Scalar(1);
+        std::fill(inputGradients, inputGradients + graph->input_ids.size(), Scalar(0));
+
+        // recompute each segment from the boundary values, latest first
+        for (std::size_t k = numSegments(); k > 0; --k)
+        {
+            if (windowSegment != k - 1)
+                evaluateSegment(k - 1);
+            propagateSegment(inputGradients);
+        }
+    }
 };
 
 template <class Scalar>
@@ -65,8 +396,31 @@ void JITGraphInterpreter<Scalar>::compile(const JITGraph& graph)
 {
     impl_->graph = &graph;
     impl_->inputValues.resize(graph.input_ids.size());
+    impl_->planSegments();
+    if (impl_->segmented())
+    {
+        // the per-node storage is only allocated if forwardAndBackwardSeeded() needs it
+        impl_->nodeValues = std::vector<Scalar>();
+        impl_->nodeAdjoints = std::vector<Scalar>();
+        impl_->branches = JITBranchAnalysis();
+        impl_->guardState.clear();
+        return;
+    }
+    impl_->clearSegments();
+    prepareStoredReplay();
+}
+
+template <class Scalar>
+void JITGraphInterpreter<Scalar>::prepareStoredReplay()
+{
+    const JITGraph& graph = *impl_->graph;
     impl_->nodeValues.resize(graph.nodeCount());
     impl_->nodeAdjoints.resize(graph.nodeCount());
+
+    // Only evaluate nodes that feed an output - rewrite passes leave absorbed nodes behind -
+    // and only the branch of each If that is selected at runtime
+    impl_->branches = analyzeJITBranches(graph);
+    impl_->guardState.assign(impl_->branches.guards.size(), 0);
 }
 
 template <class Scalar>
@@ -76,6 +430,10 @@ void JITGraphInterpreter<Scalar>::reset()
     impl_->inputValues.clear();
     impl_->nodeValues.clear();
     impl_->nodeAdjoints.clear();
+    impl_->directionAdjoints.clear();
+    impl_->branches = JITBranchAnalysis();
+    impl_->guardState.clear();
+    impl_->clearSegments();
 }
 
 template <class Scalar>
@@ -101,21 +459,60 @@ void JITGraphInterpreter<Scalar>::setInput(std::size_t inputIndex, const Scalar*
     impl_->inputValues[inputIndex] = values[0];
 }
 
+template <class Scalar>
+void JITGraphInterpreter<Scalar>::setInputs(const Scalar* values)
+{
+    if (!impl_->graph)
+        throw std::runtime_error("Backend not compiled");
+
+    std::copy_n(values, impl_->inputValues.size(), impl_->inputValues.begin());
+}
+
 template <class Scalar>
 void JITGraphInterpreter<Scalar>::forward(Scalar* outputs)
 {
     if (!impl_->graph)
         throw std::runtime_error("Backend not compiled");
 
+    if (impl_->segmented())
+        impl_->forwardSegments(outputs);
+    else
+        forwardStored(outputs);
+}
+
+template <class Scalar>
+void JITGraphInterpreter<Scalar>::forwardStored(Scalar* outputs)
+{
     const JITGraph& graph = *impl_->graph;
 
     // Load input values into node values
     for (std::size_t i = 0; i < graph.input_ids.size(); ++i)
         impl_->nodeValues[graph.input_ids[i]] = impl_->inputValues[i];
 
-    // Evaluate all nodes
-    for (std::size_t i = 0; i < graph.nodeCount(); ++i)
-        evaluateNode(static_cast<uint32_t>(i));
+    // Evaluate all nodes that contribute to an output, skipping untaken If branches
+    const std::vector<uint32_t>& nodeGuard = impl_->branches.nodeGuard;
+    std::fill(impl_->guardState.begin(), impl_->guardState.end(), char(0));
+    impl_->guardState[0] = 1;
+    if (impl_->profiling)
+    {
+        ++impl_->profile.forwardPasses;
+        for (uint32_t id : impl_->branches.schedule)
+        {
+            if (!branchTaken(nodeGuard[id]))
+                continue;
+            typename Impl::Clock::time_point start = Impl::Clock::now();
+            evaluateNode(id);
+            impl_->recordForward(id, start);
+        }
+    }
+    else
+    {
+        for (uint32_t id : impl_->branches.schedule)
+        {
+            if (branchTaken(nodeGuard[id]))
+                evaluateNode(id);
+        }
+    }
 
     // Collect outputs (scalar: 1 value per output)
     for (std::size_t i = 0; i < graph.output_ids.size(); ++i)
@@ -128,19 +525,41 @@ void JITGraphInterpreter<Scalar>::forwardAndBackward(Scalar* outputs, Scalar* in
     if (!impl_->graph)
         throw std::runtime_error("Backend not compiled");
 
+    if (impl_->segmented())
+    {
+        impl_->forwardAndBackwardSegments(outputs, inputGradients);
+        return;
+    }
+
     const JITGraph& graph = *impl_->graph;
 
     // Run forward pass
-    forward(outputs);
+    forwardStored(outputs);
 
     // Run backward pass - seed output adjoints to 1.0
     impl_->nodeAdjoints.assign(graph.nodeCount(), Scalar(0));
     for (std::size_t i = 0; i < graph.output_ids.size(); ++i)
         impl_->nodeAdjoints[graph.output_ids[i]] = Scalar(1);
 
-    // Propagate adjoints backward
-    for (std::size_t i = graph.nodeCount(); i > 0; --i)
-        propagateAdjoint(static_cast<uint32_t>(i - 1));
+    // Propagate adjoints backward - the guard states are known from the forward pass
+    const std::vector<uint32_t>& schedule = impl_->branches.schedule;
+    const std::vector<uint32_t>& nodeGuard = impl_->branches.nodeGuard;
+    const bool profiling = impl_->profiling;
+    impl_->profile.backwardPasses += profiling;
+    for (std::size_t i = schedule.size(); i > 0; --i)
+    {
+        uint32_t id = schedule[i - 1];
+        if (impl_->guardState[nodeGuard[id]] != 1)
+            continue;
+        if (profiling)
+        {
+            typename Impl::Clock::time_point start = Impl::Clock::now();
+            propagateAdjoint(id);
+            impl_->recordBackward(id, start);
+        }
+        else
+            propagateAdjoint(id);
+    }
 
     // Collect input gradients (scalar: 1 value per input)
     for (std::size_t i = 0; i < graph.input_ids.size(); ++i)
@@ -148,9 +567,132 @@ void JITGraphInterpreter<Scalar>::forwardAndBackward(Scalar* outputs, Scalar* in
 }
 
 template <class Scalar>
-Scalar JITGraphInterpreter<Scalar>::invSqrtPi()
+void JITGraphInterpreter<Scalar>::forwardAndBackwardSeeded(Scalar* outputs,
+                                                           const Scalar* outputAdjoints,
+                                                           Scalar* inputGradients,
+                                                           std::size_t numDirections)
 {
-    return Scalar(2) / std::sqrt(Scalar(M_PI));
+    if (!impl_->graph)
+        throw std::runtime_error("Backend not compiled");
+
+    const JITGraph& graph = *impl_->graph;
+    const std::size_t n = numDirections;
+
+    if (impl_->nodeValues.size() != graph.nodeCount())
+        prepareStoredReplay();
+    forwardStored(outputs);
+
+    // Seed numDirections adjoints per output
+    std::vector<Scalar>& adjoints = impl_->directionAdjoints;
+    adjoints.assign(graph.nodeCount() * n, Scalar(0));
+    for (std::size_t i = 0; i < graph.output_ids.size(); ++i)
+        std::copy_n(outputAdjoints + i * n, n, adjoints.begin() + graph.output_ids[i] * n);
+
+    const std::vector<uint32_t>& schedule = impl_->branches.schedule;
+    const std::vector<uint32_t>& nodeGuard = impl_->branches.nodeGuard;
+    const bool profiling = impl_->profiling;
+    impl_->profile.backwardPasses += profiling;
+    for (std::size_t i = schedule.size(); i > 0; --i)
+    {
+        uint32_t id = schedule[i - 1];
+        if (impl_->guardState[nodeGuard[id]] != 1)
+            continue;
+        if (profiling)
+        {
+            typename Impl::Clock::time_point start = Impl::Clock::now();
+            propagateAdjoints(id, n);
+            impl_->recordBackward(id, start);
+        }
+        else
+            propagateAdjoints(id, n);
+    }
+
+    for (std::size_t i = 0; i < graph.input_ids.size(); ++i)
+        std::copy_n(adjoints.begin() + graph.input_ids[i] * n, n, inputGradients + i * n);
+}
+
+template <class Scalar>
+void JITGraphInterpreter<Scalar>::setMemoryBudget(std::size_t bytes)
+{
+    impl_->memoryBudget = bytes;
+    if (impl_->graph)
+        compile(*impl_->graph);
+}
+
+template <class Scalar>
+std::size_t JITGraphInterpreter<Scalar>::memoryBudget() const
+{
+    return impl_->memoryBudget;
+}
+
+template <class Scalar>
+std::size_t JITGraphInterpreter<Scalar>::numSegments() const
+{
+    return impl_->segmented() ? impl_->numSegments() : 1;
+}
+
+template <class Scalar>
+std::size_t JITGraphInterpreter<Scalar>::replayMemory() const
+{
+    const Impl& m = *impl_;
+    if (!m.segmented())
+        return (m.nodeValues.size() + m.nodeAdjoints.size()) * sizeof(Scalar);
+    return (m.window.size() + m.windowAdjoints.size() + m.boundaryValues.size() +
+            m.boundaryAdjoints.size()) * sizeof(Scalar) +
+           m.boundaryIds.size() * sizeof(uint32_t);
+}
+
+template <class Scalar>
+void JITGraphInterpreter<Scalar>::setProfiling(bool enable)
+{
+    if (enable && !impl_->profiling)
+    {
+        // calibrate the cost of timing an empty region, to subtract it from every node
+        const int samples = 1000;
+        typename Impl::Clock::time_point start = Impl::Clock::now();
+        for (int i = 0; i < samples; ++i)
+        {
+            volatile typename Impl::Clock::time_point t = Impl::Clock::now();
+            (void)t;
+        }
+        impl_->timerOverhead =
+            std::chrono::duration<double>(Impl::Clock::now() - start).count() / samples;
+    }
+    impl_->profiling = enable;
+}
+
+template <class Scalar>
+bool JITGraphInterpreter<Scalar>::profiling() const
+{
+    return impl_->profiling;
+}
+
+template <class Scalar>
+const JITProfile& JITGraphInterpreter<Scalar>::profile() const
+{
+    return impl_->profile;
+}
+
+template <class Scalar>
+void JITGraphInterpreter<Scalar>::resetProfile()
+{
+    impl_->profile = JITProfile();
+}
+
+template <class Scalar>
+bool JITGraphInterpreter<Scalar>::branchTaken(uint32_t guardId)
+{
+    char& state = impl_->guardState[guardId];
+    if (state == 0)
+    {
+        // the schedule evaluates the condition before any node of its branches
+        const JITBranchGuard& guard = impl_->branches.guards[guardId];
+        uint32_t cond = impl_->graph->nodes[guard.ifNode].a;
+        bool taken = branchTaken(guard.parent) &&
+                     (impl_->nodeValues[cond] != Scalar(0)) == guard.side;
+        state = taken ? 1 : 2;
+    }
+    return state == 1;
 }
 
 template <class Scalar>
@@ -162,13 +704,9 @@ void JITGraphInterpreter<Scalar>::evaluateNode(uint32_t nodeId)
     JITOpCode op = static_cast<JITOpCode>(node.op);
     uint32_t a = node.a;
     uint32_t b = node.b;
+    uint32_t c = node.c;
     double imm = node.imm;
 
-    Scalar va = (a < nodeValues.size()) ? nodeValues[a] : Scalar(0);
-    Scalar vb = (b < nodeValues.size()) ? nodeValues[b] : Scalar(0);
-
-    Scalar result = Scalar(0);
-
     switch (op)
     {
         case JITOpCode::Input: return;
@@ -177,102 +715,24 @@ void JITGraphInterpreter<Scalar>::evaluateNode(uint32_t nodeId)
             std::size_t idx = static_cast<std::size_t>(imm);
             if (idx >= graph.const_pool.size())
                 throw std::runtime_error("const_pool index out of bounds");
-            result = static_cast<Scalar>(graph.const_pool[idx]);
-            break;
-        }
-        case JITOpCode::Add: result = va + vb; break;
-        case JITOpCode::Sub: result = va - vb; break;
-        case JITOpCode::Mul: result = va * vb; break;
-        case JITOpCode::Div: result = va / vb; break;
-        case JITOpCode::Neg: result = -va; break;
-        case JITOpCode::Abs: result = std::abs(va); break;
-        case JITOpCode::Square: result = va * va; break;
-        case JITOpCode::Recip: result = Scalar(1) / va; break;
-        case JITOpCode::Sqrt: result = std::sqrt(va); break;
-        case JITOpCode::Exp: result = std::exp(va); break;
-        case JITOpCode::Log: result = std::log(va); break;
-        case JITOpCode::Sin: result = std::sin(va); break;
-        case JITOpCode::Cos: result = std::cos(va); break;
-        case JITOpCode::Tan: result = std::tan(va); break;
-        case JITOpCode::Asin: result = std::asin(va); break;
-        case JITOpCode::Acos: result = std::acos(va); break;
-        case JITOpCode::Atan: result = std::atan(va); break;
-        case JITOpCode::Sinh: result = std::sinh(va); break;
-        case JITOpCode::Cosh: result = std::cosh(va); break;
-        case JITOpCode::Tanh: result = std::tanh(va); break;
-        case JITOpCode::Pow: result = std::pow(va, vb); break;
-        case JITOpCode::Min: result = (std::min)(va, vb); break;
-        case JITOpCode::Max: result = (std::max)(va, vb); break;
-        case JITOpCode::Mod: result = std::fmod(va, vb); break;
-        case JITOpCode::Atan2: result = std::atan2(va, vb); break;
-        case JITOpCode::Floor: result = std::floor(va); break;
-        case JITOpCode::Ceil: result = std::ceil(va); break;
-        case JITOpCode::Cbrt: result = std::cbrt(va); break;
-        case JITOpCode::Erf: result = std::erf(va); break;
-        case JITOpCode::Erfc: result = std::erfc(va); break;
-        case JITOpCode::Expm1: result = std::expm1(va); break;
-        case JITOpCode::Log1p: result = std::log1p(va); break;
-        case JITOpCode::Log10: result = std::log10(va); break;
-        case JITOpCode::Log2: result = std::log2(va); break;
-        case JITOpCode::Asinh: result = std::asinh(va); break;
-        case JITOpCode::Acosh: result = std::acosh(va); break;
-        case JITOpCode::Atanh: result = std::atanh(va); break;
-        case JITOpCode::Exp2: result = std::exp2(va); break;
-        case JITOpCode::Trunc: result = std::trunc(va); break;
-        case JITOpCode::Round: result = std::round(va); break;
-        case JITOpCode::Remainder: result = std::remainder(va, vb); break;
-        case JITOpCode::Remquo:
-        {
-            int quo;
-            result = std::remquo(va, vb, &quo);
-            // Store quotient in operand_c if needed
-            break;
+            nodeValues[nodeId] = static_cast<Scalar>(graph.const_pool[idx]);
+            return;
         }
-        case JITOpCode::Hypot: result = std::hypot(va, vb); break;
-        case JITOpCode::Nextafter: result = std::nextafter(va, vb); break;
-        case JITOpCode::Ldexp: result = std::ldexp(va, static_cast<int>(imm)); break;
-        case JITOpCode::Frexp:
+        case JITOpCode::Sum:
+        case JITOpCode::Dot:
         {
-            int exp;
-            result = std::frexp(va, &exp);
-            // Store exponent somewhere if needed
-            break;
+            const uint32_t* ids = graph.operand_pool.data() + a;
+            nodeValues[nodeId] = jitPairwiseSum(nodeValues.data(), 1, ids,
+                                                op == JITOpCode::Dot ? ids + b : nullptr, b);
+            return;
         }
-        case JITOpCode::Modf:
-        {
-            Scalar intpart;
-            result = std::modf(va, &intpart);
-            // Store integer part somewhere if needed
-            break;
-        }
-        case JITOpCode::Copysign: result = std::copysign(va, vb); break;
-        case JITOpCode::SmoothAbs:
-        {
-            // Smooth abs: if |x| > c return |x|, else smooth function
-            if (std::abs(va) > vb)
-                result = std::abs(va);
-            else if (va < Scalar(0))
-                result = va * va * (Scalar(2) / vb + va / (vb * vb));
-            else
-                result = va * va * (Scalar(2) / vb - va / (vb * vb));
-            break;
-        }
-        case JITOpCode::CmpLT: result = (va < vb) ? Scalar(1) : Scalar(0); break;
-        case JITOpCode::CmpLE: result = (va <= vb) ? Scalar(1) : Scalar(0); break;
-        case JITOpCode::CmpGT: result = (va > vb) ? Scalar(1) : Scalar(0); break;
-        case JITOpCode::CmpGE: result = (va >= vb) ? Scalar(1) : Scalar(0); break;
-        case JITOpCode::CmpEQ: result = (va == vb) ? Scalar(1) : Scalar(0); break;
-        case JITOpCode::CmpNE: result = (va != vb) ? Scalar(1) : Scalar(0); break;
-        case JITOpCode::If:
-        {
-            const uint32_t c = node.c;
-            const Scalar vc = (c < nodeValues.size()) ? nodeValues[c] : Scalar(0);
-            result = (va != Scalar(0)) ? vb : vc;
-            break;
-        }
-        default: throw std::runtime_error("Unknown opcode");
+        default: break;
     }
-    nodeValues[nodeId] = result;
+
+    Scalar va = (a < nodeValues.size()) ? nodeValues[a] : Scalar(0);
+    Scalar vb = (b < nodeValues.size()) ? nodeValues[b] : Scalar(0);
+    Scalar vc = (c < nodeValues.size()) ? nodeValues[c] : Scalar(0);
+    nodeValues[nodeId] = jitEvaluateOp(op, va, vb, vc, imm);
 }
 
 template <class Scalar>
@@ -288,254 +748,110 @@ void JITGraphInterpreter<Scalar>::propagateAdjoint(uint32_t nodeId)
     JITOpCode op = static_cast<JITOpCode>(node.op);
     uint32_t a = node.a;
     uint32_t b = node.b;
-
-    Scalar va = (a < nodeValues.size()) ? nodeValues[a] : Scalar(0);
-    Scalar vb = (b < nodeValues.size()) ? nodeValues[b] : Scalar(0);
-    Scalar vResult = nodeValues[nodeId];
+    uint32_t c = node.c;
 
     switch (op)
     {
         case JITOpCode::Input:
         case JITOpCode::Constant:
-            break;
-        case JITOpCode::Add:
-            nodeAdjoints[a] += adj;
-            nodeAdjoints[b] += adj;
-            break;
-        case JITOpCode::Sub:
-            nodeAdjoints[a] += adj;
-            nodeAdjoints[b] -= adj;
-            break;
-        case JITOpCode::Mul:
-            nodeAdjoints[a] += adj * vb;
-            nodeAdjoints[b] += adj * va;
-            break;
-        case JITOpCode::Div:
-            nodeAdjoints[a] += adj / vb;
-            nodeAdjoints[b] -= adj * va / (vb * vb);
-            break;
-        case JITOpCode::Neg:
-            nodeAdjoints[a] -= adj;
-            break;
-        case JITOpCode::Abs:
-            // Match XAD's derivative: (a > 0) - (a < 0), which is 0 at a=0
-            nodeAdjoints[a] += adj * ((va > Scalar(0)) ? Scalar(1) : ((va < Scalar(0)) ? Scalar(-1) : Scalar(0)));
-            break;
-        case JITOpCode::Square:
-            nodeAdjoints[a] += adj * Scalar(2) * va;
-            break;
-        case JITOpCode::Recip:
-            nodeAdjoints[a] -= adj / (va * va);
-            break;
-        case JITOpCode::Sqrt:
-            nodeAdjoints[a] += adj / (Scalar(2) * vResult);
-            break;
-        case JITOpCode::Exp:
-            nodeAdjoints[a] += adj * vResult;
-            break;
-        case JITOpCode::Log:
-            nodeAdjoints[a] += adj / va;
-            break;
-        case JITOpCode::Sin:
-            nodeAdjoints[a] += adj * std::cos(va);
-            break;
-        case JITOpCode::Cos:
-            nodeAdjoints[a] -= adj * std::sin(va);
-            break;
-        case JITOpCode::Tan:
+            return;
+        case JITOpCode::Sum:
         {
-            Scalar cosv = std::cos(va);
-            nodeAdjoints[a] += adj / (cosv * cosv);
+            const uint32_t* ids = graph.operand_pool.data() + a;
+            for (uint32_t i = 0; i < b; ++i) nodeAdjoints[ids[i]] += adj;
+            return;
         }
-        break;
-        case JITOpCode::Asin:
-            nodeAdjoints[a] += adj / std::sqrt(Scalar(1) - va * va);
-            break;
-        case JITOpCode::Acos:
-            nodeAdjoints[a] -= adj / std::sqrt(Scalar(1) - va * va);
-            break;
-        case JITOpCode::Atan:
-            nodeAdjoints[a] += adj / (Scalar(1) + va * va);
-            break;
-        case JITOpCode::Sinh:
-            nodeAdjoints[a] += adj * std::cosh(va);
-            break;
-        case JITOpCode::Cosh:
-            nodeAdjoints[a] += adj * std::sinh(va);
-            break;
-        case JITOpCode::Tanh:
+        case JITOpCode::Dot:
         {
-            Scalar t = std::tanh(va);
-            nodeAdjoints[a] += adj * (Scalar(1) - t * t);
-        }
-        break;
-        case JITOpCode::Pow:
-            nodeAdjoints[a] += adj * vb * std::pow(va, vb - Scalar(1));
-            if (va > Scalar(0))
-                nodeAdjoints[b] += adj * vResult * std::log(va);
-            break;
-        case JITOpCode::Min:
-            if (va < vb)
-                nodeAdjoints[a] += adj;
-            else if (vb < va)
-                nodeAdjoints[b] += adj;
-            else  // va == vb
-            {
-                nodeAdjoints[a] += adj * Scalar(0.5);
-                nodeAdjoints[b] += adj * Scalar(0.5);
-            }
-            break;
-        case JITOpCode::Max:
-            if (vb < va)
-                nodeAdjoints[a] += adj;
-            else if (va < vb)
-                nodeAdjoints[b] += adj;
-            else  // va == vb
+            const uint32_t* xs = graph.operand_pool.data() + a;
+            const uint32_t* ys = xs + b;
+            for (uint32_t i = 0; i < b; ++i)
             {
-                nodeAdjoints[a] += adj * Scalar(0.5);
-                nodeAdjoints[b] += adj * Scalar(0.5);
+                Scalar x = nodeValues[xs[i]];
+                Scalar y = nodeValues[ys[i]];
+                nodeAdjoints[xs[i]] += adj * y;
+                nodeAdjoints[ys[i]] += adj * x;
             }
-            break;
-        case JITOpCode::Mod:
-            nodeAdjoints[a] += adj;
-            nodeAdjoints[b] -= adj * std::floor(va / vb);
-            break;
-        case JITOpCode::Atan2:
-        {
-            Scalar denom = va * va + vb * vb;
-            nodeAdjoints[a] += adj * vb / denom;
-            nodeAdjoints[b] -= adj * va / denom;
-        }
-        break;
-        case JITOpCode::Floor:
-        case JITOpCode::Ceil:
-            break;
-        case JITOpCode::Cbrt:
-            nodeAdjoints[a] += adj / (Scalar(3) * vResult * vResult);
-            break;
-        case JITOpCode::Erf:
-            nodeAdjoints[a] += adj * invSqrtPi() * std::exp(-va * va);
-            break;
-        case JITOpCode::Erfc:
-            nodeAdjoints[a] -= adj * invSqrtPi() * std::exp(-va * va);
-            break;
-        case JITOpCode::Expm1:
-            nodeAdjoints[a] += adj * std::exp(va);
-            break;
-        case JITOpCode::Log1p:
-            nodeAdjoints[a] += adj / (Scalar(1) + va);
-            break;
-        case JITOpCode::Log10:
-            nodeAdjoints[a] += adj / (va * std::log(Scalar(10)));
-            break;
-        case JITOpCode::Log2:
-            nodeAdjoints[a] += adj / (va * std::log(Scalar(2)));
-            break;
-        case JITOpCode::Asinh:
-            nodeAdjoints[a] += adj / std::sqrt(va * va + Scalar(1));
-            break;
-        case JITOpCode::Acosh:
-            nodeAdjoints[a] += adj / std::sqrt(va * va - Scalar(1));
-            break;
-        case JITOpCode::Atanh:
-            nodeAdjoints[a] += adj / (Scalar(1) - va * va);
-            break;
-        case JITOpCode::Exp2:
-            nodeAdjoints[a] += adj * std::log(Scalar(2)) * vResult;
-            break;
-        case JITOpCode::Trunc:
-        case JITOpCode::Round:
-            // Zero derivative
-            break;
-        case JITOpCode::Remainder:
-        {
-            int quo;
-            XAD_UNUSED_VARIABLE(std::remquo(va, vb, &quo));
-            nodeAdjoints[a] += adj;
-            nodeAdjoints[b] -= adj * Scalar(quo);
+            return;
         }
-        break;
-        case JITOpCode::Remquo:
-        {
-            int quo;
-            XAD_UNUSED_VARIABLE(std::remquo(va, vb, &quo));
-            nodeAdjoints[a] += adj;
-            nodeAdjoints[b] -= adj * Scalar(quo);
-        }
-        break;
-        case JITOpCode::Hypot:
-            nodeAdjoints[a] += adj * va / vResult;
-            nodeAdjoints[b] += adj * vb / vResult;
-            break;
-        case JITOpCode::Nextafter:
-            nodeAdjoints[a] += adj;
-            // Second operand has zero derivative
-            break;
-        case JITOpCode::Ldexp:
-        {
-            double imm = node.imm;
-            int exp = static_cast<int>(imm);
-            nodeAdjoints[a] += adj * Scalar(1 << exp);
-        }
-        break;
-        case JITOpCode::Frexp:
-        {
-            // Derivative is 1 / 2^exp, but we need to recompute frexp
-            int exp;
-            std::frexp(va, &exp);
-            nodeAdjoints[a] += adj / Scalar(1 << exp);
-        }
-        break;
-        case JITOpCode::Modf:
-            // Derivative of fractional part is 1
-            nodeAdjoints[a] += adj;
-            break;
-        case JITOpCode::Copysign:
-            // d/da copysign(a, b) = sign(b)
-            nodeAdjoints[a] += adj * ((vb >= Scalar(0)) ? Scalar(1) : Scalar(-1));
-            // d/db copysign(a, b) = 0
-            break;
-        case JITOpCode::SmoothAbs:
+        default: break;
+    }
+
+    Scalar va = (a < nodeValues.size()) ? nodeValues[a] : Scalar(0);
+    Scalar vb = (b < nodeValues.size()) ? nodeValues[b] : Scalar(0);
+    Scalar vc = (c < nodeValues.size()) ? nodeValues[c] : Scalar(0);
+    jitPropagateOp(op, adj, va, vb, vc, nodeValues[nodeId], node.imm, nodeAdjoints[a],
+                   nodeAdjoints[b], nodeAdjoints[c]);
+}
+
+template <class Scalar>
+void JITGraphInterpreter<Scalar>::propagateAdjoints(uint32_t nodeId, std::size_t numDirections)
+{
+    const JITGraph& graph = *impl_->graph;
+    const std::vector<Scalar>& nodeValues = impl_->nodeValues;
+    Scalar* adjoints = impl_->directionAdjoints.data();
+    const std::size_t n = numDirections;
+    const Scalar* g = adjoints + std::size_t(nodeId) * n;
+    if (std::all_of(g, g + n, [](Scalar v) { return v == Scalar(0); }))
+        return;
+
+    const auto& node = graph.nodes[nodeId];
+    JITOpCode op = static_cast<JITOpCode>(node.op);
+    uint32_t a = node.a;
+    uint32_t b = node.b;
+    uint32_t c = node.c;
+
+    switch (op)
+    {
+        case JITOpCode::Input:
+        case JITOpCode::Constant:
+            return;
+        case JITOpCode::Sum:
         {
-            Scalar dval;
-            if (va > vb)
-                dval = Scalar(1);
-            else if (va < -vb)
-                dval = Scalar(-1);
-            else if (va < Scalar(0))
-                dval = va / (vb * vb) * (Scalar(3) * va + Scalar(4) * vb);
-            else
-                dval = -va / (vb * vb) * (Scalar(3) * va - Scalar(4) * vb);
-            nodeAdjoints[a] += adj * dval;
-
-            // Derivative w.r.t. c (second parameter)
-            Scalar dcval;
-            if (va > vb || va < -vb)
-                dcval = Scalar(0);
-            else if (va < Scalar(0))
-                dcval = Scalar(-2) * va * va * (vb + va) / (vb * vb * vb);
-            else
-                dcval = Scalar(-2) * va * va * (vb - va) / (vb * vb * vb);
-            nodeAdjoints[b] += adj * dcval;
+            const uint32_t* ids = graph.operand_pool.data() + a;
+            for (uint32_t i = 0; i < b; ++i)
+            {
+                Scalar* gi = adjoints + std::size_t(ids[i]) * n;
+                for (std::size_t d = 0; d < n; ++d) gi[d] += g[d];
+            }
+            return;
         }
-        break;
-        case JITOpCode::CmpLT:
-        case JITOpCode::CmpLE:
-        case JITOpCode::CmpGT:
-        case JITOpCode::CmpGE:
-        case JITOpCode::CmpEQ:
-        case JITOpCode::CmpNE:
-            break;
-        case JITOpCode::If:
+        case JITOpCode::Dot:
         {
-            if (va != Scalar(0))
-                nodeAdjoints[b] += adj;
-            else
-                nodeAdjoints[node.c] += adj;
-            break;
+            const uint32_t* xs = graph.operand_pool.data() + a;
+            const uint32_t* ys = xs + b;
+            for (uint32_t i = 0; i < b; ++i)
+            {
+                Scalar x = nodeValues[xs[i]];
+                Scalar y = nodeValues[ys[i]];
+                Scalar* gx = adjoints + std::size_t(xs[i]) * n;
+                Scalar* gy = adjoints + std::size_t(ys[i]) * n;
+                for (std::size_t d = 0; d < n; ++d)
+                {
+                    gx[d] += g[d] * y;
+                    gy[d] += g[d] * x;
+                }
+            }
+            return;
         }
-        default:
-            break;
+        default: break;
+    }
+
+    // The adjoint rules are linear in the node adjoint, so the partials are computed
+    // once and applied to all directions
+    Scalar va = (a < nodeValues.size()) ? nodeValues[a] : Scalar(0);
+    Scalar vb = (b < nodeValues.size()) ? nodeValues[b] : Scalar(0);
+    Scalar vc = (c < nodeValues.size()) ? nodeValues[c] : Scalar(0);
+    Scalar da = Scalar(0), db = Scalar(0), dc = Scalar(0);
+    jitPropagateOp(op, Scalar(1), va, vb, vc, nodeValues[nodeId], node.imm, da, db, dc);
+    const uint32_t operands[3] = {a, b, c};
+    const Scalar partials[3] = {da, db, dc};
+    for (int k = 0; k < 3; ++k)
+    {
+        if (partials[k] == Scalar(0))
+            continue;
+        Scalar* gk = adjoints + std::size_t(operands[k]) * n;
+        for (std::size_t d = 0; d < n; ++d) gk[d] += g[d] * partials[k];
     }
 }
 
@@ -30,6 +30,7 @@
 
 #include <XAD/JITBackendInterface.hpp>
 #include <XAD/JITGraph.hpp>
+#include <XAD/JITGraphStats.hpp>
 #include <cstddef>
 #include <memory>
 
@@ -43,6 +44,26 @@ namespace xad
  * graph node by node. It serves as a reference implementation and fallback
  * when no native code generation backend is available.
  *
+ * Only nodes that contribute to an output are evaluated, and nodes needed only
+ * by the branch of an If that the condition does not select are skipped in both
+ * the forward and the backward pass.
+ *
+ * forwardAndBackwardSeeded() propagates several adjoint directions per node in a
+ * single backward sweep, as used by JITCompiler in vector mode.
+ *
+ * With a memory budget (setMemoryBudget()) smaller than the node values and
+ * adjoints of the whole graph, forward() and forwardAndBackward() split the graph
+ * into segments of consecutive nodes. Only the values used across segment
+ * boundaries are stored; the reverse sweep recomputes each segment's values from
+ * them before propagating its adjoints, at the cost of a second forward pass.
+ * In this mode both sides of an If are evaluated, nodes are visited in recording
+ * order - so gradients agree with the stored replay up to rounding - and
+ * forwardAndBackwardSeeded() still stores the values of all nodes.
+ *
+ * With setProfiling(true), the time spent per opcode in the forward and backward
+ * passes is accumulated in profile(). Each node is timed individually, which
+ * slows down replays considerably; the timer overhead is subtracted.
+ *
  * The template parameter Scalar specifies the floating-point type used for
  * computation (typically float or double).
  */
@@ -61,16 +82,35 @@ class JITGraphInterpreter : public JITBackend<Scalar>
     std::size_t numOutputs() const override;
 
     void setInput(std::size_t inputIndex, const Scalar* values) override;
+    void setInputs(const Scalar* values) override;
     void forward(Scalar* outputs) override;
     void forwardAndBackward(Scalar* outputs, Scalar* inputGradients) override;
+    void forwardAndBackwardSeeded(Scalar* outputs, const Scalar* outputAdjoints,
+                                  Scalar* inputGradients, std::size_t numDirections) override;
+
+    /// Bounds the node values and adjoints held by forwardAndBackward(); 0 means no bound.
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t memoryBudget() const;
+    /// Segments of the compiled graph, 1 if it is replayed without recomputation.
+    std::size_t numSegments() const;
+    /// Bytes of node values, adjoints and stored segment boundary values used by a replay.
+    std::size_t replayMemory() const;
+
+    void setProfiling(bool enable);
+    bool profiling() const;
+    const JITProfile& profile() const;
+    void resetProfile();
 
   private:
     struct Impl;
     std::unique_ptr<Impl> impl_;
 
-    static Scalar invSqrtPi();
+    void prepareStoredReplay();
+    void forwardStored(Scalar* outputs);
+    bool branchTaken(uint32_t guardId);
     void evaluateNode(uint32_t nodeId);
     void propagateAdjoint(uint32_t nodeId);
+    void propagateAdjoints(uint32_t nodeId, std::size_t numDirections);
 };
 
 // Declare external explicit instantiations
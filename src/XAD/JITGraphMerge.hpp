@@ -0,0 +1,233 @@
+/**
+ *
+ *   Merging several JIT graphs into one graph with shared nodes.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITGraph.hpp>
+#include <XAD/JITGraphPasses.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace xad
+{
+
+/**
+ * Builds one graph from several graphs that share their inputs.
+ *
+ * Input i of every added graph is input i of the merged graph, and the outputs
+ * of each graph are appended to the merged graph's outputs, so one replay of the
+ * merged graph evaluates all of them - e.g. every trade of a netting set on the
+ * same market inputs, with a single input upload and backend dispatch.
+ *
+ * Nodes are hash-consed: a node with the same opcode, immediate and (merged)
+ * operands as an existing one is reused instead of copied, so subgraphs that
+ * several graphs compute identically from the shared inputs, such as curve
+ * building, are evaluated once. Constants are shared by value, Sum and Dot nodes
+ * by their operand lists. Operands are not reordered, so the merged graph
+ * evaluates every output with the same operations, in the same order, as the
+ * graph it came from, and produces identical values. Only live nodes are copied.
+ */
+class JITGraphMerger
+{
+  public:
+    JITGraphMerger() : nodeIndex_(0, KeyHash(), KeyEqual(graph_)) {}
+
+    // the hash table refers to graph_
+    JITGraphMerger(const JITGraphMerger&) = delete;
+    JITGraphMerger& operator=(const JITGraphMerger&) = delete;
+
+    /// Appends a graph and returns the index of its first output in the merged outputs.
+    /// Inputs beyond those of the graphs added before are added to the merged graph.
+    std::size_t add(const JITGraph& source)
+    {
+        while (graph_.input_ids.size() < source.input_ids.size()) graph_.addInput();
+
+        const std::size_t n = source.nodeCount();
+        std::vector<char> live = computeJITLiveness(source);
+        map_.assign(n, 0);
+        for (std::size_t i = 0; i < source.input_ids.size(); ++i)
+            map_[source.input_ids[i]] = graph_.input_ids[i];
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const uint32_t id = static_cast<uint32_t>(i);
+            const JITNode& node = source.nodes[id];
+            const JITOpCode op = static_cast<JITOpCode>(node.op);
+            if (!live[id] || op == JITOpCode::Input)
+                continue;
+            ++copied_;
+
+            Key key;
+            key.op = node.op;
+            key.flags = node.flags;
+            double imm = node.imm;
+            const std::size_t poolSize = graph_.operand_pool.size();
+            switch (jitOpArity(op))
+            {
+                case 0: imm = source.getConstantValue(id); break;  // Constant, by value
+                case -1:
+                {
+                    // the mapped operand list goes to the end of the pool; dropped if reused
+                    const std::size_t count =
+                        op == JITOpCode::Dot ? 2 * std::size_t(node.b) : node.b;
+                    for (std::size_t k = 0; k < count; ++k)
+                    {
+                        const uint32_t operand = map_[source.operand_pool[node.a + k]];
+                        graph_.operand_pool.push_back(operand);
+                        key.operands = key.operands * 0x100000001b3ULL ^ operand;
+                    }
+                    key.a = static_cast<uint32_t>(poolSize);
+                    key.b = node.b;
+                    break;
+                }
+                default:
+                {
+                    const int arity = jitOpArity(op);
+                    key.a = map_[node.a];
+                    key.b = arity >= 2 ? map_[node.b] : 0;
+                    key.c = arity >= 3 ? map_[node.c] : 0;
+                    break;
+                }
+            }
+            std::memcpy(&key.imm, &imm, sizeof(imm));
+
+            auto found = nodeIndex_.find(key);
+            if (found != nodeIndex_.end())
+            {
+                graph_.operand_pool.resize(poolSize);
+                map_[id] = found->second;
+                ++reused_;
+                continue;
+            }
+
+            uint32_t target;
+            if (op == JITOpCode::Constant)
+            {
+                graph_.const_pool.push_back(imm);
+                target = graph_.addNode(op, 0, 0, 0, double(graph_.const_pool.size() - 1),
+                                        node.flags);
+            }
+            else
+                target = graph_.addNode(op, key.a, key.b, key.c, node.imm, node.flags);
+            nodeIndex_.emplace(key, target);
+            map_[id] = target;
+        }
+
+        const std::size_t firstOutput = graph_.output_ids.size();
+        for (auto o : source.output_ids) graph_.markOutput(map_[o]);
+        return firstOutput;
+    }
+
+    const JITGraph& graph() const { return graph_; }
+
+    /// Moves the merged graph out and starts over with an empty one.
+    JITGraph release()
+    {
+        JITGraph result(std::move(graph_));
+        graph_ = JITGraph();
+        nodeIndex_.clear();
+        copied_ = reused_ = 0;
+        return result;
+    }
+
+    /// Live non-input nodes of the added graphs, and how many of them were shared.
+    std::size_t copiedNodes() const { return copied_; }
+    std::size_t reusedNodes() const { return reused_; }
+
+  private:
+    struct Key
+    {
+        uint16_t op = 0;
+        uint8_t flags = 0;
+        uint32_t a = 0;  // operand_pool offset for Sum and Dot
+        uint32_t b = 0;
+        uint32_t c = 0;
+        uint64_t imm = 0;       // bits of the immediate, or of the value for constants
+        uint64_t operands = 0;  // hash of the operand list of Sum and Dot
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& k) const
+        {
+            // the pool offset of Sum and Dot is not part of their identity
+            const bool nary = jitOpArity(static_cast<JITOpCode>(k.op)) < 0;
+            uint64_t h = k.op;
+            h = h * 0x100000001b3ULL ^ (nary ? k.operands : k.a);
+            h = h * 0x100000001b3ULL ^ k.b;
+            h = h * 0x100000001b3ULL ^ k.c;
+            h = h * 0x100000001b3ULL ^ k.imm;
+            return std::hash<uint64_t>()(h);
+        }
+    };
+
+    // Sum and Dot keys compare their operand lists, which live in the merged pool
+    struct KeyEqual
+    {
+        explicit KeyEqual(const JITGraph& g) : graph(&g) {}
+
+        bool operator()(const Key& x, const Key& y) const
+        {
+            if (x.op != y.op || x.flags != y.flags || x.b != y.b || x.c != y.c || x.imm != y.imm)
+                return false;
+            const JITOpCode op = static_cast<JITOpCode>(x.op);
+            if (jitOpArity(op) >= 0)
+                return x.a == y.a;
+            const std::size_t count = op == JITOpCode::Dot ? 2 * std::size_t(x.b) : x.b;
+            const uint32_t* pool = graph->operand_pool.data();
+            return std::equal(pool + x.a, pool + x.a + count, pool + y.a);
+        }
+
+        const JITGraph* graph;
+    };
+
+    JITGraph graph_;
+    std::unordered_map<Key, uint32_t, KeyHash, KeyEqual> nodeIndex_;
+    std::vector<uint32_t> map_;  // source node id -> merged node id
+    std::size_t copied_ = 0;
+    std::size_t reused_ = 0;
+};
+
+/// Merges the graphs into one with JITGraphMerger; their outputs follow each other in order.
+inline JITGraph mergeJITGraphs(const std::vector<const JITGraph*>& graphs)
+{
+    JITGraphMerger merger;
+    for (const JITGraph* g : graphs) merger.add(*g);
+    return merger.release();
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,356 @@
+/**
+ *
+ *   Analysis and rewrite passes over a recorded JITGraph.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITGraph.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xad
+{
+
+/**
+ * Marks the nodes that contribute to at least one output.
+ *
+ * Passes rewrite nodes in place, so that node IDs held by recorded AReal
+ * variables remain valid. Nodes made redundant by a rewrite stay in the graph
+ * but are no longer reachable from the outputs; backends skip them.
+ */
+inline std::vector<char> computeJITLiveness(const JITGraph& graph)
+{
+    std::vector<char> live(graph.nodeCount(), 0);
+    for (auto o : graph.output_ids) live[o] = 1;
+    for (std::size_t i = graph.nodeCount(); i > 0; --i)
+    {
+        uint32_t id = static_cast<uint32_t>(i - 1);
+        if (live[id])
+            graph.forEachOperand(id, [&](uint32_t operand) { live[operand] = 1; });
+    }
+    return live;
+}
+
+/// Counts the references to each node from live nodes and from the output list.
+inline std::vector<uint32_t> computeJITUseCounts(const JITGraph& graph,
+                                                 const std::vector<char>& live)
+{
+    std::vector<uint32_t> uses(graph.nodeCount(), 0);
+    for (std::size_t i = 0; i < graph.nodeCount(); ++i)
+    {
+        if (live[i])
+            graph.forEachOperand(static_cast<uint32_t>(i),
+                                 [&](uint32_t operand) { ++uses[operand]; });
+    }
+    for (auto o : graph.output_ids) ++uses[o];
+    return uses;
+}
+
+/**
+ * Collapses chains of binary Add nodes into n-ary Sum nodes.
+ *
+ * An accumulation such as `v += t_i` is recorded as a left-deep chain of Add
+ * nodes, one per term. Every Add whose result is used only by another Add of
+ * the same chain is absorbed into the chain's root, which is rewritten as a
+ * Sum over all terms. If every term is a Mul node that is used only by the
+ * chain, the root becomes a Dot node instead, absorbing the products too.
+ *
+ * Only chains with at least minTerms terms are rewritten.
+ * Returns the number of Sum/Dot nodes created.
+ */
+inline std::size_t fuseJITReductions(JITGraph& graph, std::size_t minTerms = 3)
+{
+    const std::size_t n = graph.nodeCount();
+    std::vector<char> live = computeJITLiveness(graph);
+    std::vector<uint32_t> uses = computeJITUseCounts(graph, live);
+    std::vector<char> absorbed(n, 0);
+
+    std::vector<uint32_t> terms, chain, stack, xs, ys;
+    std::size_t created = 0;
+
+    for (std::size_t i = n; i > 0; --i)
+    {
+        const uint32_t root = static_cast<uint32_t>(i - 1);
+        if (!live[root] || absorbed[root] || graph.getOpCode(root) != JITOpCode::Add)
+            continue;
+
+        // depth-first, left operand first, so terms keep their recording order
+        terms.clear();
+        chain.clear();
+        stack.assign(1, root);
+        while (!stack.empty())
+        {
+            uint32_t id = stack.back();
+            stack.pop_back();
+            bool inner = id == root ||
+                         (graph.getOpCode(id) == JITOpCode::Add && uses[id] == 1 && !absorbed[id]);
+            if (!inner)
+            {
+                terms.push_back(id);
+                continue;
+            }
+            chain.push_back(id);
+            stack.push_back(graph.nodes[id].b);
+            stack.push_back(graph.nodes[id].a);
+        }
+
+        if (terms.size() < minTerms)
+            continue;
+
+        bool allProducts = true;
+        for (auto t : terms)
+            allProducts = allProducts && graph.getOpCode(t) == JITOpCode::Mul && uses[t] == 1;
+
+        for (auto c : chain) absorbed[c] = 1;
+
+        JITNode& node = graph.nodes[root];
+        node.a = static_cast<uint32_t>(graph.operand_pool.size());
+        node.b = static_cast<uint32_t>(terms.size());
+        node.c = 0;
+        if (allProducts)
+        {
+            xs.clear();
+            ys.clear();
+            for (auto t : terms)
+            {
+                xs.push_back(graph.nodes[t].a);
+                ys.push_back(graph.nodes[t].b);
+                absorbed[t] = 1;
+            }
+            graph.operand_pool.insert(graph.operand_pool.end(), xs.begin(), xs.end());
+            graph.operand_pool.insert(graph.operand_pool.end(), ys.begin(), ys.end());
+            node.op = static_cast<uint16_t>(JITOpCode::Dot);
+        }
+        else
+        {
+            graph.operand_pool.insert(graph.operand_pool.end(), terms.begin(), terms.end());
+            node.op = static_cast<uint16_t>(JITOpCode::Sum);
+        }
+        ++created;
+    }
+    return created;
+}
+
+/**
+ * Fuses binary arithmetic with a single-use operand into ternary opcodes:
+ *
+ * - `a*b + c` and `c + a*b` become Fma(a, b, c)
+ * - `a*b - c` becomes Fms(a, b, c), and `c - a*b` becomes Fnma(a, b, c)
+ * - `(a*b) * c` and `c * (a*b)` become MulMul(a, b, c)
+ * - `a / (b + c)` becomes DivAdd(a, b, c), covering e.g. `1 / (1 + x)`
+ *
+ * The inner node is absorbed only if the fused node is its single user and it
+ * is not an output, so no value that is observed elsewhere disappears.
+ * Returns the number of fused nodes.
+ */
+inline std::size_t fuseJITCompoundOps(JITGraph& graph)
+{
+    const std::size_t n = graph.nodeCount();
+    std::vector<char> live = computeJITLiveness(graph);
+    std::vector<uint32_t> uses = computeJITUseCounts(graph, live);
+
+    auto fusable = [&](uint32_t id, JITOpCode op) {
+        return graph.getOpCode(id) == op && uses[id] == 1;
+    };
+
+    std::size_t created = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!live[i])
+            continue;
+        JITNode& node = graph.nodes[i];
+        const uint32_t a = node.a;
+        const uint32_t b = node.b;
+
+        JITOpCode fused = JITOpCode::Fma;
+        uint32_t inner = a, other = b;
+        switch (static_cast<JITOpCode>(node.op))
+        {
+            case JITOpCode::Add:
+                if (!fusable(a, JITOpCode::Mul) && !fusable(b, JITOpCode::Mul))
+                    continue;
+                fused = JITOpCode::Fma;
+                inner = fusable(a, JITOpCode::Mul) ? a : b;
+                other = inner == a ? b : a;
+                break;
+            case JITOpCode::Sub:
+                if (fusable(a, JITOpCode::Mul))
+                {
+                    fused = JITOpCode::Fms;
+                    inner = a;
+                    other = b;
+                }
+                else if (fusable(b, JITOpCode::Mul))
+                {
+                    fused = JITOpCode::Fnma;
+                    inner = b;
+                    other = a;
+                }
+                else
+                    continue;
+                break;
+            case JITOpCode::Mul:
+                if (!fusable(a, JITOpCode::Mul) && !fusable(b, JITOpCode::Mul))
+                    continue;
+                fused = JITOpCode::MulMul;
+                inner = fusable(a, JITOpCode::Mul) ? a : b;
+                other = inner == a ? b : a;
+                break;
+            case JITOpCode::Div:
+                if (!fusable(b, JITOpCode::Add))
+                    continue;
+                // a / (b0 + b1): the numerator stays first
+                node.op = static_cast<uint16_t>(JITOpCode::DivAdd);
+                node.c = graph.nodes[b].b;
+                node.b = graph.nodes[b].a;
+                ++created;
+                continue;
+            default:
+                continue;
+        }
+
+        node.op = static_cast<uint16_t>(fused);
+        node.a = graph.nodes[inner].a;
+        node.b = graph.nodes[inner].b;
+        node.c = other;
+        ++created;
+    }
+    return created;
+}
+
+/// A region of the graph that is only needed when an If node selects one of its operands.
+struct JITBranchGuard
+{
+    uint32_t ifNode;  // If node selecting the branch
+    uint32_t parent;  // Enclosing guard, 0 for the unconditional region
+    uint32_t depth;   // Nesting depth, 0 for the unconditional region
+    bool side;        // true for the branch selected by a non-zero condition
+};
+
+/// Result of analyzeJITBranches().
+struct JITBranchAnalysis
+{
+    std::vector<JITBranchGuard> guards;  // guards[0] is the unconditional region
+    std::vector<uint32_t> nodeGuard;     // Innermost guard of each live node
+    std::vector<uint32_t> schedule;      // Live nodes, each If condition before its branches
+};
+
+/**
+ * Finds the branch-exclusive subgraphs of If nodes.
+ *
+ * A node is guarded by side s of an If node if every path from the node to an
+ * output passes through operand s of that If. Guards nest: a node used only by
+ * the true branch of an If that is itself only used by a false branch gets a
+ * guard whose parent is the outer one. A node used from several regions is
+ * guarded by their innermost common enclosing guard.
+ *
+ * The schedule lists the live nodes in a topological order in which the
+ * condition of every If is evaluated before any node exclusive to one of its
+ * branches, so that backends can decide at runtime which guarded nodes to skip.
+ */
+inline JITBranchAnalysis analyzeJITBranches(const JITGraph& graph)
+{
+    const std::size_t n = graph.nodeCount();
+    const uint32_t unset = UINT32_MAX;
+    std::vector<char> live = computeJITLiveness(graph);
+
+    JITBranchAnalysis result;
+    result.guards.push_back(JITBranchGuard{0, 0, 0, true});
+    result.nodeGuard.assign(n, unset);
+
+    auto enclosing = [&](uint32_t g1, uint32_t g2) {
+        while (g1 != g2)
+        {
+            if (result.guards[g1].depth < result.guards[g2].depth)
+                std::swap(g1, g2);
+            g1 = result.guards[g1].parent;
+        }
+        return g1;
+    };
+    auto use = [&](uint32_t operand, uint32_t g) {
+        uint32_t& og = result.nodeGuard[operand];
+        og = og == unset ? g : enclosing(og, g);
+    };
+
+    for (auto o : graph.output_ids) result.nodeGuard[o] = 0;
+    for (std::size_t i = n; i > 0; --i)
+    {
+        const uint32_t id = static_cast<uint32_t>(i - 1);
+        if (!live[id])
+            continue;
+        const uint32_t g = result.nodeGuard[id];
+        if (graph.getOpCode(id) != JITOpCode::If)
+        {
+            graph.forEachOperand(id, [&](uint32_t operand) { use(operand, g); });
+            continue;
+        }
+        const uint32_t depth = result.guards[g].depth + 1;
+        const uint32_t onTrue = static_cast<uint32_t>(result.guards.size());
+        result.guards.push_back(JITBranchGuard{id, g, depth, true});
+        result.guards.push_back(JITBranchGuard{id, g, depth, false});
+        use(graph.nodes[id].a, g);
+        use(graph.nodes[id].b, onTrue);
+        use(graph.nodes[id].c, onTrue + 1);
+    }
+
+    // depth-first post-order from the outputs, visiting If conditions first
+    enum : char { unvisited, expanded, scheduled };
+    std::vector<char> state(n, unvisited);
+    std::vector<uint32_t> stack, operands;
+    for (auto o : graph.output_ids)
+    {
+        stack.push_back(o);
+        while (!stack.empty())
+        {
+            const uint32_t id = stack.back();
+            if (state[id] != unvisited)
+            {
+                stack.pop_back();
+                if (state[id] == expanded)
+                {
+                    state[id] = scheduled;
+                    result.schedule.push_back(id);
+                }
+                continue;
+            }
+            state[id] = expanded;
+            operands.clear();
+            graph.forEachOperand(id, [&](uint32_t operand) { operands.push_back(operand); });
+            for (std::size_t k = operands.size(); k > 0; --k)
+                if (state[operands[k - 1]] == unvisited)
+                    stack.push_back(operands[k - 1]);
+        }
+    }
+    return result;
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
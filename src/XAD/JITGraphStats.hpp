@@ -0,0 +1,263 @@
+/**
+ *
+ *   Statistics and profiling data for recorded JIT graphs.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITGraph.hpp>
+#include <XAD/JITGraphPasses.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xad
+{
+
+/// Number of opcodes, one more than the largest JITOpCode value.
+constexpr std::size_t jitOpCodeCount = static_cast<std::size_t>(JITOpCode::CSqrt) + 1;
+
+/// Name of an opcode as spelled in JITOpCode, or "Unknown".
+inline const char* jitOpCodeName(JITOpCode op)
+{
+    static const char* const names[jitOpCodeCount] = {
+        "Input",     "Constant",    "Add",        "Sub",       "Mul",       "Div",
+        "Neg",       "Abs",         "Square",     "Recip",     "Mod",       "Exp",
+        "Log",       "Sqrt",        "Pow",        "Sin",       "Cos",       "Tan",
+        "Min",       "Max",         "If",         "CmpLT",     "CmpLE",     "CmpGT",
+        "CmpGE",     "CmpEQ",       "CmpNE",      "Asin",      "Acos",      "Atan",
+        "Sinh",      "Cosh",        "Tanh",       "Atan2",     "Floor",     "Ceil",
+        "Cbrt",      "Erf",         "Erfc",       "Expm1",     "Log1p",     "Log10",
+        "Log2",      "Asinh",       "Acosh",      "Atanh",     "Exp2",      "Trunc",
+        "Round",     "Fmod",        "Remainder",  "Remquo",    "Hypot",     "Nextafter",
+        "Ldexp",     "Frexp",       "Modf",       "Copysign",  "SmoothAbs", "Sum",
+        "Dot",       "Fma",         "Fms",        "Fnma",      "MulMul",    "DivAdd",
+        "RandUniform", "RandNormal", "CExp",      "CLog",      "CSqrt"};
+    std::size_t i = static_cast<std::size_t>(op);
+    return i < jitOpCodeCount ? names[i] : "Unknown";
+}
+
+/**
+ * Estimated floating-point operations for evaluating a node once.
+ *
+ * Arithmetic, comparisons and selections count 1 per operation, so Fma counts 2
+ * and a Sum of n terms n - 1. Square roots count 4, library functions such as
+ * exp, log or sin 20, and the random and complex nodes the flops of the
+ * functions they evaluate. Inputs and constants are free.
+ */
+inline double jitNodeFlops(const JITNode& node)
+{
+    switch (static_cast<JITOpCode>(node.op))
+    {
+        case JITOpCode::Input:
+        case JITOpCode::Constant:
+            return 0.0;
+        case JITOpCode::Sum: return node.b > 0 ? double(node.b) - 1.0 : 0.0;
+        case JITOpCode::Dot: return node.b > 0 ? 2.0 * double(node.b) - 1.0 : 0.0;
+        case JITOpCode::Fma:
+        case JITOpCode::Fms:
+        case JITOpCode::Fnma:
+        case JITOpCode::MulMul:
+        case JITOpCode::DivAdd:
+            return 2.0;
+        case JITOpCode::Sqrt:
+        case JITOpCode::Hypot:
+            return 4.0;
+        case JITOpCode::Exp:
+        case JITOpCode::Log:
+        case JITOpCode::Sin:
+        case JITOpCode::Cos:
+        case JITOpCode::Tan:
+        case JITOpCode::Asin:
+        case JITOpCode::Acos:
+        case JITOpCode::Atan:
+        case JITOpCode::Sinh:
+        case JITOpCode::Cosh:
+        case JITOpCode::Tanh:
+        case JITOpCode::Atan2:
+        case JITOpCode::Cbrt:
+        case JITOpCode::Erf:
+        case JITOpCode::Erfc:
+        case JITOpCode::Expm1:
+        case JITOpCode::Log1p:
+        case JITOpCode::Log10:
+        case JITOpCode::Log2:
+        case JITOpCode::Asinh:
+        case JITOpCode::Acosh:
+        case JITOpCode::Atanh:
+        case JITOpCode::Exp2:
+        case JITOpCode::SmoothAbs:
+        case JITOpCode::RandUniform:  // Philox rounds on 32-bit words, counted like a libm call
+            return 20.0;
+        case JITOpCode::Pow:
+        case JITOpCode::RandNormal:  // uniform draw plus a rational approximation with a log
+            return 40.0;
+        case JITOpCode::CExp:  // exp and cos / sin
+        case JITOpCode::CLog:  // hypot and log / atan2
+            return 41.0;
+        case JITOpCode::CSqrt:  // hypot, sqrt, atan2 and cos / sin
+            return 49.0;
+        default:
+            return 1.0;
+    }
+}
+
+/// Cost summary of a recorded JITGraph, as returned by computeJITGraphStats().
+struct JITGraphStats
+{
+    std::size_t nodes = 0;      // Recorded nodes, including those made dead by rewrite passes
+    std::size_t liveNodes = 0;  // Nodes that contribute to an output
+    std::size_t inputs = 0;
+    std::size_t outputs = 0;
+    std::size_t constants = 0;                // Live Constant nodes
+    std::vector<std::size_t> opcodeCounts;    // Live nodes per opcode, indexed by opcode value
+    std::size_t depth = 0;     // Operations on the longest dependency chain to an output
+    std::size_t maxWidth = 0;  // Largest number of operations at the same depth
+    double flops = 0.0;        // Estimated flops per forward replay
+    double backwardFlops = 0.0;       // Estimated flops per adjoint sweep
+    std::size_t bytesPerReplay = 0;   // Estimated memory traffic of a forward replay
+    std::size_t memory = 0;           // Bytes held by the graph, see JITGraph::memory()
+
+    std::size_t count(JITOpCode op) const
+    {
+        std::size_t i = static_cast<std::size_t>(op);
+        return i < opcodeCounts.size() ? opcodeCounts[i] : 0;
+    }
+};
+
+/**
+ * Computes the statistics of a graph.
+ *
+ * Only live nodes are counted, as backends skip the others. The depth of a
+ * node is one more than the largest depth of its operands, with inputs and
+ * constants at depth 0, so depth is the length of the critical path and
+ * maxWidth the available parallelism. The backward estimate counts two flops
+ * per operand (partial times adjoint, accumulated).
+ *
+ * bytesPerReplay counts, per evaluated node, the node record, one value of
+ * scalarSize bytes per operand read and one for the result, plus the operand
+ * indices of Sum and Dot nodes. Values reused from cache are counted each time,
+ * so it is an upper bound on the traffic to memory.
+ */
+inline JITGraphStats computeJITGraphStats(const JITGraph& graph,
+                                          std::size_t scalarSize = sizeof(double))
+{
+    JITGraphStats stats;
+    const std::size_t n = graph.nodeCount();
+    std::vector<char> live = computeJITLiveness(graph);
+
+    stats.nodes = n;
+    stats.inputs = graph.input_ids.size();
+    stats.outputs = graph.output_ids.size();
+    stats.memory = graph.memory();
+    stats.opcodeCounts.assign(jitOpCodeCount, 0);
+    stats.bytesPerReplay = stats.inputs * scalarSize + stats.outputs * scalarSize;
+
+    std::vector<uint32_t> depth(n, 0);
+    std::vector<std::size_t> width;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!live[i])
+            continue;
+        const uint32_t id = static_cast<uint32_t>(i);
+        const JITNode& node = graph.nodes[id];
+        const JITOpCode op = static_cast<JITOpCode>(node.op);
+        ++stats.liveNodes;
+        std::size_t code = node.op;
+        if (code < jitOpCodeCount)
+            ++stats.opcodeCounts[code];
+        if (op == JITOpCode::Input || op == JITOpCode::Constant)
+        {
+            stats.constants += op == JITOpCode::Constant;
+            continue;
+        }
+
+        std::size_t operands = 0;
+        uint32_t d = 0;
+        graph.forEachOperand(id, [&](uint32_t operand) {
+            ++operands;
+            d = std::max(d, depth[operand]);
+        });
+        depth[id] = d + 1;
+        if (width.size() <= d)
+            width.resize(d + 1, 0);
+        ++width[d];
+
+        stats.flops += jitNodeFlops(node);
+        stats.backwardFlops += 2.0 * double(operands);
+        stats.bytesPerReplay += sizeof(JITNode) + (operands + 1) * scalarSize;
+        if (jitOpArity(op) < 0)
+            stats.bytesPerReplay += operands * sizeof(uint32_t);
+    }
+    stats.depth = width.size();
+    for (std::size_t w : width) stats.maxWidth = std::max(stats.maxWidth, w);
+    return stats;
+}
+
+/// Replay counters and time of one opcode, see JITProfile.
+struct JITOpProfile
+{
+    std::size_t evaluations = 0;   // Nodes evaluated in forward passes
+    std::size_t propagations = 0;  // Nodes visited in backward passes
+    double forwardSeconds = 0.0;
+    double backwardSeconds = 0.0;
+};
+
+/**
+ * Per-opcode timings collected by an instrumented backend,
+ * see JITGraphInterpreter::setProfiling().
+ */
+struct JITProfile
+{
+    std::vector<JITOpProfile> ops = std::vector<JITOpProfile>(jitOpCodeCount);  // By opcode value
+    std::size_t forwardPasses = 0;
+    std::size_t backwardPasses = 0;
+
+    const JITOpProfile& operator[](JITOpCode op) const
+    {
+        return ops[static_cast<std::size_t>(op)];
+    }
+
+    double forwardSeconds() const
+    {
+        double s = 0.0;
+        for (const JITOpProfile& p : ops) s += p.forwardSeconds;
+        return s;
+    }
+
+    double backwardSeconds() const
+    {
+        double s = 0.0;
+        for (const JITOpProfile& p : ops) s += p.backwardSeconds;
+        return s;
+    }
+};
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,262 @@
+/*******************************************************************************
+
+   Mixed-precision JIT backend implementation.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITBatchInterpreter.hpp>
+#include <XAD/JITGraphInterpreter.hpp>
+#include <XAD/JITMixedPrecision.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace xad
+{
+
+struct JITMixedPrecisionBackend::Impl
+{
+    std::unique_ptr<JITBackend<float>> fast;
+    std::unique_ptr<JITBackend<double>> reference;
+    std::size_t interval;
+    std::size_t runs = 0;
+    std::size_t validated = 0;
+    std::size_t width = 0;                // Lanes of the fast backend, set by compile()
+    std::vector<double> inputValues;      // width values per input, in double precision
+    std::vector<float> fastInputs;        // The same, converted for the fast backend
+    std::vector<float> fastOutputs;       // width values per output
+    std::vector<float> fastGradients;     // width values per input
+    std::vector<double> laneInputs;       // Scratch for the reference: one lane
+    std::vector<double> laneOutputs;
+    std::vector<double> laneGradients;
+    std::vector<JITPrecisionStats> outputErrors;
+    std::vector<JITPrecisionStats> gradientErrors;
+
+    Impl(std::unique_ptr<JITBackend<float>> f, std::unique_ptr<JITBackend<double>> r,
+         std::size_t k)
+        : fast(std::move(f)), reference(std::move(r)), interval(k)
+    {
+    }
+};
+
+namespace
+{
+
+void record(JITPrecisionStats& stats, double fast, double reference)
+{
+    const double err = std::fabs(fast - reference);
+    ++stats.samples;
+    stats.sumAbsError += err;
+    stats.maxAbsError = (std::max)(stats.maxAbsError, err);
+    if (reference != 0.0)
+        stats.maxRelError = (std::max)(stats.maxRelError, err / std::fabs(reference));
+}
+
+}  // namespace
+
+JITMixedPrecisionBackend::JITMixedPrecisionBackend(std::size_t width,
+                                                   std::size_t validationInterval,
+                                                   JITMathAccuracy accuracy)
+    : JITMixedPrecisionBackend(
+          std::unique_ptr<JITBackend<float>>(new JITBatchInterpreter<float>(width, accuracy)),
+          std::unique_ptr<JITBackend<double>>(new JITGraphInterpreter<double>()),
+          validationInterval)
+{
+}
+
+JITMixedPrecisionBackend::JITMixedPrecisionBackend(std::unique_ptr<JITBackend<float>> fast,
+                                                   std::unique_ptr<JITBackend<double>> reference,
+                                                   std::size_t validationInterval)
+    : impl_(new Impl(std::move(fast), std::move(reference), validationInterval))
+{
+    if (!impl_->fast || !impl_->reference)
+        throw std::invalid_argument("JITMixedPrecisionBackend needs a fast and a reference backend");
+    if (impl_->reference->vectorWidth() != 1)
+        throw std::invalid_argument("JITMixedPrecisionBackend reference backend must be scalar");
+}
+
+JITMixedPrecisionBackend::~JITMixedPrecisionBackend() = default;
+
+void JITMixedPrecisionBackend::compile(const JITGraph& graph)
+{
+    impl_->fast->compile(graph);
+    impl_->reference->compile(graph);
+
+    const std::size_t w = impl_->fast->vectorWidth();
+    const std::size_t nIn = graph.input_ids.size();
+    const std::size_t nOut = graph.output_ids.size();
+    impl_->width = w;
+    impl_->inputValues.assign(nIn * w, 0.0);
+    impl_->fastInputs.assign(nIn * w, 0.0f);
+    impl_->fastOutputs.assign(nOut * w, 0.0f);
+    impl_->fastGradients.assign(nIn * w, 0.0f);
+    impl_->laneInputs.assign(nIn, 0.0);
+    impl_->laneOutputs.assign(nOut, 0.0);
+    impl_->laneGradients.assign(nIn, 0.0);
+    impl_->outputErrors.assign(nOut, JITPrecisionStats());
+    impl_->gradientErrors.assign(nIn, JITPrecisionStats());
+    impl_->runs = 0;
+    impl_->validated = 0;
+}
+
+void JITMixedPrecisionBackend::reset()
+{
+    impl_->fast->reset();
+    impl_->reference->reset();
+    impl_->width = 0;
+    impl_->inputValues.clear();
+    impl_->fastInputs.clear();
+    impl_->fastOutputs.clear();
+    impl_->fastGradients.clear();
+    impl_->outputErrors.clear();
+    impl_->gradientErrors.clear();
+    impl_->runs = 0;
+    impl_->validated = 0;
+}
+
+std::size_t JITMixedPrecisionBackend::vectorWidth() const { return impl_->fast->vectorWidth(); }
+
+std::size_t JITMixedPrecisionBackend::numInputs() const { return impl_->fast->numInputs(); }
+
+std::size_t JITMixedPrecisionBackend::numOutputs() const { return impl_->fast->numOutputs(); }
+
+void JITMixedPrecisionBackend::setInput(std::size_t inputIndex, const double* values)
+{
+    const std::size_t w = impl_->width;
+    if (w == 0)
+        throw std::runtime_error("Backend not compiled");
+    if (inputIndex >= impl_->laneInputs.size())
+        throw std::runtime_error("Input index out of range");
+
+    double* d = impl_->inputValues.data() + inputIndex * w;
+    float* f = impl_->fastInputs.data() + inputIndex * w;
+    for (std::size_t l = 0; l < w; ++l)
+    {
+        d[l] = values[l];
+        f[l] = static_cast<float>(values[l]);
+    }
+    impl_->fast->setInput(inputIndex, f);
+}
+
+void JITMixedPrecisionBackend::setInputs(const double* values)
+{
+    if (impl_->width == 0)
+        throw std::runtime_error("Backend not compiled");
+
+    std::copy_n(values, impl_->inputValues.size(), impl_->inputValues.begin());
+    for (std::size_t i = 0; i < impl_->fastInputs.size(); ++i)
+        impl_->fastInputs[i] = static_cast<float>(values[i]);
+    impl_->fast->setInputs(impl_->fastInputs.data());
+}
+
+void JITMixedPrecisionBackend::forward(double* outputs)
+{
+    if (impl_->width == 0)
+        throw std::runtime_error("Backend not compiled");
+
+    impl_->fast->forward(impl_->fastOutputs.data());
+    std::copy(impl_->fastOutputs.begin(), impl_->fastOutputs.end(), outputs);
+    if (validateThisRun())
+        validate(outputs, nullptr);
+}
+
+void JITMixedPrecisionBackend::forwardAndBackward(double* outputs, double* inputGradients)
+{
+    if (impl_->width == 0)
+        throw std::runtime_error("Backend not compiled");
+
+    impl_->fast->forwardAndBackward(impl_->fastOutputs.data(), impl_->fastGradients.data());
+    std::copy(impl_->fastOutputs.begin(), impl_->fastOutputs.end(), outputs);
+    std::copy(impl_->fastGradients.begin(), impl_->fastGradients.end(), inputGradients);
+    if (validateThisRun())
+        validate(outputs, inputGradients);
+}
+
+bool JITMixedPrecisionBackend::validateThisRun()
+{
+    const std::size_t run = impl_->runs++;
+    return impl_->interval > 0 && run % impl_->interval == 0;
+}
+
+void JITMixedPrecisionBackend::validate(const double* outputs, const double* inputGradients)
+{
+    const std::size_t w = impl_->width;
+    const std::size_t nIn = impl_->laneInputs.size();
+    const std::size_t nOut = impl_->laneOutputs.size();
+    JITBackend<double>& ref = *impl_->reference;
+
+    for (std::size_t l = 0; l < w; ++l)
+    {
+        for (std::size_t i = 0; i < nIn; ++i) impl_->laneInputs[i] = impl_->inputValues[i * w + l];
+        ref.setInputs(impl_->laneInputs.data());
+        if (inputGradients)
+            ref.forwardAndBackward(impl_->laneOutputs.data(), impl_->laneGradients.data());
+        else
+            ref.forward(impl_->laneOutputs.data());
+
+        for (std::size_t o = 0; o < nOut; ++o)
+            record(impl_->outputErrors[o], outputs[o * w + l], impl_->laneOutputs[o]);
+        if (inputGradients)
+        {
+            for (std::size_t i = 0; i < nIn; ++i)
+                record(impl_->gradientErrors[i], inputGradients[i * w + l],
+                       impl_->laneGradients[i]);
+        }
+    }
+    ++impl_->validated;
+}
+
+std::size_t JITMixedPrecisionBackend::validationInterval() const { return impl_->interval; }
+
+void JITMixedPrecisionBackend::setValidationInterval(std::size_t interval)
+{
+    impl_->interval = interval;
+    impl_->runs = 0;
+}
+
+std::size_t JITMixedPrecisionBackend::validatedRuns() const { return impl_->validated; }
+
+const std::vector<JITPrecisionStats>& JITMixedPrecisionBackend::outputErrors() const
+{
+    return impl_->outputErrors;
+}
+
+const std::vector<JITPrecisionStats>& JITMixedPrecisionBackend::gradientErrors() const
+{
+    return impl_->gradientErrors;
+}
+
+void JITMixedPrecisionBackend::resetStatistics()
+{
+    std::fill(impl_->outputErrors.begin(), impl_->outputErrors.end(), JITPrecisionStats());
+    std::fill(impl_->gradientErrors.begin(), impl_->gradientErrors.end(), JITPrecisionStats());
+    impl_->validated = 0;
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,107 @@
+/**
+ *
+ *   Mixed-precision JIT backend: double graphs replayed in single precision.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITBackendInterface.hpp>
+#include <XAD/JITGraph.hpp>
+#include <XAD/JITVectorMath.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace xad
+{
+
+/// Error of the single-precision results against the double-precision reference.
+struct JITPrecisionStats
+{
+    std::size_t samples = 0;   // Number of values compared
+    double maxAbsError = 0.0;  // Largest |fast - reference|
+    double maxRelError = 0.0;  // Largest |fast - reference| / |reference|, for non-zero references
+    double sumAbsError = 0.0;  // Sum of |fast - reference|
+
+    double meanAbsError() const { return samples ? sumAbsError / double(samples) : 0.0; }
+};
+
+/**
+ * @brief JITBackend that executes a graph recorded in double precision in single precision.
+ *
+ * Inputs are converted to float and the graph is evaluated by a single-precision
+ * backend, by default a JITBatchInterpreter<float> with twice the width of the
+ * default double batch interpreter. Outputs and gradients are converted back to double.
+ *
+ * With a validation interval k > 0, every k-th execution (starting with the first) is
+ * repeated lane by lane with a scalar double-precision reference backend, and the
+ * differences are collected per output in outputErrors() and, for forwardAndBackward(),
+ * per input gradient in gradientErrors(). This allows to trade precision for throughput
+ * with a measured error.
+ */
+class JITMixedPrecisionBackend : public JITBackend<double>
+{
+  public:
+    explicit JITMixedPrecisionBackend(std::size_t width = 16, std::size_t validationInterval = 0,
+                                      JITMathAccuracy accuracy = JITMathAccuracy::Fast);
+    /// Uses the given backends; reference must be a scalar backend (vectorWidth() == 1).
+    JITMixedPrecisionBackend(std::unique_ptr<JITBackend<float>> fast,
+                             std::unique_ptr<JITBackend<double>> reference,
+                             std::size_t validationInterval);
+    ~JITMixedPrecisionBackend() override;
+
+    void compile(const JITGraph& graph) override;
+    void reset() override;
+
+    std::size_t vectorWidth() const override;
+    std::size_t numInputs() const override;
+    std::size_t numOutputs() const override;
+
+    void setInput(std::size_t inputIndex, const double* values) override;
+    void setInputs(const double* values) override;
+    void forward(double* outputs) override;
+    void forwardAndBackward(double* outputs, double* inputGradients) override;
+
+    std::size_t validationInterval() const;
+    void setValidationInterval(std::size_t interval);
+
+    /// Number of executions checked against the reference so far.
+    std::size_t validatedRuns() const;
+    const std::vector<JITPrecisionStats>& outputErrors() const;
+    const std::vector<JITPrecisionStats>& gradientErrors() const;
+    void resetStatistics();
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+
+    bool validateThisRun();
+    void validate(const double* outputs, const double* inputGradients);
+};
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
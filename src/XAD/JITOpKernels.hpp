@@ -0,0 +1,538 @@
+/**
+ *
+ *   Per-opcode evaluation and adjoint rules shared by the JIT interpreters.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITComplexKernels.hpp>
+#include <XAD/JITGraph.hpp>
+#include <XAD/JITRandomKernels.hpp>
+#include <XAD/Macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace xad
+{
+
+/// 2 / sqrt(pi), the scaling factor in the derivatives of erf and erfc
+template <class Scalar>
+inline Scalar jitTwoOverSqrtPi()
+{
+    return Scalar(2) / std::sqrt(Scalar(3.141592653589793238462643383279502884));
+}
+
+/// a * b + c, with a single rounding where the target has a hardware FMA
+/// instruction; otherwise the same result as the unfused operations.
+template <class Scalar>
+inline Scalar jitFusedMulAdd(Scalar a, Scalar b, Scalar c)
+{
+    return a * b + c;
+}
+
+#ifdef FP_FAST_FMA
+template <>
+inline double jitFusedMulAdd(double a, double b, double c)
+{
+    return std::fma(a, b, c);
+}
+#endif
+
+#ifdef FP_FAST_FMAF
+template <>
+inline float jitFusedMulAdd(float a, float b, float c)
+{
+    return std::fma(a, b, c);
+}
+#endif
+
+/**
+ * Pairwise summation of vals[idx[i] * stride] (or of the products
+ * vals[idx[i] * stride] * vals[idy[i] * stride] if idy is given), for i < n.
+ *
+ * Four independent accumulators per block break the serial dependency of a
+ * left-to-right sum, and splitting larger ranges in halves keeps the rounding
+ * error growth logarithmic in n. The stride lets batch backends sum one lane
+ * of lane-interleaved node values with the same rounding as the scalar backend.
+ */
+template <class Scalar>
+Scalar jitPairwiseSum(const Scalar* vals, std::size_t stride, const uint32_t* idx,
+                      const uint32_t* idy, std::size_t n)
+{
+    if (n <= 16)
+    {
+        Scalar acc[4] = {Scalar(0), Scalar(0), Scalar(0), Scalar(0)};
+        std::size_t i = 0;
+        if (idy)
+        {
+            for (; i + 4 <= n; i += 4)
+                for (std::size_t k = 0; k < 4; ++k)
+                    acc[k] += vals[idx[i + k] * stride] * vals[idy[i + k] * stride];
+            for (; i < n; ++i) acc[i & 3] += vals[idx[i] * stride] * vals[idy[i] * stride];
+        }
+        else
+        {
+            for (; i + 4 <= n; i += 4)
+                for (std::size_t k = 0; k < 4; ++k) acc[k] += vals[idx[i + k] * stride];
+            for (; i < n; ++i) acc[i & 3] += vals[idx[i] * stride];
+        }
+        return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+    std::size_t half = n / 2;
+    return jitPairwiseSum(vals, stride, idx, idy, half) +
+           jitPairwiseSum(vals, stride, idx + half, idy ? idy + half : nullptr, n - half);
+}
+
+/**
+ * Value of a node with opcode op, given the values of its operands a, b and c
+ * (unused operands are ignored) and its immediate.
+ *
+ * Leaf (Input, Constant) and n-ary (Sum, Dot) nodes are handled by the backends.
+ */
+template <class Scalar>
+Scalar jitEvaluateOp(JITOpCode op, Scalar va, Scalar vb, Scalar vc, double imm)
+{
+    Scalar result = Scalar(0);
+
+    switch (op)
+    {
+        case JITOpCode::Add: result = va + vb; break;
+        case JITOpCode::Sub: result = va - vb; break;
+        case JITOpCode::Mul: result = va * vb; break;
+        case JITOpCode::Div: result = va / vb; break;
+        case JITOpCode::Neg: result = -va; break;
+        case JITOpCode::Abs: result = std::abs(va); break;
+        case JITOpCode::Square: result = va * va; break;
+        case JITOpCode::Recip: result = Scalar(1) / va; break;
+        case JITOpCode::Sqrt: result = std::sqrt(va); break;
+        case JITOpCode::Exp: result = std::exp(va); break;
+        case JITOpCode::Log: result = std::log(va); break;
+        case JITOpCode::Sin: result = std::sin(va); break;
+        case JITOpCode::Cos: result = std::cos(va); break;
+        case JITOpCode::Tan: result = std::tan(va); break;
+        case JITOpCode::Asin: result = std::asin(va); break;
+        case JITOpCode::Acos: result = std::acos(va); break;
+        case JITOpCode::Atan: result = std::atan(va); break;
+        case JITOpCode::Sinh: result = std::sinh(va); break;
+        case JITOpCode::Cosh: result = std::cosh(va); break;
+        case JITOpCode::Tanh: result = std::tanh(va); break;
+        case JITOpCode::Pow: result = std::pow(va, vb); break;
+        case JITOpCode::Min: result = (std::min)(va, vb); break;
+        case JITOpCode::Max: result = (std::max)(va, vb); break;
+        case JITOpCode::Mod: result = std::fmod(va, vb); break;
+        case JITOpCode::Atan2: result = std::atan2(va, vb); break;
+        case JITOpCode::Floor: result = std::floor(va); break;
+        case JITOpCode::Ceil: result = std::ceil(va); break;
+        case JITOpCode::Cbrt: result = std::cbrt(va); break;
+        case JITOpCode::Erf: result = std::erf(va); break;
+        case JITOpCode::Erfc: result = std::erfc(va); break;
+        case JITOpCode::Expm1: result = std::expm1(va); break;
+        case JITOpCode::Log1p: result = std::log1p(va); break;
+        case JITOpCode::Log10: result = std::log10(va); break;
+        case JITOpCode::Log2: result = std::log2(va); break;
+        case JITOpCode::Asinh: result = std::asinh(va); break;
+        case JITOpCode::Acosh: result = std::acosh(va); break;
+        case JITOpCode::Atanh: result = std::atanh(va); break;
+        case JITOpCode::Exp2: result = std::exp2(va); break;
+        case JITOpCode::Trunc: result = std::trunc(va); break;
+        case JITOpCode::Round: result = std::round(va); break;
+        case JITOpCode::Remainder: result = std::remainder(va, vb); break;
+        case JITOpCode::Remquo:
+        {
+            int quo;
+            result = std::remquo(va, vb, &quo);
+            // Store quotient in operand_c if needed
+            break;
+        }
+        case JITOpCode::Hypot: result = std::hypot(va, vb); break;
+        case JITOpCode::Nextafter: result = std::nextafter(va, vb); break;
+        case JITOpCode::Ldexp: result = std::ldexp(va, static_cast<int>(imm)); break;
+        case JITOpCode::Frexp:
+        {
+            int exp;
+            result = std::frexp(va, &exp);
+            // Store exponent somewhere if needed
+            break;
+        }
+        case JITOpCode::Modf:
+        {
+            Scalar intpart;
+            result = std::modf(va, &intpart);
+            // Store integer part somewhere if needed
+            break;
+        }
+        case JITOpCode::Copysign: result = std::copysign(va, vb); break;
+        case JITOpCode::SmoothAbs:
+        {
+            // Smooth abs: if |x| > c return |x|, else smooth function
+            if (std::abs(va) > vb)
+                result = std::abs(va);
+            else if (va < Scalar(0))
+                result = va * va * (Scalar(2) / vb + va / (vb * vb));
+            else
+                result = va * va * (Scalar(2) / vb - va / (vb * vb));
+            break;
+        }
+        case JITOpCode::CmpLT: result = (va < vb) ? Scalar(1) : Scalar(0); break;
+        case JITOpCode::CmpLE: result = (va <= vb) ? Scalar(1) : Scalar(0); break;
+        case JITOpCode::CmpGT: result = (va > vb) ? Scalar(1) : Scalar(0); break;
+        case JITOpCode::CmpGE: result = (va >= vb) ? Scalar(1) : Scalar(0); break;
+        case JITOpCode::CmpEQ: result = (va == vb) ? Scalar(1) : Scalar(0); break;
+        case JITOpCode::CmpNE: result = (va != vb) ? Scalar(1) : Scalar(0); break;
+        case JITOpCode::If: result = (va != Scalar(0)) ? vb : vc; break;
+        case JITOpCode::Fma: result = jitFusedMulAdd(va, vb, vc); break;
+        case JITOpCode::Fms: result = jitFusedMulAdd(va, vb, -vc); break;
+        case JITOpCode::Fnma: result = jitFusedMulAdd(-va, vb, vc); break;
+        case JITOpCode::MulMul: result = va * vb * vc; break;
+        case JITOpCode::DivAdd: result = va / (vb + vc); break;
+        case JITOpCode::RandUniform:
+            result = static_cast<Scalar>(jitRandomFromImmediate(false, double(va), imm));
+            break;
+        case JITOpCode::RandNormal:
+            result = static_cast<Scalar>(jitRandomFromImmediate(true, double(va), imm));
+            break;
+        case JITOpCode::CExp:
+        case JITOpCode::CLog:
+        case JITOpCode::CSqrt: result = jitComplexEvaluate(op, va, vb, imm); break;
+        default: throw std::runtime_error("Unknown opcode");
+    }
+    return result;
+}
+
+/**
+ * Adds the contribution adj * d(node)/d(operand) to the adjoints aa, ab and ac of
+ * the operands a, b and c of a node with opcode op, given the operand values, the
+ * node value vResult and the immediate.
+ *
+ * The adjoint references may alias, e.g. for x * x.
+ */
+template <class Scalar>
+void jitPropagateOp(JITOpCode op, Scalar adj, Scalar va, Scalar vb, Scalar vc, Scalar vResult,
+                    double imm, Scalar& aa, Scalar& ab, Scalar& ac)
+{
+    switch (op)
+    {
+        case JITOpCode::Input:
+        case JITOpCode::Constant:
+            break;
+        case JITOpCode::Add:
+            aa += adj;
+            ab += adj;
+            break;
+        case JITOpCode::Sub:
+            aa += adj;
+            ab -= adj;
+            break;
+        case JITOpCode::Mul:
+            aa += adj * vb;
+            ab += adj * va;
+            break;
+        case JITOpCode::Div:
+            aa += adj / vb;
+            ab -= adj * va / (vb * vb);
+            break;
+        case JITOpCode::Neg:
+            aa -= adj;
+            break;
+        case JITOpCode::Abs:
+            // Match XAD's derivative: (a > 0) - (a < 0), which is 0 at a=0
+            aa += adj * ((va > Scalar(0)) ? Scalar(1) : ((va < Scalar(0)) ? Scalar(-1) : Scalar(0)));
+            break;
+        case JITOpCode::Square:
+            aa += adj * Scalar(2) * va;
+            break;
+        case JITOpCode::Recip:
+            aa -= adj / (va * va);
+            break;
+        case JITOpCode::Sqrt:
+            aa += adj / (Scalar(2) * vResult);
+            break;
+        case JITOpCode::Exp:
+            aa += adj * vResult;
+            break;
+        case JITOpCode::Log:
+            aa += adj / va;
+            break;
+        case JITOpCode::Sin:
+            aa += adj * std::cos(va);
+            break;
+        case JITOpCode::Cos:
+            aa -= adj * std::sin(va);
+            break;
+        case JITOpCode::Tan:
+        {
+            Scalar cosv = std::cos(va);
+            aa += adj / (cosv * cosv);
+        }
+        break;
+        case JITOpCode::Asin:
+            aa += adj / std::sqrt(Scalar(1) - va * va);
+            break;
+        case JITOpCode::Acos:
+            aa -= adj / std::sqrt(Scalar(1) - va * va);
+            break;
+        case JITOpCode::Atan:
+            aa += adj / (Scalar(1) + va * va);
+            break;
+        case JITOpCode::Sinh:
+            aa += adj * std::cosh(va);
+            break;
+        case JITOpCode::Cosh:
+            aa += adj * std::sinh(va);
+            break;
+        case JITOpCode::Tanh:
+        {
+            Scalar t = std::tanh(va);
+            aa += adj * (Scalar(1) - t * t);
+        }
+        break;
+        case JITOpCode::Pow:
+            aa += adj * vb * std::pow(va, vb - Scalar(1));
+            if (va > Scalar(0))
+                ab += adj * vResult * std::log(va);
+            break;
+        case JITOpCode::Min:
+            if (va < vb)
+                aa += adj;
+            else if (vb < va)
+                ab += adj;
+            else  // va == vb
+            {
+                aa += adj * Scalar(0.5);
+                ab += adj * Scalar(0.5);
+            }
+            break;
+        case JITOpCode::Max:
+            if (vb < va)
+                aa += adj;
+            else if (va < vb)
+                ab += adj;
+            else  // va == vb
+            {
+                aa += adj * Scalar(0.5);
+                ab += adj * Scalar(0.5);
+            }
+            break;
+        case JITOpCode::Mod:
+            aa += adj;
+            ab -= adj * std::floor(va / vb);
+            break;
+        case JITOpCode::Atan2:
+        {
+            Scalar denom = va * va + vb * vb;
+            aa += adj * vb / denom;
+            ab -= adj * va / denom;
+        }
+        break;
+        case JITOpCode::Floor:
+        case JITOpCode::Ceil:
+        case JITOpCode::RandUniform:
+        case JITOpCode::RandNormal:
+            break;
+        case JITOpCode::Cbrt:
+            aa += adj / (Scalar(3) * vResult * vResult);
+            break;
+        case JITOpCode::Erf:
+            aa += adj * jitTwoOverSqrtPi<Scalar>() * std::exp(-va * va);
+            break;
+        case JITOpCode::Erfc:
+            aa -= adj * jitTwoOverSqrtPi<Scalar>() * std::exp(-va * va);
+            break;
+        case JITOpCode::Expm1:
+            aa += adj * std::exp(va);
+            break;
+        case JITOpCode::Log1p:
+            aa += adj / (Scalar(1) + va);
+            break;
+        case JITOpCode::Log10:
+            aa += adj / (va * std::log(Scalar(10)));
+            break;
+        case JITOpCode::Log2:
+            aa += adj / (va * std::log(Scalar(2)));
+            break;
+        case JITOpCode::Asinh:
+            aa += adj / std::sqrt(va * va + Scalar(1));
+            break;
+        case JITOpCode::Acosh:
+            aa += adj / std::sqrt(va * va - Scalar(1));
+            break;
+        case JITOpCode::Atanh:
+            aa += adj / (Scalar(1) - va * va);
+            break;
+        case JITOpCode::Exp2:
+            aa += adj * std::log(Scalar(2)) * vResult;
+            break;
+        case JITOpCode::Trunc:
+        case JITOpCode::Round:
+            // Zero derivative
+            break;
+        case JITOpCode::Remainder:
+        {
+            int quo;
+            XAD_UNUSED_VARIABLE(std::remquo(va, vb, &quo));
+            aa += adj;
+            ab -= adj * Scalar(quo);
+        }
+        break;
+        case JITOpCode::Remquo:
+        {
+            int quo;
+            XAD_UNUSED_VARIABLE(std::remquo(va, vb, &quo));
+            aa += adj;
+            ab -= adj * Scalar(quo);
+        }
+        break;
+        case JITOpCode::Hypot:
+            aa += adj * va / vResult;
+            ab += adj * vb / vResult;
+            break;
+        case JITOpCode::CExp:
+        case JITOpCode::CLog:
+        case JITOpCode::CSqrt:
+        {
+            Scalar p, q;
+            jitComplexDerivative(op, va, vb, p, q);
+            if (imm != 0.0)
+            {
+                aa += adj * q;
+                ab += adj * p;
+            }
+            else
+            {
+                aa += adj * p;
+                ab -= adj * q;
+            }
+        }
+        break;
+        case JITOpCode::Nextafter:
+            aa += adj;
+            // Second operand has zero derivative
+            break;
+        case JITOpCode::Ldexp:
+        {
+            int exp = static_cast<int>(imm);
+            aa += adj * Scalar(1 << exp);
+        }
+        break;
+        case JITOpCode::Frexp:
+        {
+            // Derivative is 1 / 2^exp, but we need to recompute frexp
+            int exp;
+            std::frexp(va, &exp);
+            aa += adj / Scalar(1 << exp);
+        }
+        break;
+        case JITOpCode::Modf:
+            // Derivative of fractional part is 1
+            aa += adj;
+            break;
+        case JITOpCode::Copysign:
+            // d/da copysign(a, b) = sign(b)
+            aa += adj * ((vb >= Scalar(0)) ? Scalar(1) : Scalar(-1));
+            // d/db copysign(a, b) = 0
+            break;
+        case JITOpCode::SmoothAbs:
+        {
+            Scalar dval;
+            if (va > vb)
+                dval = Scalar(1);
+            else if (va < -vb)
+                dval = Scalar(-1);
+            else if (va < Scalar(0))
+                dval = va / (vb * vb) * (Scalar(3) * va + Scalar(4) * vb);
+            else
+                dval = -va / (vb * vb) * (Scalar(3) * va - Scalar(4) * vb);
+            aa += adj * dval;
+
+            // Derivative w.r.t. c (second parameter)
+            Scalar dcval;
+            if (va > vb || va < -vb)
+                dcval = Scalar(0);
+            else if (va < Scalar(0))
+                dcval = Scalar(-2) * va * va * (vb + va) / (vb * vb * vb);
+            else
+                dcval = Scalar(-2) * va * va * (vb - va) / (vb * vb * vb);
+            ab += adj * dcval;
+        }
+        break;
+        case JITOpCode::CmpLT:
+        case JITOpCode::CmpLE:
+        case JITOpCode::CmpGT:
+        case JITOpCode::CmpGE:
+        case JITOpCode::CmpEQ:
+        case JITOpCode::CmpNE:
+            break;
+        case JITOpCode::If:
+        {
+            if (va != Scalar(0))
+                ab += adj;
+            else
+                ac += adj;
+            break;
+        }
+        case JITOpCode::Fma:
+            aa += adj * vb;
+            ab += adj * va;
+            ac += adj;
+            break;
+        case JITOpCode::Fms:
+            aa += adj * vb;
+            ab += adj * va;
+            ac -= adj;
+            break;
+        case JITOpCode::Fnma:
+            aa -= adj * vb;
+            ab -= adj * va;
+            ac += adj;
+            break;
+        case JITOpCode::MulMul:
+        {
+            aa += adj * vb * vc;
+            ab += adj * va * vc;
+            ac += adj * va * vb;
+            break;
+        }
+        case JITOpCode::DivAdd:
+        {
+            const Scalar den = vb + vc;
+            const Scalar t = adj * vResult / den;
+            aa += adj / den;
+            ab -= t;
+            ac -= t;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
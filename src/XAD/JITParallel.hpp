@@ -0,0 +1,135 @@
+/**
+ *
+ *   Recording and compiling independent JIT graphs on several threads.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITCompiler.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xad
+{
+
+/**
+ * Records and compiles count independent graphs on up to numThreads threads.
+ *
+ * The active JITCompiler is thread-local, and compilers share no other state,
+ * so each worker thread records into its own active compiler. For every index
+ * in [0, count), a worker constructs a JITCompiler<Real, N>, which activates it
+ * on that thread, calls record(jit, index) to register inputs, run the function
+ * and register outputs, then compiles the graph and deactivates the compiler.
+ * Indices are handed out one at a time, so graphs of different sizes balance
+ * across the threads. record may replace the backend with setBackend() before
+ * recording; backends compile concurrently as they share nothing either.
+ *
+ * The calling thread only waits: its active tape and compiler are untouched.
+ * If a call to record throws, no further graphs are started and the first
+ * exception is rethrown once all workers have finished.
+ *
+ * Returns the compiled, inactive compilers in index order. Their registered
+ * input pointers refer to the variables record used, so once those have gone
+ * out of scope replay through the backend (getBackend()->setInputs() and
+ * forward() or forwardAndBackward()) rather than JITCompiler::forward().
+ *
+ * numThreads = 0 uses std::thread::hardware_concurrency(). With
+ * XAD_NO_THREADLOCAL the active compiler is a global, so the graphs are
+ * recorded one after another on a single worker thread.
+ */
+template <class Real, std::size_t N = 1, class Recorder>
+std::vector<JITCompiler<Real, N>> recordJITGraphsParallel(std::size_t count, Recorder record,
+                                                          std::size_t numThreads = 0)
+{
+    std::vector<JITCompiler<Real, N>> compilers;
+    compilers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) compilers.emplace_back(false);
+
+#ifdef XAD_NO_THREADLOCAL
+    numThreads = 1;
+#else
+    if (numThreads == 0)
+        numThreads = std::thread::hardware_concurrency();
+#endif
+    numThreads = (std::max)(numThreads, std::size_t(1));
+    numThreads = (std::min)(numThreads, (std::max)(count, std::size_t(1)));
+
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < count && !failed; i = next++)
+        {
+            try
+            {
+                JITCompiler<Real, N> jit;
+                record(jit, i);
+                jit.deactivate();
+                // compiled in place, as the backend refers to the graph it compiled
+                compilers[i] = std::move(jit);
+                compilers[i].compile();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    try
+    {
+        for (std::size_t t = 0; t < numThreads; ++t) threads.emplace_back(worker);
+    }
+    catch (...)
+    {
+        // could not start a thread - let the running ones stop before unwinding
+        failed = true;
+        for (std::thread& t : threads) t.join();
+        throw;
+    }
+    for (std::thread& t : threads) t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    return compilers;
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,91 @@
+/**
+ *
+ *   Recording of counter-based random draws into JIT graphs.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/JITCompiler.hpp>
+#include <XAD/JITGraph.hpp>
+#include <XAD/JITRandomKernels.hpp>
+#include <XAD/Literals.hpp>
+
+namespace xad
+{
+
+namespace detail
+{
+
+template <class Scalar, std::size_t N>
+AReal<Scalar, N> recordRandom(JITOpCode op, const AReal<Scalar, N>& path, uint32_t stream,
+                              uint32_t draw)
+{
+    const double p = getNestedDoubleValue(value(path));
+    const uint64_t counter = p > 0.0 ? static_cast<uint64_t>(p) : 0u;
+    const double v = op == JITOpCode::RandNormal ? jitRandomNormal(counter, stream, draw)
+                                                 : jitRandomUniform(counter, stream, draw);
+
+    auto* jit = JITCompiler<Scalar, N>::getActive();
+    if (!jit)
+        return AReal<Scalar, N>(static_cast<Scalar>(v));
+
+    uint32_t pathSlot = path.getSlot();
+    if (pathSlot == AReal<Scalar, N>::INVALID_SLOT)
+        pathSlot = jit->recordConstant(p);
+    return jit->recordValueNode(op, pathSlot, jitRandomImmediate(stream, draw),
+                                static_cast<Scalar>(v));
+}
+
+}  // namespace detail
+
+/**
+ * Uniform random draw in (0, 1), computed inside the JIT backend from the path
+ * index, the stream and the draw number.
+ *
+ * The path is usually a registered input holding the Monte-Carlo path index, so
+ * that a replay only needs to upload that index instead of all of its random
+ * numbers. The result only depends on (path, stream, draw), which makes the
+ * draws reproducible regardless of how paths are distributed over threads.
+ * The draw has a zero derivative.
+ *
+ * Without an active JITCompiler, the draw is computed directly.
+ */
+template <class Scalar, std::size_t N>
+AReal<Scalar, N> randUniform(const AReal<Scalar, N>& path, uint32_t stream, uint32_t draw)
+{
+    return detail::recordRandom(JITOpCode::RandUniform, path, stream, draw);
+}
+
+/// Standard normal random draw, the inverse normal of the corresponding randUniform().
+template <class Scalar, std::size_t N>
+AReal<Scalar, N> randNormal(const AReal<Scalar, N>& path, uint32_t stream, uint32_t draw)
+{
+    return detail::recordRandom(JITOpCode::RandNormal, path, stream, draw);
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
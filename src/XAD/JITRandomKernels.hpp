@@ -0,0 +1,150 @@
+/**
+ *
+ *   Counter-based random number kernels for JIT graph evaluation.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <cmath>
+#include <cstdint>
+
+namespace xad
+{
+
+/**
+ * Philox4x32-10 block cipher (Salmon et al., "Parallel Random Numbers: As Easy
+ * as 1, 2, 3", SC11). Encrypts the 128-bit counter ctr with the 64-bit key in
+ * place. Distinct (counter, key) pairs give independent random words, so any
+ * draw can be computed directly without a sequential generator state.
+ */
+inline void jitPhilox4x32(uint32_t ctr[4], const uint32_t key[2])
+{
+    const uint32_t m0 = 0xD2511F53u, m1 = 0xCD9E8D57u;
+    const uint32_t w0 = 0x9E3779B9u, w1 = 0xBB67AE85u;
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round)
+    {
+        const uint64_t p0 = uint64_t(m0) * ctr[0];
+        const uint64_t p1 = uint64_t(m1) * ctr[2];
+        const uint32_t c1 = ctr[1], c3 = ctr[3];
+        ctr[0] = uint32_t(p1 >> 32) ^ c1 ^ k0;
+        ctr[1] = uint32_t(p1);
+        ctr[2] = uint32_t(p0 >> 32) ^ c3 ^ k1;
+        ctr[3] = uint32_t(p0);
+        k0 += w0;
+        k1 += w1;
+    }
+}
+
+/**
+ * Inverse of the standard normal distribution function, algorithm AS 241
+ * (Wichura, Applied Statistics 37, 1988), accurate to about 1e-16 relative.
+ * Requires 0 < p < 1.
+ */
+inline double jitInverseNormal(double p)
+{
+    const double q = p - 0.5;
+    if (std::fabs(q) <= 0.425)
+    {
+        const double r = 0.180625 - q * q;
+        return q *
+               (((((((2.5090809287301226727e+3 * r + 3.3430575583588128105e+4) * r +
+                     6.7265770927008700853e+4) * r + 4.5921953931549871457e+4) * r +
+                   1.3731693765509461125e+4) * r + 1.9715909503065514427e+3) * r +
+                 1.3314166789178437745e+2) * r + 3.3871328727963666080e+0) /
+               (((((((5.2264952788528545610e+3 * r + 2.8729085735721942674e+4) * r +
+                     3.9307895800092710610e+4) * r + 2.1213794301586595867e+4) * r +
+                   5.3941960214247511077e+3) * r + 6.8718700749205790830e+2) * r +
+                 4.2313330701600911252e+1) * r + 1.0);
+    }
+    double r = std::sqrt(-std::log(q < 0.0 ? p : 1.0 - p));
+    double x;
+    if (r <= 5.0)
+    {
+        r -= 1.6;
+        x = (((((((7.74545014278341407640e-4 * r + 2.27238449892691845833e-2) * r +
+                  2.41780725177450611770e-1) * r + 1.27045825245236838258e+0) * r +
+                3.64784832476320460504e+0) * r + 5.76949722146069140550e+0) * r +
+              4.63033784615654529590e+0) * r + 1.42343711074968357734e+0) /
+            (((((((1.05075007164441684324e-9 * r + 5.47593808499534494600e-4) * r +
+                  1.51986665636164571966e-2) * r + 1.48103976427480074590e-1) * r +
+                6.89767334985100004550e-1) * r + 1.67638483018380384940e+0) * r +
+              2.05319162663775882187e+0) * r + 1.0);
+    }
+    else
+    {
+        r -= 5.0;
+        x = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r +
+                  1.24266094738807843860e-3) * r + 2.65321895265761230930e-2) * r +
+                2.96560571828504891230e-1) * r + 1.78482653991729133580e+0) * r +
+              5.46378491116411436990e+0) * r + 6.65790464350110377720e+0) /
+            (((((((2.04426310338993978564e-15 * r + 1.42151175831644588870e-7) * r +
+                  1.84631831751005468180e-5) * r + 7.86869131145613259100e-4) * r +
+                1.48753612908506148525e-2) * r + 1.36929880922735805310e-1) * r +
+              5.99832206555887937690e-1) * r + 1.0);
+    }
+    return q < 0.0 ? -x : x;
+}
+
+/// Packs the stream and draw numbers of a random node into its immediate value.
+inline double jitRandomImmediate(uint32_t stream, uint32_t draw)
+{
+    return double(stream) * 4294967296.0 + double(draw);
+}
+
+/**
+ * Uniform draw in the open interval (0, 1) for the given path, stream and draw
+ * numbers, with 52 random bits. The path is the Philox counter and the stream
+ * the key, so each (path, stream) pair has its own sequence of draws and any
+ * draw of any path is computed independently.
+ */
+inline double jitRandomUniform(uint64_t path, uint32_t stream, uint32_t draw)
+{
+    uint32_t ctr[4] = {draw, 0u, uint32_t(path), uint32_t(path >> 32)};
+    const uint32_t key[2] = {stream, 0x5851F42Du};
+    jitPhilox4x32(ctr, key);
+    const uint64_t bits = (uint64_t(ctr[0] >> 6) << 26) | (ctr[1] >> 6);  // 52 bits
+    return (double(bits) + 0.5) * (1.0 / 4503599627370496.0);
+}
+
+/// Standard normal draw for the given path, stream and draw numbers.
+inline double jitRandomNormal(uint64_t path, uint32_t stream, uint32_t draw)
+{
+    return jitInverseNormal(jitRandomUniform(path, stream, draw));
+}
+
+/// Evaluates a RandUniform / RandNormal node for the given path value and immediate.
+inline double jitRandomFromImmediate(bool normal, double path, double imm)
+{
+    const uint64_t key = static_cast<uint64_t>(imm);
+    const uint64_t p = path > 0.0 ? static_cast<uint64_t>(path) : 0u;
+    const uint32_t stream = uint32_t(key >> 32), draw = uint32_t(key);
+    return normal ? jitRandomNormal(p, stream, draw) : jitRandomUniform(p, stream, draw);
+}
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,92 @@
+/**
+ *
+ *   Checking JIT replays against the same function recorded on a tape.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <XAD/Exceptions.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+namespace xad
+{
+
+/**
+ * Counters of the validation mode of JITCompiler (see JITCompiler::enableValidation).
+ *
+ * Errors are relative, |jit - tape| / max(|tape|, 1), so values and gradients
+ * close to zero are compared absolutely.
+ */
+struct JITValidationStats
+{
+    std::size_t replays = 0;     ///< calls to computeAdjoints() since validation was enabled
+    std::size_t checks = 0;      ///< replays compared against a tape
+    std::size_t mismatches = 0;  ///< checks with an error above the tolerance
+    double maxValueError = 0.0;
+    double maxGradientError = 0.0;
+};
+
+/// Thrown when a JIT replay does not match the tape recording of the same function.
+class JITValidationError : public Exception
+{
+  public:
+    explicit JITValidationError(const std::string& msg) : Exception(msg) {}
+};
+
+namespace detail
+{
+
+inline double jitValidationError(double jit, double tape)
+{
+    if (jit == tape || (jit != jit && tape != tape))  // also equal infinities, or both NaN
+        return 0.0;
+    const double error = std::abs(jit - tape) / (std::max)(std::abs(tape), 1.0);
+    return error == error ? error : HUGE_VAL;
+}
+
+inline std::string jitValidationMessage(const char* what, std::size_t index, std::size_t direction,
+                                        double jit, double tape)
+{
+    std::ostringstream msg;
+    msg.precision(17);
+    msg << "JIT replay differs from the tape: " << what << " " << index;
+    if (direction != std::size_t(-1))
+        msg << " (direction " << direction << ")";
+    msg << " is " << jit << " instead of " << tape
+        << " - was a branch on an active value baked into the graph?";
+    return msg.str();
+}
+
+}  // namespace detail
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
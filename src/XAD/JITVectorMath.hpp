@@ -0,0 +1,521 @@
+/**
+ *
+ *   Vectorisable transcendental math kernels for batch JIT evaluation.
+ *
+ *   This file is part of XAD, a comprehensive C++ library for
+ *   automatic differentiation.
+ *
+ *   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <XAD/Config.hpp>
+
+#ifdef XAD_ENABLE_JIT
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace xad
+{
+
+/// Accuracy tier of the batch math kernels.
+enum class JITMathAccuracy
+{
+    /// Calls the C++ standard library per element; results are bit-identical to the
+    /// scalar interpreter.
+    Libm,
+    /// Branch-free in-tree kernels the compiler can vectorise, with the error bounds
+    /// documented in vecmath (measured against the standard library).
+    Fast
+};
+
+/**
+ * Array math kernels used by the batch JIT backends.
+ *
+ * Every function computes y[i] = f(x[i]) for i < n. With JITMathAccuracy::Libm the
+ * standard library is called per element. With JITMathAccuracy::Fast the following
+ * maximum errors apply for double, measured in units in the last place (ulp) against
+ * the standard library:
+ *
+ * | function  | fast tier bound                                  |
+ * |-----------|--------------------------------------------------|
+ * | sqrt      | correctly rounded (same as std::sqrt)            |
+ * | exp       | 1 ulp                                            |
+ * | log       | 1 ulp                                            |
+ * | pow       | 1 ulp + 2 ulp per unit of abs(y * log(x))        |
+ * | sin, cos  | 2 ulp for abs(x) < 1e5, else std::sin / std::cos |
+ * | erf       | 1 ulp                                            |
+ * | erfc      | 5 ulp (std::erfc itself is up to 3 ulp off)      |
+ *
+ * Single precision inputs are evaluated with the double kernels and rounded once, so
+ * the fast tier is within 1 ulp of the correctly rounded float result.
+ * Special values (NaN, infinities, overflow, underflow, negative bases in pow) are
+ * patched with the standard library in both tiers.
+ */
+namespace vecmath
+{
+namespace detail
+{
+
+inline double fromBits(uint64_t u)
+{
+    double d;
+    std::memcpy(&d, &u, sizeof(d));
+    return d;
+}
+
+inline uint64_t toBits(double d)
+{
+    uint64_t u;
+    std::memcpy(&u, &d, sizeof(u));
+    return u;
+}
+
+// Round to the nearest integer (ties to even) for |x| < 2^51, without leaving the
+// floating point domain so that loops stay vectorisable.
+inline double roundToInt(double x)
+{
+    const double shifter = 6755399441055744.0;  // 1.5 * 2^52
+    return (x + shifter) - shifter;
+}
+
+// v * 2^k for integral k in [-1022, 1024], in two steps so that neither factor overflows
+inline double scaleByPow2(double v, double k)
+{
+    double k1 = roundToInt(k * 0.5);
+    double k2 = k - k1;
+    double s1 = fromBits(static_cast<uint64_t>(static_cast<int64_t>(k1) + 1023) << 52);
+    double s2 = fromBits(static_cast<uint64_t>(static_cast<int64_t>(k2) + 1023) << 52);
+    return (v * s1) * s2;
+}
+
+constexpr double ln2hi = 6.93147180369123816490e-01;  // upper 32 bits of ln(2)
+constexpr double ln2lo = 1.90821492927058770002e-10;  // ln(2) - ln2hi
+constexpr double log2e = 1.44269504088896338700e+00;
+
+// exp(x) for x in the normal result range [-708.39, 709.78]
+inline double expKernel(double x)
+{
+    double k = roundToInt(x * log2e);
+    double hi = x - k * ln2hi;
+    double lo = k * ln2lo;
+    double r = hi - lo;
+    // Taylor polynomial on |r| <= ln(2)/2, truncation error below 2^-60
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    // exp(r) = 1 + r + r^2 * p, with the low part of r folded in separately
+    double rr = r * r;
+    double e = 1.0 + (hi - (lo - rr * p));
+    return scaleByPow2(e, k);
+}
+
+// log(x) for positive normal x
+inline double logKernel(double x)
+{
+    const uint64_t bits = toBits(x);
+    double e = static_cast<double>(static_cast<int64_t>(bits >> 52) - 1023);
+    double m = fromBits((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    // m in [sqrt(2)/2, sqrt(2))
+    bool big = m > 1.4142135623730951;
+    m = big ? m * 0.5 : m;
+    e = big ? e + 1.0 : e;
+
+    // log(m) = log1p(f) = f - f^2/2 + s * (f^2/2 + R(s^2)), s = f / (2 + f)
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double R = 2.0 / 23.0;
+    R = R * z + 2.0 / 21.0;
+    R = R * z + 2.0 / 19.0;
+    R = R * z + 2.0 / 17.0;
+    R = R * z + 2.0 / 15.0;
+    R = R * z + 2.0 / 13.0;
+    R = R * z + 2.0 / 11.0;
+    R = R * z + 2.0 / 9.0;
+    R = R * z + 2.0 / 7.0;
+    R = R * z + 2.0 / 5.0;
+    R = R * z + 2.0 / 3.0;
+    R = R * z;
+    double hfsq = 0.5 * f * f;
+    return e * ln2hi - ((hfsq - (s * (hfsq + R) + e * ln2lo)) - f);
+}
+
+constexpr double pio2_1 = 1.57079632673412561417e+00;   // first 33 bits of pi/2
+constexpr double pio2_2 = 6.07710050630396597660e-11;   // next 33 bits
+constexpr double pio2_3 = 2.02226624871116645580e-21;   // next 33 bits
+constexpr double pio2_3t = 8.47842766036889956997e-32;  // pi/2 - (pio2_1 + pio2_2 + pio2_3)
+constexpr double twoOverPi = 6.36619772367581382433e-01;
+
+// sin and cos polynomials on |r| <= pi/4
+inline double sinPoly(double r)
+{
+    double z = r * r;
+    double p = -1.0 / 121645100408832000.0;
+    p = p * z + 1.0 / 355687428096000.0;
+    p = p * z - 1.0 / 1307674368000.0;
+    p = p * z + 1.0 / 6227020800.0;
+    p = p * z - 1.0 / 39916800.0;
+    p = p * z + 1.0 / 362880.0;
+    p = p * z - 1.0 / 5040.0;
+    p = p * z + 1.0 / 120.0;
+    p = p * z - 1.0 / 6.0;
+    return r + r * z * p;
+}
+
+inline double cosPoly(double r)
+{
+    double z = r * r;
+    double p = -1.0 / 6402373705728000.0;
+    p = p * z + 1.0 / 20922789888000.0;
+    p = p * z - 1.0 / 87178291200.0;
+    p = p * z + 1.0 / 479001600.0;
+    p = p * z - 1.0 / 3628800.0;
+    p = p * z + 1.0 / 40320.0;
+    p = p * z - 1.0 / 720.0;
+    p = p * z + 1.0 / 24.0;
+    double hz = 0.5 * z;
+    double w = 1.0 - hz;
+    return w + (((1.0 - w) - hz) + z * z * p);
+}
+
+// Reduces x to r in [-pi/4, pi/4] with x = r + q * pi/2; valid for |x| < 1e5
+inline double reducePio2(double x, double& q)
+{
+    q = roundToInt(x * twoOverPi);
+    double r = x - q * pio2_1;
+    r = r - q * pio2_2;
+    r = r - q * pio2_3;
+    return r - q * pio2_3t;
+}
+
+inline double sinKernel(double x)
+{
+    double q;
+    double r = reducePio2(x, q);
+    int64_t quadrant = static_cast<int64_t>(q) & 3;
+    double s = sinPoly(r);
+    double c = cosPoly(r);
+    double v = (quadrant & 1) ? c : s;
+    return (quadrant & 2) ? -v : v;
+}
+
+inline double cosKernel(double x)
+{
+    double q;
+    double r = reducePio2(x, q);
+    int64_t quadrant = static_cast<int64_t>(q) & 3;
+    double s = sinPoly(r);
+    double c = cosPoly(r);
+    double v = (quadrant & 1) ? s : c;
+    return ((quadrant + 1) & 2) ? -v : v;
+}
+
+// exp(-x^2) without the rounding error of forming x^2: x = xh + xl with a 26-bit xh,
+// so that xh^2 is exact and the remainder d = xl * (2 xh + xl) is small.
+inline double expMinusSquare(double x)
+{
+    double xh = fromBits(toBits(x) & 0xfffffffff8000000ULL);
+    double xl = x - xh;
+    double d = xl * (xh + xh + xl);
+    double q = 1.0 / 24.0;
+    q = q * d - 1.0 / 6.0;
+    q = q * d + 0.5;
+    q = q * d - 1.0;
+    return expKernel(-xh * xh) * (1.0 + q * d);
+}
+
+// Taylor expansions of erfc around the centres (i + 1/2) / 16, i = 0..63, covering [0, 4).
+// The coefficients are built once from std::erfc and the Hermite recurrence for the
+// derivatives: erfc^(n)(x) = (-1)^n 2/sqrt(pi) H_{n-1}(x) exp(-x^2).
+struct ErfcTable
+{
+    static constexpr int intervals = 64;
+    static constexpr int terms = 14;
+    static constexpr double scale = 16.0;
+    double c[intervals][terms];
+
+    ErfcTable()
+    {
+        // built in long double where available, the extra bits keep the table within
+        // half an ulp of the double coefficients
+        typedef long double ext;
+        const ext twoOverSqrtPi = 1.1283791670955125738961589031215452L;
+        for (int i = 0; i < intervals; ++i)
+        {
+            ext x0 = (i + 0.5L) / scale;
+            c[i][0] = static_cast<double>(std::erfc(x0));
+            ext g = twoOverSqrtPi * std::exp(-x0 * x0);
+            ext hPrev = 0.0L, h = 1.0L;  // H_{-1} (unused), H_0
+            ext factorial = 1.0L;
+            for (int n = 1; n < terms; ++n)
+            {
+                factorial *= n;
+                ext sign = (n % 2) ? -1.0L : 1.0L;
+                c[i][n] = static_cast<double>(sign * g * h / factorial);
+                // H_n = 2 x H_{n-1} - 2 (n-1) H_{n-2}
+                ext hNext = 2.0L * x0 * h - 2.0L * (n - 1) * hPrev;
+                hPrev = h;
+                h = hNext;
+            }
+        }
+    }
+
+    static const ErfcTable& instance()
+    {
+        static const ErfcTable table;
+        return table;
+    }
+};
+
+// erfc(x) for x >= 0 (x < 27.3, larger values underflow and are patched by the caller)
+inline double erfcPositive(double x, const ErfcTable& table)
+{
+    // x in [0, 4): Taylor expansion around the nearest table centre
+    double xt = x < 4.0 ? x : 0.0;
+    int64_t i = static_cast<int64_t>(xt * ErfcTable::scale);
+    double h = xt - (static_cast<double>(i) + 0.5) / ErfcTable::scale;
+    const double* c = table.c[i];
+    double p = c[ErfcTable::terms - 1];
+    for (int n = ErfcTable::terms - 2; n >= 0; --n) p = p * h + c[n];
+
+    // x >= 4: continued fraction erfc(x) = exp(-x^2) / sqrt(pi) / (x + 1/2 / (x + 1 / (x + ...)))
+    double xc = x < 4.0 ? 4.0 : x;
+    double t = xc;
+    for (int n = 40; n > 0; --n) t = xc + (0.5 * n) / t;
+    double cf = 0.56418958354775628695 * expMinusSquare(xc) / t;
+
+    return x < 4.0 ? p : cf;
+}
+
+inline double erfcKernel(double x, const ErfcTable& table)
+{
+    double v = erfcPositive(std::fabs(x), table);
+    return x < 0.0 ? 2.0 - v : v;
+}
+
+inline double erfKernel(double x, const ErfcTable& table)
+{
+    double ax = std::fabs(x);
+    // |x| < 1/2: alternating Maclaurin series, 2/sqrt(pi) sum (-1)^n x^(2n+1) / (n! (2n+1))
+    double z = x * x;
+    double p = -1.0 / (479001600.0 * 25.0);
+    p = p * z + 1.0 / (39916800.0 * 23.0);
+    p = p * z - 1.0 / (3628800.0 * 21.0);
+    p = p * z + 1.0 / (362880.0 * 19.0);
+    p = p * z - 1.0 / (40320.0 * 17.0);
+    p = p * z + 1.0 / (5040.0 * 15.0);
+    p = p * z - 1.0 / (720.0 * 13.0);
+    p = p * z + 1.0 / (120.0 * 11.0);
+    p = p * z - 1.0 / (24.0 * 9.0);
+    p = p * z + 1.0 / (6.0 * 7.0);
+    p = p * z - 1.0 / (2.0 * 5.0);
+    p = p * z + 1.0 / 3.0;
+    double small = 1.12837916709551257390 * (x - x * z * p);
+
+    // otherwise 1 - erfc(|x|), which loses no accuracy since erfc(1/2) < 1/2
+    double v = 1.0 - erfcPositive(ax < 0.5 ? 0.5 : ax, table);
+    double large = x < 0.0 ? -v : v;
+    return ax < 0.5 ? small : large;
+}
+
+inline bool isSpecial(double x) { return !(std::fabs(x) <= std::numeric_limits<double>::max()); }
+
+}  // namespace detail
+
+template <class T>
+void sqrt(const T* x, T* y, std::size_t n, JITMathAccuracy = JITMathAccuracy::Libm)
+{
+    // std::sqrt is correctly rounded and maps to a vector instruction, in both tiers
+    for (std::size_t i = 0; i < n; ++i) y[i] = std::sqrt(x[i]);
+}
+
+template <class T>
+void exp(const T* x, T* y, std::size_t n, JITMathAccuracy acc = JITMathAccuracy::Libm)
+{
+    if (acc == JITMathAccuracy::Libm)
+    {
+        for (std::size_t i = 0; i < n; ++i) y[i] = std::exp(x[i]);
+        return;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double xi = static_cast<double>(x[i]);
+        bool inRange = xi >= -708.39 && xi <= 709.78;
+        y[i] = static_cast<T>(detail::expKernel(inRange ? xi : 0.0));
+    }
+    for (std::size_t i = 0; i < n; ++i)
+            if (!(x[i] >= T(-708.39) && x[i] <= T(709.78)))
+                y[i] = std::exp(x[i]);
+}
+
+template <class T>
+void log(const T* x, T* y, std::size_t n, JITMathAccuracy acc = JITMathAccuracy::Libm)
+{
+    if (acc == JITMathAccuracy::Libm)
+    {
+        for (std::size_t i = 0; i < n; ++i) y[i] = std::log(x[i]);
+        return;
+    }
+    const double minNormal = (std::numeric_limits<double>::min)();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double xi = static_cast<double>(x[i]);
+        bool inRange = xi >= minNormal && !detail::isSpecial(xi);
+        y[i] = static_cast<T>(detail::logKernel(inRange ? xi : 1.0));
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        {
+            double xi = static_cast<double>(x[i]);
+            if (!(xi >= minNormal && !detail::isSpecial(xi)))
+                y[i] = std::log(x[i]);
+        }
+}
+
+template <class T>
+void pow(const T* x, const T* p, T* y, std::size_t n, JITMathAccuracy acc = JITMathAccuracy::Libm)
+{
+    if (acc == JITMathAccuracy::Libm)
+    {
+        for (std::size_t i = 0; i < n; ++i) y[i] = std::pow(x[i], p[i]);
+        return;
+    }
+    const double minNormal = (std::numeric_limits<double>::min)();
+    auto simple = [minNormal](double xi, double pi, double l) {
+        double t = pi * l;
+        return xi >= minNormal && !detail::isSpecial(xi) && !detail::isSpecial(pi) &&
+               t >= -708.39 && t <= 709.78;
+    };
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double xi = static_cast<double>(x[i]);
+        double pi = static_cast<double>(p[i]);
+        bool positive = xi >= minNormal && !detail::isSpecial(xi);
+        double l = detail::logKernel(positive ? xi : 1.0);
+        bool ok = simple(xi, pi, l);
+        y[i] = static_cast<T>(detail::expKernel(ok ? pi * l : 0.0));
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        {
+            double xi = static_cast<double>(x[i]);
+            double pi = static_cast<double>(p[i]);
+            bool positive = xi >= minNormal && !detail::isSpecial(xi);
+            if (!simple(xi, pi, detail::logKernel(positive ? xi : 1.0)))
+                y[i] = std::pow(x[i], p[i]);
+        }
+}
+
+template <class T>
+void sin(const T* x, T* y, std::size_t n, JITMathAccuracy acc = JITMathAccuracy::Libm)
+{
+    if (acc == JITMathAccuracy::Libm)
+    {
+        for (std::size_t i = 0; i < n; ++i) y[i] = std::sin(x[i]);
+        return;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double xi = static_cast<double>(x[i]);
+        bool inRange = std::fabs(xi) < 1e5;
+        y[i] = static_cast<T>(detail::sinKernel(inRange ? xi : 0.0));
+    }
+    for (std::size_t i = 0; i < n; ++i)
+            if (!(std::fabs(static_cast<double>(x[i])) < 1e5))
+                y[i] = std::sin(x[i]);
+}
+
+template <class T>
+void cos(const T* x, T* y, std::size_t n, JITMathAccuracy acc = JITMathAccuracy::Libm)
+{
+    if (acc == JITMathAccuracy::Libm)
+    {
+        for (std::size_t i = 0; i < n; ++i) y[i] = std::cos(x[i]);
+        return;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double xi = static_cast<double>(x[i]);
+        bool inRange = std::fabs(xi) < 1e5;
+        y[i] = static_cast<T>(detail::cosKernel(inRange ? xi : 0.0));
+    }
+    for (std::size_t i = 0; i < n; ++i)
+            if (!(std::fabs(static_cast<double>(x[i])) < 1e5))
+                y[i] = std::cos(x[i]);
+}
+
+template <class T>
+void erf(const T* x, T* y, std::size_t n, JITMathAccuracy acc = JITMathAccuracy::Libm)
+{
+    if (acc == JITMathAccuracy::Libm)
+    {
+        for (std::size_t i = 0; i < n; ++i) y[i] = std::erf(x[i]);
+        return;
+    }
+    const detail::ErfcTable& table = detail::ErfcTable::instance();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double xi = static_cast<double>(x[i]);
+        bool inRange = std::fabs(xi) < 6.0;
+        y[i] = static_cast<T>(detail::erfKernel(inRange ? xi : 0.0, table));
+    }
+    for (std::size_t i = 0; i < n; ++i)
+            if (!(std::fabs(static_cast<double>(x[i])) < 6.0))
+                y[i] = std::erf(x[i]);
+}
+
+template <class T>
+void erfc(const T* x, T* y, std::size_t n, JITMathAccuracy acc = JITMathAccuracy::Libm)
+{
+    if (acc == JITMathAccuracy::Libm)
+    {
+        for (std::size_t i = 0; i < n; ++i) y[i] = std::erfc(x[i]);
+        return;
+    }
+    const detail::ErfcTable& table = detail::ErfcTable::instance();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double xi = static_cast<double>(x[i]);
+        bool inRange = xi > -6.0 && xi < 26.5;
+        y[i] = static_cast<T>(detail::erfcKernel(inRange ? xi : 0.0, table));
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        {
+            double xi = static_cast<double>(x[i]);
+            if (!(xi > -6.0 && xi < 26.5))
+                y[i] = std::erfc(x[i]);
+        }
+}
+
+}  // namespace vecmath
+
+}  // namespace xad
+
+#endif  // XAD_ENABLE_JIT
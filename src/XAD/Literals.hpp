@@ -43,6 +43,46 @@ namespace xad
 {
 template <class, std::size_t>
 class Tape;
+namespace detail
+{
+
+// Only variables recorded by a JIT compiler can bake a condition into its graph
+template <class T>
+struct JITConditionNote
+{
+    template <class Expr1, class Expr2>
+    static XAD_INLINE void note(const Expr1&, const Expr2&)
+    {
+    }
+};
+
+#ifdef XAD_ENABLE_JIT
+template <class Scalar, std::size_t M>
+struct JITConditionNote<AReal<Scalar, M>>
+{
+    template <class Expr1, class Expr2>
+    static XAD_INLINE void note(const Expr1& a, const Expr2& b)
+    {
+        AReal<Scalar, M>::noteJITCondition(a, b);
+    }
+};
+#endif
+
+template <class Scalar, class Derived, class DerivativeType>
+XAD_INLINE void noteJITCondition(const Expression<Scalar, Derived, DerivativeType>& expr)
+{
+    JITConditionNote<typename ExprTraits<Derived>::value_type>::note(expr, expr);
+}
+
+template <class Scalar, class Derived1, class Derived2, class DerivativeType>
+XAD_INLINE void noteJITCondition(const Expression<Scalar, Derived1, DerivativeType>& a,
+                                 const Expression<Scalar, Derived2, DerivativeType>& b)
+{
+    JITConditionNote<typename ExprTraits<Derived1>::value_type>::note(a, b);
+}
+
+}  // namespace detail
+
 template <class, std::size_t>
 struct FReal;
 
@@ -283,12 +323,11 @@ struct AReal
 
 #ifdef XAD_ENABLE_JIT
   private:
-    // JIT is intentionally limited to scalar, first-order mode only:
-    // - vector mode (N>1) is not supported
+    // JIT is intentionally limited to first-order mode:
     // - higher-order AD (Scalar != nested_type) is not supported
     enum
     {
-        jit_supported = std::is_same<Scalar, nested_type>::value && (N == 1)
+        jit_supported = std::is_same<Scalar, nested_type>::value
     };
 
     static XAD_INLINE jit_type* getActiveJitImpl(std::true_type) { return jit_type::getActive(); }
@@ -332,6 +371,19 @@ struct AReal
     {
     }
 
+    template <class Expr1, class Expr2>
+    static XAD_INLINE void noteJITConditionImpl(const Expr1& a, const Expr2& b, std::true_type)
+    {
+        jit_type* j = jit_type::getActive();
+        if (j && (a.shouldRecord() || b.shouldRecord()))
+            j->noteBakedCondition();
+    }
+
+    template <class Expr1, class Expr2>
+    static XAD_INLINE void noteJITConditionImpl(const Expr1&, const Expr2&, std::false_type)
+    {
+    }
+
   private:
     // Only enable the JIT derivative path when it is type-correct.
     // For higher-order AD (Scalar != nested_type) we must not even instantiate code that
@@ -448,6 +500,14 @@ struct AReal
         // Not registered - treat as constant (handles nested AD types)
         return recordJITConstant(graph, getNestedDoubleValue(this->a_));
     }
+
+    /// Notes on the active JIT compiler that a C++ condition depends on the values of
+    /// a and b, if either is recorded (see JITCompiler::numBakedConditions).
+    template <class Expr1, class Expr2>
+    static XAD_INLINE void noteJITCondition(const Expr1& a, const Expr2& b)
+    {
+        noteJITConditionImpl(a, b, std::integral_constant<bool, jit_supported>());
+    }
 #endif
 
   private:
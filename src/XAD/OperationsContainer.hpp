@@ -25,9 +25,11 @@
 #pragma once
 
 #include <XAD/ChunkContainer.hpp>
+#include <XAD/ChunkSpill.hpp>
 
 #include <iterator>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -68,6 +70,10 @@ class OperationsContainer
     using slot_type = S;
     static constexpr std::size_t chunk_size = ChunkSize;
     static constexpr std::size_t ALIGNMENT = 128;
+    static constexpr std::size_t SLOT_OFFSET =
+        ((ChunkSize * sizeof(mul_type) + alignof(slot_type) - 1) / alignof(slot_type)) *
+        sizeof(slot_type);
+    static constexpr std::size_t CHUNK_BYTES = SLOT_OFFSET + sizeof(slot_type) * ChunkSize;
     static_assert(std::is_integral<slot_type>::value, "S type must be an integral type");
 
     OperationsContainer()
@@ -99,16 +105,22 @@ class OperationsContainer
     void resize(size_type s)
     {
         reserve(s);
+        if (spill_)
+            spill_->truncate(s / ChunkSize, chunks_, true);
         if (s < size())
         {
             destruct_elements(s);
         }
         else
         {
+            if (spill_)
+                spill_->allocate(chunk_, (std::min)(s / ChunkSize + 1, chunks_.size()), chunks_);
             construct_elements(s);
         }
         chunk_ = s / ChunkSize;
         idx_ = s % ChunkSize;
+        if (spill_)
+            spill_->writing(chunk_, chunks_);
     }
 
     void clear()
@@ -116,8 +128,32 @@ class OperationsContainer
         destruct_elements(0);
         chunk_ = 0;
         idx_ = 0;
+        if (spill_)
+            spill_->truncate(0, chunks_, false);
     }
 
+    // keep the completed chunks in a file in the given directory from now on
+    void enable_spill(const std::string& directory)
+    {
+        if (!std::is_trivially_copy_constructible<mul_type>::value ||
+            !std::is_trivially_destructible<mul_type>::value)
+            throw Exception("only operations of trivially copyable types can be spilled");
+        disable_spill();
+        spill_.reset(new detail::ChunkSpill<AllocHelper>(directory, CHUNK_BYTES, ALIGNMENT));
+        spill_->writing(chunk_, chunks_);
+    }
+    // read all chunks back into memory and stop spilling
+    void disable_spill()
+    {
+        if (!spill_)
+            return;
+        spill_->restoreAll(chunks_);
+        spill_.reset();
+    }
+    bool spilling() const { return spill_ != nullptr; }
+    size_type spilled_chunks() const { return spill_ ? spill_->spilled() : 0; }
+    size_type spilled_bytes() const { return spill_ ? spill_->bytes() : 0; }
+
     void push_back(T multiplier, S slot)
     {
         if (XAD_VERY_UNLIKELY(idx_ == ChunkSize))
@@ -125,6 +161,8 @@ class OperationsContainer
             addChunks(1);
             idx_ = 0;
             ++chunk_;
+            if (spill_)
+                spill_->writing(chunk_, chunks_);
         }
         push_back_unsafe(std::move(multiplier), std::move(slot));
     }
@@ -135,6 +173,8 @@ class OperationsContainer
         {
             ++chunk_;
             idx_ = 0;
+            if (spill_)
+                spill_->writing(chunk_, chunks_);
         }
         ::new (&mul_chunk(chunk_)[idx_]) T(std::move(multiplier));
         ::new (&slot_chunk(chunk_)[idx_]) S(std::move(slot));
@@ -156,6 +196,8 @@ class OperationsContainer
             addChunks(1);
             ++chunk_;
             idx_ = 0;
+            if (spill_)
+                spill_->writing(chunk_, chunks_);
             n -= items;
             muls += items;
             slots += items;
@@ -208,6 +250,21 @@ class OperationsContainer
         }
     }
 
+    // Apply the given function with the signature void f(slot_type&) to the slots
+    // of all elements between startidx and endidx, which it may modify
+    template <class Func>
+    void for_each_slot(size_type startidx, size_type endidx, Func f)
+    {
+        for (size_type c = startidx / ChunkSize, e = (endidx + ChunkSize - 1) / ChunkSize; c < e;
+             ++c)
+        {
+            auto chk_slot = slot_chunk(c);
+            size_type first = c == startidx / ChunkSize ? startidx % ChunkSize : 0;
+            size_type last = (std::min)(endidx - c * ChunkSize, size_type(ChunkSize));
+            for (size_type i = first; i < last; ++i) f(chk_slot[i]);
+        }
+    }
+
   private:
     XAD_FORCE_INLINE mul_type* mul_chunk(size_type chunk)
     {
@@ -215,33 +272,32 @@ class OperationsContainer
     }
     XAD_FORCE_INLINE slot_type* slot_chunk(size_type chunk)
     {
-        constexpr std::size_t SLOT_OFFSET =
-            ((ChunkSize * sizeof(mul_type) + alignof(slot_type) - 1) / alignof(slot_type)) *
-            sizeof(slot_type);
-
         return reinterpret_cast<slot_type*>(chunks_[chunk].get() + SLOT_OFFSET);
     }
     XAD_FORCE_INLINE const mul_type* mul_chunk(size_type chunk) const
     {
+        if (XAD_VERY_UNLIKELY(!chunks_[chunk]))
+            restore(chunk);
         return reinterpret_cast<const mul_type*>(chunks_[chunk].get());
     }
     XAD_FORCE_INLINE const slot_type* slot_chunk(size_type chunk) const
     {
-        constexpr std::size_t SLOT_OFFSET =
-            ((ChunkSize * sizeof(mul_type) + alignof(slot_type) - 1) / alignof(slot_type)) *
-            sizeof(slot_type);
+        if (XAD_VERY_UNLIKELY(!chunks_[chunk]))
+            restore(chunk);
         return reinterpret_cast<const slot_type*>(chunks_[chunk].get() + SLOT_OFFSET);
     }
 
+    XAD_NEVER_INLINE void restore(size_type chunk) const { spill_->restore(chunk, chunks_); }
+
     void addChunks(size_type newChunks)
     {
-        constexpr std::size_t SLOT_OFFSET =
-            ((ChunkSize * sizeof(mul_type) + alignof(slot_type) - 1) / alignof(slot_type)) *
-            sizeof(slot_type);
-        constexpr std::size_t CHUNK_BYTES = SLOT_OFFSET + sizeof(slot_type) * ChunkSize;
-
         for (size_type i = 0; i < newChunks; ++i)
         {
+            if (spill_)  // given a buffer when written to
+            {
+                chunks_.emplace_back(nullptr);
+                continue;
+            }
             auto chunk = AllocHelper::aligned_alloc(ALIGNMENT, CHUNK_BYTES);
             if (chunk == nullptr)
                 throw std::bad_alloc();
@@ -359,7 +415,9 @@ class OperationsContainer
         }
     }
 
-    std::vector<std::unique_ptr<char, AllocHelper>> chunks_;
+    // chunks spilled to a file are null, and read back on access
+    mutable std::vector<std::unique_ptr<char, AllocHelper>> chunks_;
+    std::unique_ptr<detail::ChunkSpill<AllocHelper>> spill_;
     size_type idx_ = 0;
     size_type chunk_ = 0;
 };
@@ -24,9 +24,11 @@
 
 #pragma once
 
+#include <XAD/ChunkSpill.hpp>
 #include <XAD/OperationsContainer.hpp>
 
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -44,6 +46,7 @@ class OperationsContainerPaired
     using slot_type = S;
     static constexpr std::size_t ALIGNMENT = 128;
     static constexpr std::size_t chunk_size = ChunkSize;
+    static constexpr std::size_t CHUNK_BYTES = ChunkSize * sizeof(std::pair<mul_type, slot_type>);
     static_assert(std::is_integral<slot_type>::value, "S type must be an integral type");
 
     OperationsContainerPaired()
@@ -75,24 +78,54 @@ class OperationsContainerPaired
     void resize(size_type s)
     {
         reserve(s);
+        if (spill_)
+            spill_->truncate(s / ChunkSize, chunks_, true);
         if (XAD_LIKELY(s < size()))
         {
             destruct_elements(s);
         }
         else
         {
+            if (spill_)
+                spill_->allocate(chunk_, (std::min)(s / ChunkSize + 1, chunks_.size()), chunks_);
             construct_elements(s);
         }
         chunk_ = s / ChunkSize;
         idx_ = s % ChunkSize;
+        if (spill_)
+            spill_->writing(chunk_, chunks_);
     }
     void clear()
     {
         destruct_elements(0);
         chunk_ = 0;
         idx_ = 0;
+        if (spill_)
+            spill_->truncate(0, chunks_, false);
     }
 
+    // keep the completed chunks in a file in the given directory from now on
+    void enable_spill(const std::string& directory)
+    {
+        if (!std::is_trivially_copy_constructible<mul_type>::value ||
+            !std::is_trivially_destructible<mul_type>::value)
+            throw Exception("only operations of trivially copyable types can be spilled");
+        disable_spill();
+        spill_.reset(new detail::ChunkSpill<AllocHelper>(directory, CHUNK_BYTES, ALIGNMENT));
+        spill_->writing(chunk_, chunks_);
+    }
+    // read all chunks back into memory and stop spilling
+    void disable_spill()
+    {
+        if (!spill_)
+            return;
+        spill_->restoreAll(chunks_);
+        spill_.reset();
+    }
+    bool spilling() const { return spill_ != nullptr; }
+    size_type spilled_chunks() const { return spill_ ? spill_->spilled() : 0; }
+    size_type spilled_bytes() const { return spill_ ? spill_->bytes() : 0; }
+
     void push_back(const T& multiplier, const S& slot)
     {
         if (XAD_VERY_UNLIKELY(idx_ == ChunkSize))
@@ -100,6 +133,8 @@ class OperationsContainerPaired
             addChunks(1);
             idx_ = 0;
             ++chunk_;
+            if (spill_)
+                spill_->writing(chunk_, chunks_);
         }
         push_back_unsafe(multiplier, slot);
     }
@@ -110,6 +145,8 @@ class OperationsContainerPaired
         {
             ++chunk_;
             idx_ = 0;
+            if (spill_)
+                spill_->writing(chunk_, chunks_);
         }
         ::new (&chunk(chunk_)[idx_]) std::pair<T, S>(std::move(multiplier), slot);
         ++idx_;
@@ -136,6 +173,8 @@ class OperationsContainerPaired
             addChunks(1);
             ++chunk_;
             idx_ = 0;
+            if (spill_)
+                spill_->writing(chunk_, chunks_);
             n -= items;
 
             items = (std::min)(ChunkSize, n);
@@ -189,6 +228,21 @@ class OperationsContainerPaired
         }
     }
 
+    // Apply the given function with the signature void f(slot_type&) to the slots
+    // of all elements between startidx and endidx, which it may modify
+    template <class Func>
+    void for_each_slot(size_type startidx, size_type endidx, Func f)
+    {
+        for (size_type c = startidx / ChunkSize, e = (endidx + ChunkSize - 1) / ChunkSize; c < e;
+             ++c)
+        {
+            auto chk = chunk(c);
+            size_type first = c == startidx / ChunkSize ? startidx % ChunkSize : 0;
+            size_type last = (std::min)(endidx - c * ChunkSize, size_type(ChunkSize));
+            for (size_type i = first; i < last; ++i) f(chk[i].second);
+        }
+    }
+
   private:
     XAD_FORCE_INLINE std::pair<mul_type, slot_type>* chunk(size_type chunk)
     {
@@ -196,15 +250,23 @@ class OperationsContainerPaired
     }
     XAD_FORCE_INLINE const std::pair<mul_type, slot_type>* chunk(size_type chunk) const
     {
+        if (XAD_VERY_UNLIKELY(!chunks_[chunk]))
+            restore(chunk);
         return reinterpret_cast<const std::pair<mul_type, slot_type>*>(chunks_[chunk].get());
     }
 
+    XAD_NEVER_INLINE void restore(size_type chunk) const { spill_->restore(chunk, chunks_); }
+
     void addChunks(size_type newChunks)
     {
         for (size_type i = 0; i < newChunks; ++i)
         {
-            auto chunk = AllocHelper::aligned_alloc(
-                ALIGNMENT, ChunkSize * sizeof(std::pair<mul_type, slot_type>));
+            if (spill_)  // given a buffer when written to
+            {
+                chunks_.emplace_back(nullptr);
+                continue;
+            }
+            auto chunk = AllocHelper::aligned_alloc(ALIGNMENT, CHUNK_BYTES);
             if (chunk == nullptr)
                 throw std::bad_alloc();
             chunks_.emplace_back(reinterpret_cast<char*>(chunk));
@@ -313,7 +375,9 @@ class OperationsContainerPaired
         }
     }
 
-    std::vector<std::unique_ptr<char, AllocHelper>> chunks_;
+    // chunks spilled to a file are null, and read back on access
+    mutable std::vector<std::unique_ptr<char, AllocHelper>> chunks_;
+    std::unique_ptr<detail::ChunkSpill<AllocHelper>> spill_;
     size_type idx_ = 0;
     size_type chunk_ = 0;
 };
@@ -0,0 +1,172 @@
+/*******************************************************************************
+
+   ReusableSlots, used in Tape to keep track of slots that can be re-used
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xad
+{
+
+// Set of free slots, held as a bitmap for membership and a stack for handing them out
+// again, most recently freed first. Slots erased from the bitmap directly leave stale
+// entries on the stack, which are skipped when they come up. All operations besides
+// the range queries are amortised O(1) and allocation-free once the vectors have grown.
+template <class T>
+class ReusableSlots
+{
+  public:
+    typedef std::size_t position_type;
+
+    bool empty() const { return count_ == 0; }
+    T size() const { return count_; }
+
+    // marks the point after which insertions can be taken by take()
+    position_type position() const { return stack_.size(); }
+
+    bool contains(T slot) const
+    {
+        std::size_t w = word(slot);
+        return w < bits_.size() && (bits_[w] & mask(slot)) != 0;
+    }
+
+    void insert(T slot)
+    {
+        assert(!contains(slot));
+        std::size_t w = word(slot);
+        if (w >= bits_.size())
+            bits_.resize(w + 1 > 2 * bits_.size() ? w + 1 : 2 * bits_.size(), 0);
+        bits_[w] |= mask(slot);
+        stack_.push_back(slot);
+        ++count_;
+    }
+
+    // takes the most recently freed slot inserted after position start
+    bool take(T& slot, position_type start = 0)
+    {
+        while (stack_.size() > start)
+        {
+            T s = stack_.back();
+            stack_.pop_back();
+            if (erase(s))
+            {
+                slot = s;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool erase(T slot)
+    {
+        if (!contains(slot))
+            return false;
+        bits_[word(slot)] &= ~mask(slot);
+        --count_;
+        return true;
+    }
+
+    // drops the slots inserted after position start
+    void truncate(position_type start)
+    {
+        while (stack_.size() > start)
+        {
+            erase(stack_.back());
+            stack_.pop_back();
+        }
+    }
+
+    // drops the slots from first onwards
+    void eraseFrom(T first)
+    {
+        for (std::size_t w = word(first); w < bits_.size(); ++w)
+        {
+            std::uint64_t m = bits_[w];
+            if (w == word(first))
+                m &= ~(mask(first) - 1);
+            bits_[w] &= ~m;
+            for (; m; m &= m - 1) --count_;
+        }
+    }
+
+    void clear()
+    {
+        stack_.clear();
+        bits_.assign(bits_.size(), 0);
+        count_ = 0;
+    }
+
+    // calls f(first, last) for each maximal range [first, last) of free slots, in order
+    template <class F>
+    void forEachRange(F f) const
+    {
+        bool open = false;
+        T first = T();
+        for (std::size_t w = 0; w < bits_.size(); ++w)
+        {
+            for (unsigned b = 0; b < 64; ++b)
+            {
+                T s = T(w * 64 + b);
+                if (((bits_[w] >> b) & 1) != 0)
+                {
+                    if (!open)
+                        first = s;
+                    open = true;
+                }
+                else if (open)
+                {
+                    f(first, s);
+                    open = false;
+                }
+            }
+        }
+        if (open)
+            f(first, T(bits_.size() * 64));
+    }
+
+    std::size_t numRanges() const
+    {
+        std::size_t n = 0;
+        forEachRange([&n](T, T) { ++n; });
+        return n;
+    }
+
+    std::size_t memory() const
+    {
+        return stack_.size() * sizeof(T) + bits_.size() * sizeof(std::uint64_t);
+    }
+
+  private:
+    static std::size_t word(T slot) { return std::size_t(slot) / 64; }
+    static std::uint64_t mask(T slot) { return std::uint64_t(1) << (std::size_t(slot) % 64); }
+
+    std::vector<T> stack_;
+    std::vector<std::uint64_t> bits_;
+    T count_ = 0;
+};
+
+}  // namespace xad
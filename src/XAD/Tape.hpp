@@ -28,13 +28,14 @@
 #include <XAD/Exceptions.hpp>
 #include <XAD/Macros.hpp>
 #include <XAD/ReusableRange.hpp>
+#include <XAD/ReusableSlots.hpp>
 #include <XAD/TapeContainer.hpp>
 #include <XAD/Traits.hpp>
 #include <XAD/TypeTraits.hpp>
 #include <XAD/Vec.hpp>
 #include <complex>
-#include <list>
 #include <stack>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -181,6 +182,18 @@ class Tape
     void computeAdjoints();
     void clearAll();
 
+    // renumber the slots of the recording by liveness in the reverse sweep, keeping the
+    // given variables usable, and return the number of adjoints needed from now on
+    size_type compact(const std::vector<active_type*>& keep);
+    size_type compact(std::vector<active_type>& inputs, std::vector<active_type>& outputs)
+    {
+        std::vector<active_type*> keep;
+        keep.reserve(inputs.size() + outputs.size());
+        for (auto& x : inputs) keep.push_back(&x);
+        for (auto& y : outputs) keep.push_back(&y);
+        return compact(keep);
+    }
+
     // derivatives
     void clearDerivatives();
     derivative_type& derivative(slot_type s);
@@ -194,6 +207,16 @@ class Tape
     void printStatus() const;
     std::size_t getMemory() const;
 
+    // out-of-core recording: completed chunks of the tape are kept in files in the given
+    // directory and read back during the reverse sweep
+    void enableSpill(const std::string& directory);
+    void disableSpill();
+    bool isSpilling() const { return statement_.spilling(); }
+    std::size_t getSpilledMemory() const
+    {
+        return operations_.spilled_bytes() + statement_.spilled_bytes();
+    }
+
     // checkpointing API
     void insertCallback(callback_type cb);
     derivative_type getAndResetOutputAdjoint(slot_type slot);
@@ -223,7 +246,8 @@ class Tape
     {
 #ifndef XAD_TAPE_REUSE_SLOTS
         --currentRec_->numDerivatives_;
-        if (slot == currentRec_->iDerivative_ - 1)  // it's at the end of the tape
+        // slots below the floor may have been renumbered by compact()
+        if (slot == currentRec_->iDerivative_ - 1 && slot >= slotFloor_)  // at the end of the tape
             --currentRec_->iDerivative_;
 #else
         unregisterVariableReuseSlots(slot);
@@ -278,12 +302,35 @@ class Tape
     typedef std::pair<position_type, CheckpointCallback<Tape>*> chkpt_type;
     std::vector<chkpt_type> checkpoints_;
     std::vector<CheckpointCallback<Tape>*> callbacks_;
+    slot_type slotFloor_ = 0;  // slots handed out before the last compact() are never reused
 #ifdef XAD_TAPE_REUSE_SLOTS
-    slot_type registerVariableReuseSlots();
-    void unregisterVariableReuseSlots(slot_type slot);
+    XAD_INLINE slot_type registerVariableReuseSlots()
+    {
+        slot_type slot;
+        if (reusable_slots_.take(slot, currentRec_->reuseStart_))
+            return slot;
+        return registerVariableAtEnd();
+    }
+
+    XAD_INLINE void unregisterVariableReuseSlots(slot_type slot)
+    {
+        --currentRec_->numDerivatives_;
+        if (slot < slotFloor_)  // may have been renumbered by compact()
+            return;
+        if (slot == currentRec_->iDerivative_ - 1)  // it's at the end of the tape
+        {
+            // free slots directly below are handed out at the end again
+            do
+                --currentRec_->iDerivative_;
+            while (currentRec_->iDerivative_ > currentRec_->startDerivative_ &&
+                   reusable_slots_.erase(currentRec_->iDerivative_ - 1));
+        }
+        else
+            reusable_slots_.insert(slot);
+    }
+
     typedef ReusableRange<slot_type> slot_range_type;
-    typedef std::list<slot_range_type> range_list;
-    range_list reusable_ranges_;
+    ReusableSlots<slot_type> reusable_slots_;
 #endif
 
     void foldSubrecordings();
@@ -300,8 +347,7 @@ class Tape
               startDerivative_(),
               prevMax_(slot_type(-1)),
 #ifdef XAD_TAPE_REUSE_SLOTS
-              startRange_(parent->reusable_ranges_.end()),
-              latestRange_(parent->reusable_ranges_.end()),
+              reuseStart_(parent->reusable_slots_.position()),
 #endif
               derivativesInitialized_(false)
         {
@@ -315,8 +361,7 @@ class Tape
         slot_type startDerivative_;
         slot_type prevMax_;
 #ifdef XAD_TAPE_REUSE_SLOTS
-        range_list::iterator startRange_;
-        range_list::iterator latestRange_;
+        std::size_t reuseStart_;  // only slots freed within this recording are reused
 #endif
         bool derivativesInitialized_;
     };
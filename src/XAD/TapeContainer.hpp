@@ -25,12 +25,17 @@
 #pragma once
 
 #include <XAD/ChunkContainer.hpp>
+#ifdef XAD_TAPE_COMPRESSED
+#include <XAD/CompressedTape.hpp>
+#endif
 #ifdef XAD_REDUCED_MEMORY
 #include <XAD/OperationsContainer.hpp>
 #else
 #include <XAD/OperationsContainerPaired.hpp>
 #endif
 
+#include <cstddef>
+#include <type_traits>
 #include <utility>
 
 namespace xad
@@ -39,12 +44,74 @@ namespace xad
 template <class T, class S = unsigned>
 struct TapeContainerTraits
 {
+#ifdef XAD_TAPE_FLOAT_MULTIPLIERS
+    // double recordings keep their multipliers in single precision
+    using mul_type = typename std::conditional<std::is_same<T, double>::value, float, T>::type;
+#else
+    using mul_type = T;
+#endif
+#ifdef XAD_TAPE_COMPRESSED
+    using statements_type = CompressedStatements<S>;
+#else
     using statements_type = ChunkContainer<std::pair<S, S>>;
+#endif
 #ifdef XAD_REDUCED_MEMORY
-    using operations_type = OperationsContainer<T, S>;
+    using uncompressed_operations_type = OperationsContainer<mul_type, S>;
 #else
-    using operations_type = OperationsContainerPaired<T, S>;
+    using uncompressed_operations_type = OperationsContainerPaired<mul_type, S>;
+#endif
+#ifdef XAD_TAPE_COMPRESSED
+    // higher-order tapes record active multipliers, which are kept uncompressed
+    using operations_type =
+        typename std::conditional<detail::is_compressible_multiplier<mul_type>::value,
+                                  CompressedOperations<mul_type, S>,
+                                  uncompressed_operations_type>::type;
+#else
+    using operations_type = uncompressed_operations_type;
 #endif
 };
 
+namespace detail
+{
+// the number of operations held in a tape operations container, and the bytes they take
+template <class C>
+std::size_t numOperations(const C& c)
+{
+    return c.size();
+}
+
+template <class C>
+std::size_t operationsMemory(const C& c)
+{
+    return c.size() * (sizeof(typename C::mul_type) + sizeof(typename C::slot_type));
+}
+
+// the bytes taken by the statements of a tape
+template <class C>
+std::size_t statementsMemory(const C& c)
+{
+    return c.size() * sizeof(typename C::value_type);
+}
+
+#ifdef XAD_TAPE_COMPRESSED
+template <class T, class S, std::size_t ChunkBytes, class AllocHelper>
+std::size_t numOperations(const CompressedOperations<T, S, ChunkBytes, AllocHelper>& c)
+{
+    return c.count();
+}
+
+template <class T, class S, std::size_t ChunkBytes, class AllocHelper>
+std::size_t operationsMemory(const CompressedOperations<T, S, ChunkBytes, AllocHelper>& c)
+{
+    return c.memory();
+}
+
+template <class S, std::size_t ChunkBytes, class AllocHelper>
+std::size_t statementsMemory(const CompressedStatements<S, ChunkBytes, AllocHelper>& c)
+{
+    return c.memory();
+}
+#endif
+}  // namespace detail
+
 }  // namespace xad
@@ -0,0 +1,96 @@
+/*******************************************************************************
+
+   Validation of tape gradients against full-precision forward mode.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#pragma once
+
+#include <XAD/Jacobian.hpp>
+#include <XAD/XAD.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace xad
+{
+
+// The Jacobians of a function computed with a tape and with forward mode, and their
+// largest differences. Relative errors are taken to the largest forward-mode derivative
+// of the same output, so that derivatives close to zero do not dominate them.
+template <typename T>
+struct TapeValidationResult
+{
+    std::vector<std::vector<T>> adjoint;    // from the tape, one row per output
+    std::vector<std::vector<T>> reference;  // from forward mode
+    T maxAbsError = T();
+    T maxRelError = T();
+    std::size_t output = 0;  // position of the largest relative error
+    std::size_t input = 0;
+};
+
+// Compares the Jacobian recorded on the tape, for example with single-precision
+// multipliers (XAD_TAPE_FLOAT_MULTIPLIERS), against forward mode, which does not use the
+// tape and gives the derivatives in full precision. The function is given twice, for
+// both active types - a generic lambda can be passed for both.
+template <typename T>
+TapeValidationResult<T> validateTapeGradients(
+    const std::vector<T> &x,
+    std::function<std::vector<AReal<T>>(std::vector<AReal<T>> &)> adjointFunc,
+    std::function<std::vector<FReal<T>>(std::vector<FReal<T>> &)> forwardFunc,
+    Tape<T> *tape = Tape<T>::getActive())
+{
+    TapeValidationResult<T> result;
+    std::vector<AReal<T>> xa(x.begin(), x.end());
+    std::vector<FReal<T>> xf(x.begin(), x.end());
+    result.adjoint = computeJacobian(xa, adjointFunc, 0U, tape);
+    result.reference = computeJacobian(xf, forwardFunc);
+    if (result.adjoint.size() != result.reference.size())
+        throw OutOfRange("adjoint and forward functions have different numbers of outputs");
+
+    for (std::size_t i = 0; i < result.reference.size(); ++i)
+    {
+        T scale = T();
+        for (auto &r : result.reference[i]) scale = (std::max)(scale, T(std::abs(r)));
+        for (std::size_t j = 0; j < x.size(); ++j)
+        {
+            const T a = result.adjoint[i][j], r = result.reference[i][j];
+            T error = T();
+            if (!(a == r || (a != a && r != r)))  // also equal infinities, or both NaN
+                error = a - r == a - r ? T(std::abs(a - r)) : std::numeric_limits<T>::infinity();
+            const T relError = scale == T() ? error : error / scale;
+            result.maxAbsError = (std::max)(result.maxAbsError, error);
+            if (relError > result.maxRelError)
+            {
+                result.maxRelError = relError;
+                result.output = i;
+                result.input = j;
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace xad
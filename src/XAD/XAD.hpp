@@ -52,6 +52,14 @@
 
 // JIT compilation support (optional, controlled by XAD_ENABLE_JIT)
 #ifdef XAD_ENABLE_JIT
+#include <XAD/JITBatchInterpreter.hpp>
 #include <XAD/JITCompiler.hpp>
+#include <XAD/JITExternalFunction.hpp>
+#include <XAD/JITGraphMerge.hpp>
+#include <XAD/JITGraphPasses.hpp>
+#include <XAD/JITParallel.hpp>
+#include <XAD/JITGraphStats.hpp>
+#include <XAD/JITMixedPrecision.hpp>
+#include <XAD/JITRandom.hpp>
 #include <XAD/ABool.hpp>
 #endif
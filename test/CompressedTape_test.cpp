@@ -0,0 +1,292 @@
+/*******************************************************************************
+
+   Tests for the compressed tape containers.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/CompressedTape.hpp>
+#include <XAD/XAD.hpp>
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// the smallest chunks that hold a record of double operations, to cross chunks often
+const std::size_t SMALL_CHUNK = 16384;
+typedef xad::CompressedOperations<double, unsigned, SMALL_CHUNK> small_operations;
+typedef xad::CompressedStatements<unsigned, 256> small_statements;
+
+bool sameBits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+}  // namespace
+
+TEST(CompressedTape, varintsReadForwardAndBackward)
+{
+    std::vector<std::uint64_t> values = {0,          1,          127,        128,
+                                         300,        16383,      16384,      0xffffffffu,
+                                         1ull << 35, 1ull << 63, ~0ull};
+    unsigned char buf[256] = {0};
+    unsigned char* p = buf + 1;
+    for (auto v : values) p = xad::detail::putVarint(p, v);
+    EXPECT_EQ(std::size_t(1 + 1 + 1 + 2 + 2 + 2 + 3 + 5 + 6 + 10 + 10), std::size_t(p - buf - 1));
+
+    const unsigned char* q = buf + 1;
+    for (auto v : values) EXPECT_EQ(v, xad::detail::getVarint(q));
+    EXPECT_EQ(p, q);
+
+    for (std::size_t i = values.size(); i-- > 0;)
+        EXPECT_EQ(values[i], xad::detail::getVarintBack(q));
+    EXPECT_EQ(buf + 1, q);
+}
+
+TEST(CompressedTape, slotDifferencesWrapAround)
+{
+    const unsigned big = std::numeric_limits<unsigned>::max();
+    for (auto p : {std::make_pair(0u, big), std::make_pair(big, 0u), std::make_pair(5u, 3u),
+                   std::make_pair(3u, 5u), std::make_pair(7u, 7u)})
+    {
+        auto z = xad::detail::zigzag(p.first, p.second);
+        EXPECT_LE(z, 4u);
+        EXPECT_EQ(p.second, xad::detail::addDelta(p.first, xad::detail::unzigzag<unsigned>(z)));
+    }
+    EXPECT_EQ(-4, xad::detail::addDelta(3, xad::detail::unzigzag<int>(xad::detail::zigzag(3, -4))));
+}
+
+TEST(CompressedTape, operationsKeepAllMultipliersExactly)
+{
+    const double muls[] = {1.0,
+                           -1.0,
+                           0.5,
+                           0.1,
+                           -0.0,
+                           0.0,
+                           1e300,
+                           -3.0e38,
+                           std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::quiet_NaN(),
+                           std::numeric_limits<double>::denorm_min(),
+                           double(std::numeric_limits<float>::denorm_min())};
+    const unsigned slots[] = {4, 3, 1000000, 0, 7, 7, 0xfffffffeu, 1, 2, 9, 12, 5};
+    const std::size_t n = sizeof(muls) / sizeof(muls[0]);
+
+    xad::CompressedOperations<double, unsigned> ops;
+    EXPECT_TRUE(ops.empty());
+    auto start = ops.size();
+    ops.append_n(muls, slots, n);
+    EXPECT_EQ(n, ops.count());
+    EXPECT_FALSE(ops.empty());
+
+    std::size_t i = 0;
+    ops.for_each(start, ops.size(),
+                 [&](double m, unsigned s)
+                 {
+                     EXPECT_TRUE(sameBits(muls[i], m)) << i;
+                     EXPECT_EQ(slots[i], s) << i;
+                     ++i;
+                 });
+    EXPECT_EQ(n, i);
+    EXPECT_EQ(n, ops.numOperations(start, ops.size()));
+}
+
+TEST(CompressedTape, operationsAreSmallerThanPairs)
+{
+    // a typical statement: two operands with nearby slots and a general multiplier,
+    // and a sum of two operands
+    xad::CompressedOperations<double, unsigned> ops;
+    for (unsigned i = 100; i < 10100; ++i)
+    {
+        double m[] = {std::sin(double(i)), 1.0};
+        unsigned s[] = {i - 1, i - 3};
+        ops.append_n(m, s, 2);
+        double a[] = {1.0, -1.0};
+        ops.append_n(a, s, 2);
+    }
+    EXPECT_EQ(40000u, ops.count());
+    EXPECT_LT(ops.memory() * 2, ops.count() * (sizeof(double) + sizeof(unsigned)));
+}
+
+TEST(CompressedTape, operationsSplitLongStatements)
+{
+    std::vector<double> m(600);
+    std::vector<unsigned> s(600);
+    for (unsigned i = 0; i < 600; ++i)
+    {
+        m[i] = double(i) + 0.25;
+        s[i] = 600 - i;
+    }
+    small_operations ops;
+    ops.append_n(m.begin(), s.begin(), 600);
+    unsigned i = 0;
+    ops.for_each(std::size_t(1), ops.size(),
+                 [&](double mul, unsigned slot)
+                 {
+                     EXPECT_EQ(double(i) + 0.25, mul);
+                     EXPECT_EQ(600 - i, slot);
+                     ++i;
+                 });
+    EXPECT_EQ(600u, i);
+}
+
+TEST(CompressedTape, operationsCrossChunks)
+{
+    small_operations ops;
+    std::vector<std::size_t> ends = {ops.size()};
+    for (unsigned k = 0; k < 2000; ++k)
+    {
+        std::vector<double> m(k % 9, double(k) / 3.0);
+        std::vector<unsigned> s(k % 9, k);
+        ops.append_n(m.begin(), s.begin(), m.size());
+        ends.push_back(ops.size());
+    }
+    EXPECT_GT(ops.chunks(), 2u);
+
+    auto check = [&](unsigned last)
+    {
+        for (unsigned k = last; k-- > 0;)
+        {
+            std::size_t n = 0;
+            ops.for_each(ends[k], ends[k + 1],
+                         [&](double m, unsigned s)
+                         {
+                             EXPECT_EQ(double(k) / 3.0, m);
+                             EXPECT_EQ(k, s);
+                             ++n;
+                         });
+            EXPECT_EQ(k % 9, n);
+        }
+    };
+    check(2000);
+    // statements spanning several chunks
+    EXPECT_EQ(ops.count(), ops.numOperations(ends[0], ends[2000]));
+
+    // truncating into an earlier chunk, and recording again
+    const auto count = ops.count();
+    ops.resize(ends[700]);
+    EXPECT_EQ(ends[700], ops.size());
+    EXPECT_EQ(ops.numOperations(ends[0], ends[700]), ops.count());
+    EXPECT_LT(ops.count(), count);
+    for (unsigned k = 700; k < 2000; ++k)
+    {
+        std::vector<double> m(k % 9, double(k) / 3.0);
+        std::vector<unsigned> s(k % 9, k);
+        ops.append_n(m.begin(), s.begin(), m.size());
+        ends[k + 1] = ops.size();
+    }
+    EXPECT_EQ(count, ops.count());
+    check(2000);
+
+    ops.clear();
+    EXPECT_TRUE(ops.empty());
+    EXPECT_EQ(0u, ops.count());
+}
+
+TEST(CompressedTape, statementsRandomAccessAndResize)
+{
+    small_statements st;
+    EXPECT_TRUE(st.empty());
+    std::vector<std::pair<unsigned, unsigned>> ref;
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        // positions grow by varying amounts, slots jump around, with invalid ones
+        unsigned slot = i % 7 == 0 ? std::numeric_limits<unsigned>::max() : (i * 37) % 501;
+        unsigned pos = ref.empty() ? 1 : ref.back().first + (i % 5) * 1000;
+        ref.push_back(std::make_pair(pos, slot));
+        st.emplace_back(pos, slot);
+    }
+    EXPECT_EQ(1000u, st.size());
+    for (std::size_t i : {0, 1, 63, 64, 65, 500, 999}) EXPECT_EQ(ref[i], st[i]) << i;
+
+    st.resize(130);
+    EXPECT_EQ(130u, st.size());
+    EXPECT_EQ(ref[129], st[129]);
+    ref.resize(130);
+    for (unsigned i = 130; i < 400; ++i)
+    {
+        ref.push_back(std::make_pair(ref.back().first + 2, i));
+        st.push_back(ref.back());
+    }
+    for (std::size_t i = 0; i < ref.size(); ++i) EXPECT_EQ(ref[i], st[i]) << i;
+
+    st.clear();
+    EXPECT_TRUE(st.empty());
+    st.emplace_back(3u, 4u);
+    EXPECT_THAT(st[0], Pair(3u, 4u));
+}
+
+TEST(CompressedTape, statementsReverseSweep)
+{
+    small_statements st;
+    std::vector<std::pair<unsigned, unsigned>> ref;
+    for (unsigned i = 0; i < 3000; ++i)
+    {
+        ref.push_back(std::make_pair(i * 3 + (i % 4) * 1000000, (i * 7919) % 1000));
+        st.push_back(ref.back());
+    }
+
+    for (auto range : {std::make_pair(0u, 2999u), std::make_pair(1234u, 2000u),
+                       std::make_pair(0u, 1u), std::make_pair(17u, 17u)})
+    {
+        unsigned k = range.second;
+        st.for_each_reverse(range.first, range.second,
+                            [&](unsigned begin, unsigned end, unsigned slot)
+                            {
+                                EXPECT_EQ(ref[k - 1].first, begin) << k;
+                                EXPECT_EQ(ref[k].first, end) << k;
+                                EXPECT_EQ(ref[k].second, slot) << k;
+                                --k;
+                            });
+        EXPECT_EQ(range.first, k);
+    }
+}
+
+#ifdef XAD_TAPE_COMPRESSED
+TEST(CompressedTape, tapeUsesLessMemory)
+{
+    using AD = xad::AReal<double>;
+    xad::Tape<double> tape;
+    std::vector<AD> x(100, 1.5);
+    tape.registerInputs(x);
+    tape.newRecording();
+    AD y = 0.0;
+    for (int k = 0; k < 100; ++k)
+        for (std::size_t i = 0; i < x.size(); ++i) y = y + x[i] * 2.0 - sin(x[i]);
+    tape.registerOutput(y);
+
+    // three operations per statement, with one of 1.0 and one float multiplier
+    const std::size_t ops = tape.getNumOperations();
+    EXPECT_EQ(30000u - 1u, ops);
+    const std::size_t uncompressed = ops * (sizeof(double) + sizeof(unsigned)) +
+                                     tape.getNumStatements() * 2 * sizeof(unsigned);
+    EXPECT_LT(2 * tape.getMemory(), uncompressed);
+
+    derivative(y) = 1.0;
+    tape.computeAdjoints();
+    for (auto& xi : x) EXPECT_NEAR(100.0 * (2.0 - std::cos(1.5)), derivative(xi), 1e-10);
+
+    EXPECT_THROW(tape.compact(x, x), xad::Exception);
+}
+#endif
@@ -0,0 +1,265 @@
+/*******************************************************************************
+
+   Unit tests for JITBatchInterpreter
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+using AD = xad::AReal<double, 1>;
+
+namespace
+{
+
+// A mix of the operations found in the Libor and Heston COS pricers, with a branch
+AD payoff(std::vector<AD>& x)
+{
+    AD df = 1.0 / (1.0 + 0.25 * x[0]);
+    AD phi = exp(-x[1] * x[2]) * cos(x[3] * x[2]) + sin(x[0]) * erf(x[1]);
+    AD d1 = (log(x[2]) + 0.5 * x[1] * x[1]) / sqrt(x[1]);
+    AD n = 0.5 * erfc(-d1 / std::sqrt(2.0));
+    AD p = pow(x[2], x[3]) + max(x[0], x[3]) + abs(x[3] - x[1]);
+    AD v = df * (phi + n) + p;
+    for (int i = 0; i < 4; ++i) v += tanh(x[i]) * x[(i + 1) % 4];
+    auto cond = xad::less(x[0], 0.5);
+    return cond.If(v * x[1], log1p(v) + x[2]);
+}
+
+struct Recording
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x;
+
+    explicit Recording(std::size_t nInputs) : x(nInputs)
+    {
+        for (std::size_t i = 0; i < nInputs; ++i) x[i] = 0.3 + 0.1 * double(i);
+        jit.registerInputs(x);
+        AD y = payoff(x);
+        jit.registerOutput(y);
+    }
+};
+
+// lane l of input i
+double laneInput(std::size_t i, std::size_t l) { return 0.2 + 0.15 * double(i) + 0.1 * double(l); }
+
+}  // namespace
+
+TEST(JITBatchInterpreter, lanesMatchScalarInterpreterBitwise)
+{
+    Recording rec(4);
+    const xad::JITGraph& graph = rec.jit.getGraph();
+    const std::size_t w = 5;
+
+    xad::JITBatchInterpreter<double> batch(w);
+    batch.compile(graph);
+    EXPECT_EQ(w, batch.vectorWidth());
+    EXPECT_EQ(4u, batch.numInputs());
+    EXPECT_EQ(1u, batch.numOutputs());
+
+    std::vector<double> lanes(w);
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        for (std::size_t l = 0; l < w; ++l) lanes[l] = laneInput(i, l);
+        batch.setInput(i, lanes.data());
+    }
+    std::vector<double> out(w), grad(4 * w);
+    batch.forwardAndBackward(out.data(), grad.data());
+
+    xad::JITGraphInterpreter<double> scalar;
+    scalar.compile(graph);
+    for (std::size_t l = 0; l < w; ++l)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            double v = laneInput(i, l);
+            scalar.setInput(i, &v);
+        }
+        double sOut;
+        double sGrad[4];
+        scalar.forwardAndBackward(&sOut, sGrad);
+        EXPECT_EQ(sOut, out[l]) << "lane " << l;
+        for (std::size_t i = 0; i < 4; ++i) EXPECT_EQ(sGrad[i], grad[i * w + l]) << "lane " << l;
+    }
+}
+
+TEST(JITBatchInterpreter, fastTierMatchesScalarInterpreter)
+{
+    Recording rec(4);
+    xad::fuseJITReductions(rec.jit.getGraph());
+    xad::fuseJITCompoundOps(rec.jit.getGraph());
+    const xad::JITGraph& graph = rec.jit.getGraph();
+    const std::size_t w = 8;
+
+    xad::JITBatchInterpreter<double> batch(w, xad::JITMathAccuracy::Fast);
+    EXPECT_EQ(xad::JITMathAccuracy::Fast, batch.accuracy());
+    batch.compile(graph);
+    std::vector<double> lanes(w);
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        for (std::size_t l = 0; l < w; ++l) lanes[l] = laneInput(i, l);
+        batch.setInput(i, lanes.data());
+    }
+    std::vector<double> out(w), grad(4 * w);
+    batch.forwardAndBackward(out.data(), grad.data());
+
+    xad::JITGraphInterpreter<double> scalar;
+    scalar.compile(graph);
+    for (std::size_t l = 0; l < w; ++l)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            double v = laneInput(i, l);
+            scalar.setInput(i, &v);
+        }
+        double sOut;
+        double sGrad[4];
+        scalar.forwardAndBackward(&sOut, sGrad);
+        EXPECT_NEAR(sOut, out[l], 1e-13 * std::fabs(sOut)) << "lane " << l;
+        for (std::size_t i = 0; i < 4; ++i)
+            EXPECT_NEAR(sGrad[i], grad[i * w + l], 1e-12 * (1.0 + std::fabs(sGrad[i])))
+                << "lane " << l;
+    }
+}
+
+TEST(JITBatchInterpreter, untakenBranchDoesNotPolluteGradients)
+{
+    // log(x) is NaN for the lanes where x < 0, but that branch is not taken there
+    xad::JITCompiler<double> jit;
+    AD x = 1.0, y = 2.0;
+    jit.registerInput(x);
+    jit.registerInput(y);
+    AD r = xad::greater(x, 0.0).If(log(x) * y, x * y);
+    jit.registerOutput(r);
+
+    xad::JITBatchInterpreter<double> batch(4);
+    batch.compile(jit.getGraph());
+    double xs[4] = {1.0, -1.0, 2.0, -3.0};
+    double ys[4] = {2.0, 2.0, 3.0, 4.0};
+    batch.setInput(0, xs);
+    batch.setInput(1, ys);
+    double out[4], grad[8];
+    batch.forwardAndBackward(out, grad);
+
+    for (std::size_t l = 0; l < 4; ++l)
+    {
+        if (xs[l] > 0.0)
+        {
+            EXPECT_DOUBLE_EQ(std::log(xs[l]) * ys[l], out[l]);
+            EXPECT_DOUBLE_EQ(ys[l] / xs[l], grad[l]);
+            EXPECT_DOUBLE_EQ(std::log(xs[l]), grad[4 + l]);
+        }
+        else
+        {
+            EXPECT_DOUBLE_EQ(xs[l] * ys[l], out[l]);
+            EXPECT_DOUBLE_EQ(ys[l], grad[l]);
+            EXPECT_DOUBLE_EQ(xs[l], grad[4 + l]);
+        }
+    }
+}
+
+TEST(JITBatchInterpreter, skipsBranchNoLaneTakes)
+{
+    // the false branch holds a node the interpreter cannot evaluate
+    xad::JITGraph graph;
+    uint32_t inp = graph.addInput();
+    uint32_t t = graph.addUnary(xad::JITOpCode::Exp, inp);
+    uint32_t bad = graph.addUnary(static_cast<xad::JITOpCode>(999), inp);
+    uint32_t f = graph.addBinary(xad::JITOpCode::Mul, bad, inp);
+    uint32_t cond = graph.addBinary(xad::JITOpCode::CmpLT, inp, graph.addConstant(1.0));
+    graph.markOutput(graph.addTernary(xad::JITOpCode::If, cond, t, f));
+
+    xad::JITBatchInterpreter<double> batch(4);
+    batch.compile(graph);
+    double xs[4] = {0.5, -1.0, 0.0, 0.25};
+    batch.setInput(0, xs);
+    double out[4], grad[4];
+    batch.forwardAndBackward(out, grad);
+    for (std::size_t l = 0; l < 4; ++l)
+    {
+        EXPECT_DOUBLE_EQ(std::exp(xs[l]), out[l]);
+        EXPECT_DOUBLE_EQ(std::exp(xs[l]), grad[l]);
+    }
+
+    // one lane taking the false branch forces its evaluation
+    xs[2] = 3.0;
+    batch.setInput(0, xs);
+    EXPECT_THROW(batch.forward(out), std::runtime_error);
+}
+
+TEST(JITBatchInterpreter, worksAsCompilerBackend)
+{
+    std::unique_ptr<xad::JITBackend<double>> backend(new xad::JITBatchInterpreter<double>(4));
+    xad::JITCompiler<double> jit(std::move(backend));
+    AD x = 3.0, y = 0.5;
+    jit.registerInput(x);
+    jit.registerInput(y);
+    AD z = x * exp(y);
+    jit.registerOutput(z);
+    jit.compile();
+
+    // registered input values are broadcast to all lanes
+    double out[4];
+    jit.forward(out);
+    for (double o : out) EXPECT_DOUBLE_EQ(3.0 * std::exp(0.5), o);
+
+    derivative(z) = 1.0;
+    jit.computeAdjoints();
+    EXPECT_DOUBLE_EQ(std::exp(0.5), derivative(x));
+    EXPECT_DOUBLE_EQ(3.0 * std::exp(0.5), derivative(y));
+}
+
+TEST(JITBatchInterpreter, singlePrecision)
+{
+    using ADf = xad::AReal<float, 1>;
+    xad::JITCompiler<float> jit;
+    ADf x = 0.5f;
+    jit.registerInput(x);
+    ADf y = erfc(x) * sin(x) + sqrt(x);
+    jit.registerOutput(y);
+
+    xad::JITBatchInterpreter<float> batch(3, xad::JITMathAccuracy::Fast);
+    batch.compile(jit.getGraph());
+    float xs[3] = {0.25f, 0.5f, 1.5f};
+    batch.setInput(0, xs);
+    float out[3], grad[3];
+    batch.forwardAndBackward(out, grad);
+    for (std::size_t l = 0; l < 3; ++l)
+    {
+        float v = xs[l];
+        EXPECT_NEAR(std::erfc(v) * std::sin(v) + std::sqrt(v), out[l], 1e-6f);
+        float d = -1.1283791670955126f * std::exp(-v * v) * std::sin(v) +
+                  std::erfc(v) * std::cos(v) + 0.5f / std::sqrt(v);
+        EXPECT_NEAR(d, grad[l], 1e-5f);
+    }
+}
+
+TEST(JITBatchInterpreter, rejectsZeroWidth)
+{
+    EXPECT_THROW(xad::JITBatchInterpreter<double>(0), std::invalid_argument);
+}
+
+#endif
@@ -524,7 +524,7 @@ TEST(JITAReal, constantExpressionDoesNotRecordWhenNoTapeAndJitActive)
 
 TEST(JITAReal, vectorModeDoesNotUseJitFallback)
 {
-    // JIT is intentionally scalar-only; vector AD should not attempt JIT fallback.
+    // A scalar JIT is not used by vector AD types - they need a JITCompiler<double, 2>.
     xad::JITCompiler<double, 1> jit;
 
     using ADV = xad::AReal<double, 2>;
@@ -0,0 +1,246 @@
+/*******************************************************************************
+
+   Unit tests for JIT recording and replay of complex functions
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/Complex.hpp>
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+using AD = xad::AReal<double, 1>;
+using CAD = std::complex<AD>;
+
+namespace
+{
+
+std::size_t countOps(const xad::JITGraph& graph, xad::JITOpCode op)
+{
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < graph.nodeCount(); ++i)
+        if (static_cast<xad::JITOpCode>(graph.nodes[i].op) == op)
+            ++n;
+    return n;
+}
+
+// Heston characteristic function of the log-spot at u, in the formulation of
+// Albrecher et al. (2007); p = {kappa, theta, sigma, rho, v0}
+template <class T>
+std::complex<T> hestonCF(const std::vector<T>& p, double u, double tau)
+{
+    typedef std::complex<T> C;
+    const T& kappa = p[0];
+    const T& theta = p[1];
+    const T& sigma = p[2];
+    const T& rho = p[3];
+    const T& v0 = p[4];
+    C iu(0.0, u);
+    C beta = C(kappa) - C(rho * sigma) * iu;
+    C d = sqrt(beta * beta + C(sigma * sigma) * (iu + C(u * u)));
+    C g = (beta - d) / (beta + d);
+    C e = exp(-d * C(tau));
+    C one(1.0);
+    C D = (beta - d) / C(sigma * sigma) * (one - e) / (one - g * e);
+    C A = C(kappa * theta / (sigma * sigma)) *
+          ((beta - d) * C(tau) - C(2.0) * log((one - g * e) / (one - g)));
+    return exp(A + D * C(v0));
+}
+
+}  // namespace
+
+TEST(JITComplex, kernelsMatchStdComplex)
+{
+    const double pts[][2] = {{0.3, 0.7}, {-1.2, 0.4}, {2.0, -3.0}, {-0.5, -0.1}};
+    for (const auto& pt : pts)
+    {
+        std::complex<double> z(pt[0], pt[1]);
+        std::complex<double> refs[3] = {std::exp(z), std::log(z), std::sqrt(z)};
+        xad::JITOpCode ops[3] = {xad::JITOpCode::CExp, xad::JITOpCode::CLog,
+                                 xad::JITOpCode::CSqrt};
+        for (int k = 0; k < 3; ++k)
+        {
+            EXPECT_NEAR(refs[k].real(), xad::jitComplexEvaluate(ops[k], pt[0], pt[1], 0.0),
+                        1e-15 * std::abs(refs[k]));
+            EXPECT_NEAR(refs[k].imag(), xad::jitComplexEvaluate(ops[k], pt[0], pt[1], 1.0),
+                        1e-15 * std::abs(refs[k]));
+
+            // derivative against a central difference along the real axis
+            const double h = 1e-6;
+            std::complex<double> fd;
+            if (k == 0)
+                fd = (std::exp(z + h) - std::exp(z - h)) / (2 * h);
+            else if (k == 1)
+                fd = (std::log(z + h) - std::log(z - h)) / (2 * h);
+            else
+                fd = (std::sqrt(z + h) - std::sqrt(z - h)) / (2 * h);
+            double p, q;
+            xad::jitComplexDerivative(ops[k], pt[0], pt[1], p, q);
+            EXPECT_NEAR(fd.real(), p, 1e-8 * (1.0 + std::abs(fd)));
+            EXPECT_NEAR(fd.imag(), q, 1e-8 * (1.0 + std::abs(fd)));
+        }
+    }
+}
+
+TEST(JITComplex, recordsDedicatedNodes)
+{
+    xad::JITCompiler<double> jit;
+    AD a = 0.3, b = 0.7, c = 1.1, d = -0.4;
+    jit.registerInput(a);
+    jit.registerInput(b);
+    jit.registerInput(c);
+    jit.registerInput(d);
+    CAD z(a, b), w(c, d);
+
+    std::size_t n0 = jit.getGraph().nodeCount();
+    CAD e = exp(z);
+    EXPECT_EQ(n0 + 2, jit.getGraph().nodeCount());
+    CAD l = log(z);
+    EXPECT_EQ(n0 + 4, jit.getGraph().nodeCount());
+    CAD s = sqrt(z);
+    EXPECT_EQ(n0 + 6, jit.getGraph().nodeCount());
+    CAD p = pow(z, w);
+    EXPECT_EQ(2u, countOps(jit.getGraph(), xad::JITOpCode::CExp) - 2);
+    EXPECT_EQ(2u, countOps(jit.getGraph(), xad::JITOpCode::CLog) - 2);
+
+    // recorded values are the ones of the complex functions without JIT
+    std::complex<double> zd(0.3, 0.7), wd(1.1, -0.4);
+    EXPECT_NEAR(std::exp(zd).real(), value(e.real()), 1e-15);
+    EXPECT_NEAR(std::log(zd).imag(), value(l.imag()), 1e-15);
+    EXPECT_NEAR(std::sqrt(zd).real(), value(s.real()), 1e-15);
+    EXPECT_NEAR(std::pow(zd, wd).imag(), value(p.imag()), 1e-14);
+}
+
+TEST(JITComplex, passiveAndSpecialValuesUseGenericImplementation)
+{
+    xad::JITCompiler<double> jit;
+    AD a = 0.3;
+    jit.registerInput(a);
+    std::size_t n0 = jit.getGraph().nodeCount();
+
+    // constant arguments are not recorded
+    CAD k(AD(0.5), AD(0.25));
+    CAD ek = exp(k);
+    EXPECT_EQ(n0, jit.getGraph().nodeCount());
+    EXPECT_NEAR(std::exp(std::complex<double>(0.5, 0.25)).imag(), value(ek.imag()), 1e-15);
+
+    // infinite parts keep the special value handling
+    CAD inf(a, AD(std::numeric_limits<double>::infinity()));
+    CAD s = sqrt(inf);
+    EXPECT_EQ(0u, countOps(jit.getGraph(), xad::JITOpCode::CSqrt));
+    EXPECT_TRUE(std::isinf(value(s.real())));
+}
+
+TEST(JITComplex, hestonReplayMatchesTape)
+{
+    const double tau = 1.5;
+    const std::vector<double> u = {0.5, 2.0, 7.5};
+    std::vector<double> p0 = {1.5, 0.04, 0.3, -0.7, 0.05};
+
+    xad::JITCompiler<double> jit;
+    std::vector<AD> p(p0.begin(), p0.end());
+    jit.registerInputs(p);
+    std::vector<AD> outs;
+    for (double uk : u)
+    {
+        std::complex<AD> phi = hestonCF(p, uk, tau);
+        outs.push_back(phi.real());
+        outs.push_back(phi.imag());
+    }
+    jit.registerOutputs(outs);
+    EXPECT_EQ(3u * 2u, countOps(jit.getGraph(), xad::JITOpCode::CSqrt));
+    xad::fuseJITCompoundOps(jit.getGraph());
+    jit.compile();
+
+    // replay at other parameters
+    std::vector<double> p1 = {2.1, 0.06, 0.5, -0.4, 0.03};
+    for (std::size_t i = 0; i < p.size(); ++i) value(p[i]) = p1[i];
+    std::vector<double> jitOut(outs.size());
+    jit.forward(jitOut.data());
+    jit.computeAdjoints();  // all outputs seeded with 1
+    std::vector<double> jitGrad(p.size());
+    for (std::size_t i = 0; i < p.size(); ++i) jitGrad[i] = derivative(p[i]);
+    jit.deactivate();
+
+    xad::Tape<double> tape;
+    std::vector<AD> tp(p1.begin(), p1.end());
+    tape.registerInputs(tp);
+    tape.newRecording();
+    std::vector<AD> touts;
+    for (double uk : u)
+    {
+        std::complex<AD> phi = hestonCF(tp, uk, tau);
+        touts.push_back(phi.real());
+        touts.push_back(phi.imag());
+    }
+    tape.registerOutputs(touts);
+    for (auto& y : touts) derivative(y) = 1.0;
+    tape.computeAdjoints();
+
+    for (std::size_t o = 0; o < outs.size(); ++o)
+        EXPECT_NEAR(value(touts[o]), jitOut[o], 1e-13) << "output " << o;
+    for (std::size_t i = 0; i < tp.size(); ++i)
+        EXPECT_NEAR(derivative(tp[i]), jitGrad[i], 1e-11 * (1.0 + std::fabs(jitGrad[i])))
+            << "input " << i;
+}
+
+TEST(JITComplex, batchInterpreterMatchesScalar)
+{
+    xad::JITCompiler<double> jit;
+    AD a = 0.3, b = 0.7;
+    jit.registerInput(a);
+    jit.registerInput(b);
+    CAD z(a, b);
+    CAD r = sqrt(log(exp(z) + CAD(1.0)));
+    AD re = r.real(), im = r.imag();
+    jit.registerOutput(re);
+    jit.registerOutput(im);
+
+    const std::size_t w = 4;
+    xad::JITBatchInterpreter<double> batch(w);
+    batch.compile(jit.getGraph());
+    double as[w] = {0.3, -1.0, 2.0, 0.0}, bs[w] = {0.7, 0.2, -3.0, 1.5};
+    batch.setInput(0, as);
+    batch.setInput(1, bs);
+    double out[2 * w], grads[2 * w];
+    batch.forwardAndBackward(out, grads);
+
+    xad::JITGraphInterpreter<double> scalar;
+    scalar.compile(jit.getGraph());
+    for (std::size_t l = 0; l < w; ++l)
+    {
+        double in[2] = {as[l], bs[l]}, sOut[2], sGrad[2];
+        scalar.setInputs(in);
+        scalar.forwardAndBackward(sOut, sGrad);
+        std::complex<double> ref = std::sqrt(std::log(std::exp(std::complex<double>(as[l], bs[l])) + 1.0));
+        EXPECT_NEAR(ref.real(), out[l], 1e-14);
+        EXPECT_NEAR(ref.imag(), out[w + l], 1e-14);
+        EXPECT_EQ(sOut[0], out[l]);
+        EXPECT_EQ(sGrad[0], grads[l]);
+        EXPECT_EQ(sGrad[1], grads[w + l]);
+    }
+}
+
+#endif
@@ -0,0 +1,215 @@
+/*******************************************************************************
+
+   Tests for compiled JIT kernels used as external functions on a tape.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+namespace
+{
+
+// the kernel: two outputs of three inputs
+template <class T>
+void kernel(const std::vector<T>& x, std::vector<T>& y)
+{
+    y.resize(2);
+    y[0] = x[0] * exp(x[1]) + sin(x[2]) * x[0];
+    y[1] = xad::less(x[1], 0.0).If(x[1] * x[2], log(x[1]) * x[2]);
+}
+
+// the outer model, calling the kernel twice
+template <class T, class Kernel>
+T model(const std::vector<T>& p, Kernel k)
+{
+    std::vector<T> x = {p[0] * p[0], p[0] + p[1], p[2]}, y;
+    k(x, y);
+    std::vector<T> x2 = {y[1], y[0], p[1] - p[2]}, y2;
+    k(x2, y2);
+    return y[0] * y2[1] + y2[0];
+}
+
+struct Recorded
+{
+    xad::JITCompiler<double> jit;
+
+    Recorded()
+    {
+        using JAD = xad::AReal<double, 1>;
+        std::vector<JAD> x = {1.0, 1.0, 1.0}, y;
+        jit.registerInputs(x);
+        kernel(x, y);
+        jit.registerOutputs(y);
+        jit.compile();
+        jit.deactivate();
+    }
+};
+
+}  // namespace
+
+TEST(JITExternalFunction, matchesTapeGradients)
+{
+    using AD = xad::AReal<double, 1>;
+    const std::vector<double> pv = {0.7, 0.4, -0.3};
+
+    std::vector<double> ref(3);
+    double refValue;
+    {
+        xad::Tape<double> tape;
+        std::vector<AD> p(pv.begin(), pv.end());
+        tape.registerInputs(p);
+        tape.newRecording();
+        AD z = model(p, [](const std::vector<AD>& x, std::vector<AD>& y) { kernel(x, y); });
+        tape.registerOutput(z);
+        derivative(z) = 1.0;
+        tape.computeAdjoints();
+        refValue = value(z);
+        for (std::size_t i = 0; i < 3; ++i) ref[i] = derivative(p[i]);
+    }
+
+    Recorded r;
+    xad::JITExternalFunction<double> f(r.jit);
+    EXPECT_EQ(3u, f.numInputs());
+    EXPECT_EQ(2u, f.numOutputs());
+
+    xad::Tape<double> tape;
+    std::vector<AD> p(pv.begin(), pv.end());
+    tape.registerInputs(p);
+    tape.newRecording();
+    AD z = model(p, [&](const std::vector<AD>& x, std::vector<AD>& y) { f.call(x, y); });
+    tape.registerOutput(z);
+    EXPECT_EQ(2u, tape.getNumCallbacks());
+    derivative(z) = 1.0;
+    tape.computeAdjoints();
+
+    EXPECT_NEAR(refValue, value(z), 1e-14);
+    for (std::size_t i = 0; i < 3; ++i) EXPECT_NEAR(ref[i], derivative(p[i]), 1e-12) << i;
+}
+
+TEST(JITExternalFunction, singleOutputUsesAnyBackend)
+{
+    using AD = xad::AReal<double, 1>;
+    xad::JITCompiler<double> jit;
+    {
+        AD a = 1.0, b = 2.0;
+        jit.registerInput(a);
+        jit.registerInput(b);
+        AD c = a * a * b + exp(b);
+        jit.registerOutput(c);
+    }
+    jit.compile();
+    jit.deactivate();
+    xad::JITExternalFunction<double> f(*jit.getBackend());
+
+    xad::Tape<double> tape;
+    AD a = 1.5, b = 0.5;
+    tape.registerInput(a);
+    tape.registerInput(b);
+    tape.newRecording();
+    AD in[2] = {3.0 * a, b};
+    AD out[1];
+    f.call(in, out);
+    AD z = 2.0 * out[0];
+    tape.registerOutput(z);
+    derivative(z) = 1.0;
+    tape.computeAdjoints();
+
+    EXPECT_DOUBLE_EQ(4.5 * 4.5 * 0.5 + std::exp(0.5), value(out[0]));
+    EXPECT_DOUBLE_EQ(2.0 * 3.0 * 2.0 * 4.5 * 0.5, derivative(a));
+    EXPECT_DOUBLE_EQ(2.0 * (4.5 * 4.5 + std::exp(0.5)), derivative(b));
+}
+
+TEST(JITExternalFunction, vectorTape)
+{
+    using AD = xad::AReal<double, 2>;
+    const std::vector<double> pv = {0.7, 0.4, -0.3};
+
+    std::vector<std::array<double, 2>> ref(3);
+    {
+        xad::Tape<double, 2> tape;
+        std::vector<AD> p(pv.begin(), pv.end());
+        tape.registerInputs(p);
+        tape.newRecording();
+        AD z = model(p, [](const std::vector<AD>& x, std::vector<AD>& y) { kernel(x, y); });
+        AD w = z * p[1];
+        tape.registerOutput(z);
+        tape.registerOutput(w);
+        derivative(z)[0] = 1.0;
+        derivative(w)[1] = 1.0;
+        tape.computeAdjoints();
+        for (std::size_t i = 0; i < 3; ++i)
+            for (std::size_t d = 0; d < 2; ++d) ref[i][d] = derivative(p[i])[d];
+    }
+
+    Recorded r;
+    xad::JITExternalFunction<double, 2> f(r.jit);
+    xad::Tape<double, 2> tape;
+    std::vector<AD> p(pv.begin(), pv.end());
+    tape.registerInputs(p);
+    tape.newRecording();
+    AD z = model(p, [&](const std::vector<AD>& x, std::vector<AD>& y) { f.call(x, y); });
+    AD w = z * p[1];
+    tape.registerOutput(z);
+    tape.registerOutput(w);
+    derivative(z)[0] = 1.0;
+    derivative(w)[1] = 1.0;
+    tape.computeAdjoints();
+
+    for (std::size_t i = 0; i < 3; ++i)
+        for (std::size_t d = 0; d < 2; ++d)
+            EXPECT_NEAR(ref[i][d], derivative(p[i])[d], 1e-12) << i << " " << d;
+}
+
+TEST(JITExternalFunction, passiveCallsAreNotRecorded)
+{
+    using AD = xad::AReal<double, 1>;
+    Recorded r;
+    xad::JITExternalFunction<double> f(r.jit);
+
+    std::vector<AD> x = {2.0, 0.5, 1.0}, y;
+    f.call(x, y);  // no active tape
+    EXPECT_DOUBLE_EQ(2.0 * std::exp(0.5) + std::sin(1.0) * 2.0, value(y[0]));
+    EXPECT_DOUBLE_EQ(std::log(0.5) * 1.0, value(y[1]));
+
+    xad::Tape<double> tape;
+    f.call(x, y);  // inputs not on the tape
+    EXPECT_EQ(0u, tape.getNumCallbacks());
+    EXPECT_FALSE(y[0].shouldRecord());
+
+    std::vector<AD> wrong(2);
+    EXPECT_THROW(f.call(wrong, y), std::invalid_argument);
+}
+
+TEST(JITExternalFunction, rejectsBatchBackends)
+{
+    xad::JITBatchInterpreter<double> batch(4);
+    EXPECT_THROW(xad::JITExternalFunction<double> f(batch), std::invalid_argument);
+}
+
+#endif  // XAD_ENABLE_JIT
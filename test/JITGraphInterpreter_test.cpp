@@ -764,6 +764,86 @@ TEST(JITGraphInterpreter, ifOpCodeAdjointFalseBranch)
     EXPECT_DOUBLE_EQ(3.0, inputAdjoint);  // d(3x)/dx = 3
 }
 
+TEST(JITGraphInterpreter, ifSkipsUntakenBranch)
+{
+    // the false branch holds a node the interpreter cannot evaluate
+    xad::JITGraph graph;
+    uint32_t inp = graph.addInput();
+    uint32_t t = graph.addUnary(xad::JITOpCode::Exp, inp);
+    uint32_t bad = graph.addUnary(static_cast<xad::JITOpCode>(999), inp);
+    uint32_t f = graph.addBinary(xad::JITOpCode::Mul, bad, inp);
+    uint32_t cond = graph.addBinary(xad::JITOpCode::CmpLT, inp, graph.addConstant(1.0));
+    uint32_t result = graph.addTernary(xad::JITOpCode::If, cond, t, f);
+    graph.markOutput(result);
+
+    xad::JITGraphInterpreter<double> interp;
+    interp.compile(graph);
+
+    double input = 0.5;
+    interp.setInput(0, &input);
+    double output;
+    double inputAdjoint;
+    interp.forwardAndBackward(&output, &inputAdjoint);
+    EXPECT_DOUBLE_EQ(std::exp(0.5), output);
+    EXPECT_DOUBLE_EQ(std::exp(0.5), inputAdjoint);
+
+    input = 2.0;
+    interp.setInput(0, &input);
+    EXPECT_THROW(interp.forward(&output), std::runtime_error);
+}
+
+TEST(JITGraphInterpreter, nestedIfMatchesPlainEvaluation)
+{
+    using AD = xad::AReal<double, 1>;
+    auto f = [](const AD& x, const AD& y) {
+        AD inner = xad::less(y, 0.0).If(exp(y) * x, sqrt(y) + x * x);
+        AD outer = xad::greater(x, 1.0).If(inner * y, log(x + 2.0) * y);
+        return outer;
+    };
+
+    xad::JITCompiler<double> jit;
+    AD x = 2.0, y = 1.0;
+    jit.registerInput(x);
+    jit.registerInput(y);
+    AD r = f(x, y);
+    jit.registerOutput(r);
+    jit.compile();
+
+    const double points[4][2] = {{2.0, 1.0}, {2.0, -1.0}, {0.5, 1.0}, {0.5, -1.0}};
+    for (const auto& p : points)
+    {
+        double xv = p[0], yv = p[1];
+        jit.setInput(0, &xv);
+        jit.setInput(1, &yv);
+        double output;
+        double grads[2];
+        jit.forwardAndBackward(&output, grads);
+
+        double expected, dx, dy;
+        if (xv > 1.0 && yv < 0.0)
+        {
+            expected = std::exp(yv) * xv * yv;
+            dx = std::exp(yv) * yv;
+            dy = std::exp(yv) * xv * (yv + 1.0);
+        }
+        else if (xv > 1.0)
+        {
+            expected = (std::sqrt(yv) + xv * xv) * yv;
+            dx = 2.0 * xv * yv;
+            dy = 1.5 * std::sqrt(yv) + xv * xv;
+        }
+        else
+        {
+            expected = std::log(xv + 2.0) * yv;
+            dx = yv / (xv + 2.0);
+            dy = std::log(xv + 2.0);
+        }
+        EXPECT_DOUBLE_EQ(expected, output) << xv << ", " << yv;
+        EXPECT_DOUBLE_EQ(dx, grads[0]) << xv << ", " << yv;
+        EXPECT_DOUBLE_EQ(dy, grads[1]) << xv << ", " << yv;
+    }
+}
+
 // =============================================================================
 // Additional OpCode tests for coverage
 // =============================================================================
@@ -0,0 +1,234 @@
+/*******************************************************************************
+
+   Tests for merging JIT graphs into one graph with shared nodes.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+using xad::JITGraph;
+using xad::JITOpCode;
+
+namespace
+{
+
+using AD = xad::AReal<double, 1>;
+
+// Discount factors from two zero rates, shared by all trades
+std::vector<AD> buildCurve(const std::vector<AD>& zeros)
+{
+    std::vector<AD> dfs;
+    for (int t = 1; t <= 4; ++t)
+    {
+        AD r = zeros[0] + (zeros[1] - zeros[0]) * (0.25 * t);
+        dfs.push_back(exp(-r * double(t)));
+    }
+    return dfs;
+}
+
+// A trade priced off the curve, with a trade-specific cap and spot input
+void recordTrade(xad::JITCompiler<double>& jit, int trade)
+{
+    std::vector<AD> x = {0.02, 0.03, 100.0};
+    jit.registerInputs(x);
+    std::vector<AD> dfs = buildCurve(x);
+    AD pv = 0.0;
+    for (int t = 0; t < 4; ++t)
+    {
+        AD s = x[2] * 0.01;
+        AD cf = xad::less(s, 0.9 + 0.1 * trade).If(s, 0.0 * s + 1.0);
+        pv += cf * dfs[std::size_t(t)] * double(trade + 1);
+    }
+    jit.registerOutput(pv);
+    jit.deactivate();
+}
+
+std::vector<double> replay(const JITGraph& g, const std::vector<double>& inputs,
+                           std::vector<double>& gradients)
+{
+    xad::JITGraphInterpreter<double> backend;
+    backend.compile(g);
+    backend.setInputs(inputs.data());
+    std::vector<double> outputs(g.output_ids.size());
+    gradients.assign(g.input_ids.size(), 0.0);
+    backend.forwardAndBackward(outputs.data(), gradients.data());
+    return outputs;
+}
+
+}  // namespace
+
+TEST(JITGraphMerge, sharesInputsAndConcatenatesOutputs)
+{
+    JITGraph g1, g2;
+    {
+        uint32_t x = g1.addInput(), y = g1.addInput();
+        uint32_t e = g1.addUnary(JITOpCode::Exp, x);
+        g1.markOutput(g1.addBinary(JITOpCode::Mul, e, y));
+        g1.markOutput(e);
+    }
+    {
+        uint32_t x = g2.addInput(), y = g2.addInput(), z = g2.addInput();
+        uint32_t e = g2.addUnary(JITOpCode::Exp, x);
+        uint32_t two = g2.addConstant(2.0);
+        g2.markOutput(g2.addTernary(JITOpCode::Fma, e, two, z));
+        g2.addUnary(JITOpCode::Log, y);  // dead
+    }
+
+    xad::JITGraphMerger merger;
+    EXPECT_EQ(0u, merger.add(g1));
+    EXPECT_EQ(2u, merger.add(g2));
+    const JITGraph& m = merger.graph();
+    EXPECT_EQ(3u, m.input_ids.size());
+    EXPECT_EQ(3u, m.output_ids.size());
+    EXPECT_EQ(5u, merger.copiedNodes());
+    EXPECT_EQ(1u, merger.reusedNodes());  // exp(x)
+    EXPECT_EQ(3u + 4u, m.nodeCount());
+    EXPECT_EQ(1u, xad::computeJITGraphStats(m).count(JITOpCode::Exp));
+    EXPECT_EQ(0u, xad::computeJITGraphStats(m).count(JITOpCode::Log));
+
+    const std::vector<double> inputs = {0.3, 1.5, -0.7};
+    std::vector<double> grad, grad1, grad2;
+    std::vector<double> out = replay(m, inputs, grad);
+    std::vector<double> out1 = replay(g1, {inputs[0], inputs[1]}, grad1);
+    std::vector<double> out2 = replay(g2, inputs, grad2);
+    EXPECT_EQ(out1[0], out[0]);
+    EXPECT_EQ(out1[1], out[1]);
+    EXPECT_EQ(out2[0], out[2]);
+    // all outputs are seeded with 1, so the gradients add up
+    EXPECT_DOUBLE_EQ(grad1[0] + grad2[0], grad[0]);
+    EXPECT_DOUBLE_EQ(grad1[1] + grad2[1], grad[1]);
+    EXPECT_DOUBLE_EQ(grad2[2], grad[2]);
+}
+
+TEST(JITGraphMerge, sharesCurveBuildingAcrossTrades)
+{
+    const int numTrades = 5;
+    std::vector<std::unique_ptr<xad::JITCompiler<double>>> jits;
+    std::vector<const JITGraph*> graphs;
+    std::size_t totalNodes = 0;
+    for (int t = 0; t < numTrades; ++t)
+    {
+        jits.emplace_back(new xad::JITCompiler<double>());
+        recordTrade(*jits.back(), t);
+        graphs.push_back(&jits.back()->getGraph());
+        totalNodes += graphs.back()->nodeCount();
+    }
+
+    xad::JITGraphMerger merger;
+    for (const JITGraph* g : graphs) merger.add(*g);
+    const JITGraph& m = merger.graph();
+    EXPECT_EQ(3u, m.input_ids.size());
+    ASSERT_EQ(std::size_t(numTrades), m.output_ids.size());
+    EXPECT_LT(m.nodeCount(), totalNodes / 2);
+    // the discount factors are computed once
+    EXPECT_EQ(4u, xad::computeJITGraphStats(m).count(JITOpCode::Exp));
+
+    // per-trade seeds through the merged kernel match each trade's own replay
+    const std::vector<double> inputs = {0.025, 0.035, 95.0};
+    xad::JITGraphInterpreter<double> merged;
+    merged.compile(m);
+    merged.setInputs(inputs.data());
+    std::vector<double> seeds(numTrades * numTrades, 0.0), out(numTrades),
+        grad(3 * numTrades);
+    for (int t = 0; t < numTrades; ++t) seeds[std::size_t(t * numTrades + t)] = 1.0;
+    merged.forwardAndBackwardSeeded(out.data(), seeds.data(), grad.data(), numTrades);
+
+    for (int t = 0; t < numTrades; ++t)
+    {
+        std::vector<double> tradeGrad;
+        std::vector<double> tradeOut = replay(*graphs[std::size_t(t)], inputs, tradeGrad);
+        EXPECT_EQ(tradeOut[0], out[std::size_t(t)]) << t;
+        for (std::size_t i = 0; i < 3; ++i)
+            EXPECT_NEAR(tradeGrad[i], grad[i * numTrades + std::size_t(t)],
+                        1e-12 * std::abs(tradeGrad[i]))
+                << t << " " << i;
+    }
+}
+
+TEST(JITGraphMerge, sharesConstantsByValueAndReductionsByOperands)
+{
+    JITGraph g1, g2;
+    for (JITGraph* g : {&g1, &g2})
+    {
+        uint32_t ids[3] = {g->addInput(), g->addInput(), g->addInput()};
+        if (g == &g2)
+            g->addConstant(7.0);  // shifts the constant pool of g2
+        uint32_t half = g->addConstant(0.5);
+        uint32_t sum = g->addSum(ids, 3);
+        g->markOutput(g->addBinary(JITOpCode::Mul, sum, half));
+        g->markOutput(g->addDot(ids, ids, g == &g1 ? 3 : 2));
+    }
+
+    xad::JITGraphMerger merger;
+    merger.add(g1);
+    merger.add(g2);
+    const JITGraph& m = merger.graph();
+    // constant, Sum and Mul are shared; the Dots differ in length
+    EXPECT_EQ(3u, merger.reusedNodes());
+    EXPECT_EQ(1u, m.const_pool.size());
+    EXPECT_EQ(m.output_ids[0], m.output_ids[2]);
+    EXPECT_NE(m.output_ids[1], m.output_ids[3]);
+
+    std::vector<double> grad;
+    std::vector<double> out = replay(m, {1.0, 2.0, 4.0}, grad);
+    EXPECT_EQ(3.5, out[0]);
+    EXPECT_EQ(21.0, out[1]);
+    EXPECT_EQ(3.5, out[2]);
+    EXPECT_EQ(5.0, out[3]);
+}
+
+TEST(JITGraphMerge, mergeReturnsTheGraphAndStartsOver)
+{
+    std::vector<std::unique_ptr<xad::JITCompiler<double>>> jits;
+    for (int t = 0; t < 3; ++t)
+    {
+        jits.emplace_back(new xad::JITCompiler<double>());
+        recordTrade(*jits.back(), t);
+    }
+    JITGraph m = xad::mergeJITGraphs({&jits[0]->getGraph(), &jits[1]->getGraph(),
+                                      &jits[2]->getGraph()});
+    EXPECT_EQ(3u, m.output_ids.size());
+
+    // different random draws are distinct nodes, identical ones are shared
+    JITGraph r;
+    uint32_t path = r.addInput();
+    r.markOutput(r.addNode(JITOpCode::RandNormal, path, 0, 0, 1.0));
+    r.markOutput(r.addNode(JITOpCode::RandNormal, path, 0, 0, 2.0));
+    xad::JITGraphMerger merger;
+    merger.add(r);
+    merger.add(r);
+    EXPECT_EQ(2u, merger.reusedNodes());
+    JITGraph released = merger.release();
+    EXPECT_EQ(4u, released.output_ids.size());
+    EXPECT_EQ(3u, released.nodeCount());
+    EXPECT_EQ(0u, merger.graph().nodeCount());
+    EXPECT_EQ(0u, merger.reusedNodes());
+    merger.add(r);
+    EXPECT_EQ(3u, merger.graph().nodeCount());
+}
+
+#endif  // XAD_ENABLE_JIT
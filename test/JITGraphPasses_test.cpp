@@ -0,0 +1,392 @@
+/*******************************************************************************
+
+   Unit tests for the JIT graph passes
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+using AD = xad::AReal<double, 1>;
+
+namespace
+{
+
+using GraphPass = std::function<std::size_t(xad::JITGraph&)>;
+
+std::size_t reductions(xad::JITGraph& g) { return xad::fuseJITReductions(g); }
+std::size_t compoundOps(xad::JITGraph& g) { return xad::fuseJITCompoundOps(g); }
+
+// Records f over inputs x, optionally applies a graph pass, and returns
+// the output value followed by the input gradients.
+template <class F>
+std::vector<double> runJIT(const std::vector<double>& x, F f, GraphPass pass = nullptr,
+                           std::size_t* created = nullptr)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> xs(x.begin(), x.end());
+    jit.registerInputs(xs);
+    AD y = f(xs);
+    jit.registerOutput(y);
+    std::size_t n = 0;
+    if (pass)
+        n = pass(jit.getGraph());
+    if (created)
+        *created = n;
+    jit.compile();
+    for (std::size_t i = 0; i < x.size(); ++i) jit.setInput(i, &x[i]);
+
+    std::vector<double> result(1 + x.size());
+    jit.forwardAndBackward(result.data(), result.data() + 1);
+    return result;
+}
+
+void setInputs(xad::JITCompiler<double>& jit, const std::vector<AD>& x)
+{
+    for (std::size_t i = 0; i < x.size(); ++i)
+    {
+        double v = x[i].getValue();
+        jit.setInput(i, &v);
+    }
+}
+
+int countOps(const xad::JITGraph& g, xad::JITOpCode op)
+{
+    int count = 0;
+    std::vector<char> live = xad::computeJITLiveness(g);
+    for (std::size_t i = 0; i < g.nodeCount(); ++i)
+        if (live[i] && g.getOpCode(static_cast<uint32_t>(i)) == op)
+            ++count;
+    return count;
+}
+
+}  // namespace
+
+TEST(JITGraphPasses, livenessSkipsUnusedNodes)
+{
+    xad::JITGraph g;
+    uint32_t x = g.addInput();
+    uint32_t y = g.addInput();
+    uint32_t unused = g.addUnary(xad::JITOpCode::Sin, x);
+    uint32_t sum = g.addBinary(xad::JITOpCode::Add, x, y);
+    g.markOutput(sum);
+
+    std::vector<char> live = xad::computeJITLiveness(g);
+    EXPECT_TRUE(live[x]);
+    EXPECT_TRUE(live[y]);
+    EXPECT_FALSE(live[unused]);
+    EXPECT_TRUE(live[sum]);
+}
+
+TEST(JITGraphPasses, addChainBecomesSum)
+{
+    auto f = [](std::vector<AD>& x) {
+        AD s = sin(x[0]);
+        for (std::size_t i = 1; i < x.size(); ++i) s += exp(x[i]);
+        return s;
+    };
+    std::vector<double> x = {0.1, 0.2, 0.3, 0.4, 0.5, 0.6};
+    std::size_t created = 0;
+    auto ref = runJIT(x, f);
+    auto fused = runJIT(x, f, reductions, &created);
+
+    EXPECT_EQ(1u, created);
+    ASSERT_EQ(ref.size(), fused.size());
+    for (std::size_t i = 0; i < ref.size(); ++i) EXPECT_NEAR(ref[i], fused[i], 1e-14) << i;
+}
+
+TEST(JITGraphPasses, sumOfProductsBecomesDot)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+    jit.registerInputs(x);
+    AD y = x[0] * x[4] + x[1] * x[5] + x[2] * x[6] + x[3] * x[7];
+    jit.registerOutput(y);
+
+    EXPECT_EQ(1u, xad::fuseJITReductions(jit.getGraph()));
+    EXPECT_EQ(1, countOps(jit.getGraph(), xad::JITOpCode::Dot));
+    EXPECT_EQ(0, countOps(jit.getGraph(), xad::JITOpCode::Mul));
+    EXPECT_EQ(0, countOps(jit.getGraph(), xad::JITOpCode::Add));
+    jit.compile();
+    setInputs(jit, x);
+
+    double out;
+    std::vector<double> grad(8);
+    jit.forwardAndBackward(&out, grad.data());
+    EXPECT_DOUBLE_EQ(5.0 + 12.0 + 21.0 + 32.0, out);
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        EXPECT_DOUBLE_EQ(x[i + 4].getValue(), grad[i]);
+        EXPECT_DOUBLE_EQ(x[i].getValue(), grad[i + 4]);
+    }
+}
+
+TEST(JITGraphPasses, sharedProductKeepsSum)
+{
+    // x0*x1 is used twice, so it cannot be absorbed into a Dot
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.5, 2.0, 3.0, 4.0};
+    jit.registerInputs(x);
+    AD p = x[0] * x[1];
+    AD y = p + x[2] * x[3] + p;
+    jit.registerOutput(y);
+
+    EXPECT_EQ(1u, xad::fuseJITReductions(jit.getGraph()));
+    EXPECT_EQ(1, countOps(jit.getGraph(), xad::JITOpCode::Sum));
+    jit.compile();
+    setInputs(jit, x);
+
+    double out;
+    std::vector<double> grad(4);
+    jit.forwardAndBackward(&out, grad.data());
+    EXPECT_DOUBLE_EQ(2 * 3.0 + 12.0, out);
+    EXPECT_DOUBLE_EQ(2 * 2.0, grad[0]);
+    EXPECT_DOUBLE_EQ(2 * 1.5, grad[1]);
+    EXPECT_DOUBLE_EQ(4.0, grad[2]);
+    EXPECT_DOUBLE_EQ(3.0, grad[3]);
+}
+
+TEST(JITGraphPasses, respectsMinTerms)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.0, 2.0};
+    jit.registerInputs(x);
+    AD y = x[0] + x[1];
+    jit.registerOutput(y);
+
+    EXPECT_EQ(0u, xad::fuseJITReductions(jit.getGraph()));
+    EXPECT_EQ(1, countOps(jit.getGraph(), xad::JITOpCode::Add));
+}
+
+TEST(JITGraphPasses, intermediateOutputIsNotAbsorbed)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.0, 2.0, 3.0, 4.0, 5.0};
+    jit.registerInputs(x);
+    AD partial = x[0] + x[1] + x[2];
+    AD total = partial + x[3] + x[4];
+    jit.registerOutput(partial);
+    jit.registerOutput(total);
+
+    // both chains have three terms: {x0, x1, x2} and {partial, x3, x4}
+    EXPECT_EQ(2u, xad::fuseJITReductions(jit.getGraph()));
+    jit.compile();
+    setInputs(jit, x);
+
+    double out[2];
+    std::vector<double> grad(5);
+    jit.forwardAndBackward(out, grad.data());
+    EXPECT_DOUBLE_EQ(6.0, out[0]);
+    EXPECT_DOUBLE_EQ(15.0, out[1]);
+    EXPECT_DOUBLE_EQ(2.0, grad[0]);
+    EXPECT_DOUBLE_EQ(2.0, grad[2]);
+    EXPECT_DOUBLE_EQ(1.0, grad[3]);
+    EXPECT_DOUBLE_EQ(1.0, grad[4]);
+}
+
+TEST(JITGraphPasses, longAccumulationMatchesUnfused)
+{
+    // discounted cash flow style accumulation, as in Libor/swaption pricers
+    const std::size_t n = 200;
+    std::vector<double> x(2 * n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        x[i] = 0.01 + 0.0001 * double(i);
+        x[n + i] = std::exp(-0.02 * double(i));
+    }
+    auto f = [n](std::vector<AD>& v) {
+        AD pv = 0.0;
+        for (std::size_t i = 0; i < n; ++i) pv += 0.25 * v[i] * v[n + i];
+        return pv;
+    };
+    std::size_t created = 0;
+    auto ref = runJIT(x, f);
+    auto fused = runJIT(x, f, reductions, &created);
+
+    EXPECT_EQ(1u, created);
+    for (std::size_t i = 0; i < ref.size(); ++i) EXPECT_NEAR(ref[i], fused[i], 1e-13) << i;
+}
+
+TEST(JITGraphPasses, sumNodeConstructedDirectly)
+{
+    xad::JITGraph g;
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 37; ++i) ids.push_back(g.addInput());
+    uint32_t s = g.addSum(ids.data(), ids.size());
+    uint32_t d = g.addDot(ids.data(), ids.data(), ids.size());
+    g.markOutput(s);
+    g.markOutput(d);
+
+    int operands = 0;
+    g.forEachOperand(d, [&](uint32_t) { ++operands; });
+    EXPECT_EQ(2 * 37, operands);
+
+    xad::JITGraphInterpreter<double> interp;
+    interp.compile(g);
+    double expectSum = 0.0, expectDot = 0.0;
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        double v = 0.5 + double(i);
+        interp.setInput(i, &v);
+        expectSum += v;
+        expectDot += v * v;
+    }
+    double out[2];
+    std::vector<double> grad(ids.size());
+    interp.forwardAndBackward(out, grad.data());
+    EXPECT_DOUBLE_EQ(expectSum, out[0]);
+    EXPECT_DOUBLE_EQ(expectDot, out[1]);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        EXPECT_DOUBLE_EQ(1.0 + 2.0 * (0.5 + double(i)), grad[i]);
+}
+
+TEST(JITGraphPasses, compoundOpsMatchUnfused)
+{
+    std::vector<double> x = {0.7, -1.3, 2.1};
+    std::vector<std::function<AD(std::vector<AD>&)>> cases = {
+        [](std::vector<AD>& v) { return v[0] * v[1] + v[2]; },
+        [](std::vector<AD>& v) { return v[2] + v[0] * v[1]; },
+        [](std::vector<AD>& v) { return v[0] * v[1] - v[2]; },
+        [](std::vector<AD>& v) { return v[2] - v[0] * v[1]; },
+        [](std::vector<AD>& v) { return v[0] * v[0] * v[1]; },
+        [](std::vector<AD>& v) { return v[2] * (v[0] * v[1]); },
+        [](std::vector<AD>& v) { return 1.0 / (1.0 + v[0]); },
+        [](std::vector<AD>& v) { return v[1] / (v[0] + v[2]); },
+    };
+    for (std::size_t k = 0; k < cases.size(); ++k)
+    {
+        std::size_t created = 0;
+        auto ref = runJIT(x, cases[k]);
+        auto fused = runJIT(x, cases[k], compoundOps, &created);
+        EXPECT_EQ(1u, created) << "case " << k;
+        for (std::size_t i = 0; i < ref.size(); ++i)
+            EXPECT_NEAR(ref[i], fused[i], 1e-14) << "case " << k << ", entry " << i;
+    }
+}
+
+TEST(JITGraphPasses, compoundOpsReduceNodeCount)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {0.5, 1.5, 2.5};
+    jit.registerInputs(x);
+    AD y = x[0] * x[1] + x[2];
+    jit.registerOutput(y);
+
+    EXPECT_EQ(1u, xad::fuseJITCompoundOps(jit.getGraph()));
+    EXPECT_EQ(1, countOps(jit.getGraph(), xad::JITOpCode::Fma));
+    EXPECT_EQ(0, countOps(jit.getGraph(), xad::JITOpCode::Mul));
+    EXPECT_EQ(0, countOps(jit.getGraph(), xad::JITOpCode::Add));
+}
+
+TEST(JITGraphPasses, sharedProductIsNotFused)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {0.5, 1.5, 2.5};
+    jit.registerInputs(x);
+    AD p = x[0] * x[1];
+    AD y = p + x[2];
+    jit.registerOutput(p);
+    jit.registerOutput(y);
+
+    EXPECT_EQ(0u, xad::fuseJITCompoundOps(jit.getGraph()));
+    EXPECT_EQ(1, countOps(jit.getGraph(), xad::JITOpCode::Mul));
+}
+
+TEST(JITGraphPasses, discountFactorLoopMatchesUnfused)
+{
+    // forward-rate discounting as in the Libor pricer: df /= 1 + delta * L_i
+    const std::size_t n = 40;
+    std::vector<double> x(n);
+    for (std::size_t i = 0; i < n; ++i) x[i] = 0.02 + 0.0005 * double(i);
+    auto f = [n](std::vector<AD>& v) {
+        AD df = 1.0, acc = 0.0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            df = df / (1.0 + 0.25 * v[i]);
+            acc = acc + 0.25 * v[i] * df;
+        }
+        return acc;
+    };
+    std::size_t created = 0;
+    auto ref = runJIT(x, f);
+    auto fused = runJIT(x, f, compoundOps, &created);
+
+    EXPECT_LT(0u, created);
+    for (std::size_t i = 0; i < ref.size(); ++i) EXPECT_NEAR(ref[i], fused[i], 1e-13) << i;
+}
+
+TEST(JITGraphPasses, branchGuardsFollowIfOperands)
+{
+    using Op = xad::JITOpCode;
+    xad::JITGraph g;
+    uint32_t x = g.addInput();
+    uint32_t one = g.addConstant(1.0);
+    uint32_t shared = g.addUnary(Op::Sin, x);
+    uint32_t onTrue = g.addBinary(Op::Add, g.addUnary(Op::Exp, x), shared);
+    uint32_t innerCond = g.addBinary(Op::CmpGT, x, one);
+    uint32_t innerTrue = g.addUnary(Op::Log, x);
+    uint32_t inner = g.addTernary(Op::If, innerCond, innerTrue, shared);
+    uint32_t onFalse = g.addBinary(Op::Mul, inner, shared);
+    uint32_t cond = g.addBinary(Op::CmpLT, x, one);  // recorded after the branches
+    uint32_t r = g.addTernary(Op::If, cond, onTrue, onFalse);
+    g.markOutput(r);
+
+    xad::JITBranchAnalysis b = xad::analyzeJITBranches(g);
+    ASSERT_EQ(5u, b.guards.size());
+    EXPECT_EQ(0u, b.nodeGuard[r]);
+    EXPECT_EQ(0u, b.nodeGuard[cond]);
+    EXPECT_EQ(0u, b.nodeGuard[x]);
+    EXPECT_EQ(0u, b.nodeGuard[shared]);
+
+    const xad::JITBranchGuard& t = b.guards[b.nodeGuard[onTrue]];
+    EXPECT_EQ(r, t.ifNode);
+    EXPECT_TRUE(t.side);
+    EXPECT_EQ(0u, t.parent);
+    EXPECT_EQ(b.nodeGuard[onTrue], b.nodeGuard[g.nodes[onTrue].a]);
+
+    const xad::JITBranchGuard& f = b.guards[b.nodeGuard[onFalse]];
+    EXPECT_EQ(r, f.ifNode);
+    EXPECT_FALSE(f.side);
+    EXPECT_EQ(b.nodeGuard[onFalse], b.nodeGuard[inner]);
+    EXPECT_EQ(b.nodeGuard[onFalse], b.nodeGuard[innerCond]);
+
+    const xad::JITBranchGuard& nested = b.guards[b.nodeGuard[innerTrue]];
+    EXPECT_EQ(inner, nested.ifNode);
+    EXPECT_EQ(b.nodeGuard[onFalse], nested.parent);
+    EXPECT_EQ(2u, nested.depth);
+
+    // the schedule is topological and evaluates each condition before its branches
+    std::vector<std::size_t> pos(g.nodeCount(), b.schedule.size());
+    for (std::size_t i = 0; i < b.schedule.size(); ++i) pos[b.schedule[i]] = i;
+    EXPECT_EQ(g.nodeCount(), b.schedule.size());
+    for (uint32_t id : b.schedule)
+        g.forEachOperand(id, [&](uint32_t operand) { EXPECT_LT(pos[operand], pos[id]); });
+    EXPECT_LT(pos[cond], pos[onTrue]);
+    EXPECT_LT(pos[cond], pos[onFalse]);
+    EXPECT_LT(pos[innerCond], pos[innerTrue]);
+}
+
+#endif
@@ -0,0 +1,198 @@
+/*******************************************************************************
+
+   Tests for JIT graph statistics and interpreter profiling.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <string>
+
+#ifdef XAD_ENABLE_JIT
+
+using xad::JITGraph;
+using xad::JITOpCode;
+
+TEST(JITGraphStats, countsOpcodesDepthAndWidth)
+{
+    // w = (x * y + sin(x)) * 2
+    JITGraph g;
+    uint32_t x = g.addInput();
+    uint32_t y = g.addInput();
+    uint32_t xy = g.addBinary(JITOpCode::Mul, x, y);
+    uint32_t s = g.addUnary(JITOpCode::Sin, x);
+    uint32_t z = g.addBinary(JITOpCode::Add, xy, s);
+    uint32_t two = g.addConstant(2.0);
+    uint32_t w = g.addBinary(JITOpCode::Mul, z, two);
+    g.markOutput(w);
+
+    xad::JITGraphStats stats = xad::computeJITGraphStats(g);
+    EXPECT_EQ(7u, stats.nodes);
+    EXPECT_EQ(7u, stats.liveNodes);
+    EXPECT_EQ(2u, stats.inputs);
+    EXPECT_EQ(1u, stats.outputs);
+    EXPECT_EQ(1u, stats.constants);
+    EXPECT_EQ(2u, stats.count(JITOpCode::Input));
+    EXPECT_EQ(2u, stats.count(JITOpCode::Mul));
+    EXPECT_EQ(1u, stats.count(JITOpCode::Sin));
+    EXPECT_EQ(1u, stats.count(JITOpCode::Add));
+    EXPECT_EQ(0u, stats.count(JITOpCode::Div));
+    EXPECT_EQ(stats.liveNodes, std::accumulate(stats.opcodeCounts.begin(),
+                                               stats.opcodeCounts.end(), std::size_t(0)));
+
+    // Mul and Sin at depth 1, Add at depth 2, the final Mul at depth 3
+    EXPECT_EQ(3u, stats.depth);
+    EXPECT_EQ(2u, stats.maxWidth);
+
+    EXPECT_DOUBLE_EQ(1.0 + 20.0 + 1.0 + 1.0, stats.flops);
+    EXPECT_DOUBLE_EQ(2.0 * (2 + 1 + 2 + 2), stats.backwardFlops);
+    const std::size_t v = sizeof(double), nodeBytes = sizeof(xad::JITNode);
+    EXPECT_EQ(3 * v + 4 * nodeBytes + 3 * v + 2 * v + 3 * v + 3 * v, stats.bytesPerReplay);
+    EXPECT_EQ(sizeof(float) * 3 + 4 * nodeBytes + (3 + 2 + 3 + 3) * sizeof(float),
+              xad::computeJITGraphStats(g, sizeof(float)).bytesPerReplay);
+    EXPECT_EQ(g.memory(), stats.memory);
+}
+
+TEST(JITGraphStats, skipsDeadNodes)
+{
+    JITGraph g;
+    uint32_t x = g.addInput();
+    g.addUnary(JITOpCode::Exp, x);  // not used by any output
+    uint32_t y = g.addUnary(JITOpCode::Neg, x);
+    g.markOutput(y);
+
+    xad::JITGraphStats stats = xad::computeJITGraphStats(g);
+    EXPECT_EQ(3u, stats.nodes);
+    EXPECT_EQ(2u, stats.liveNodes);
+    EXPECT_EQ(0u, stats.count(JITOpCode::Exp));
+    EXPECT_EQ(1u, stats.depth);
+    EXPECT_DOUBLE_EQ(1.0, stats.flops);
+}
+
+TEST(JITGraphStats, reductionsCountTheirOperands)
+{
+    JITGraph g;
+    uint32_t ids[3] = {g.addInput(), g.addInput(), g.addInput()};
+    uint32_t sum = g.addSum(ids, 3);
+    uint32_t dot = g.addDot(ids, ids, 3);
+    g.markOutput(sum);
+    g.markOutput(dot);
+
+    xad::JITGraphStats stats = xad::computeJITGraphStats(g);
+    EXPECT_DOUBLE_EQ(2.0 + 5.0, stats.flops);
+    EXPECT_EQ(1u, stats.depth);
+    EXPECT_EQ(2u, stats.maxWidth);
+    const std::size_t v = sizeof(double), nodeBytes = sizeof(xad::JITNode);
+    EXPECT_EQ(5 * v + (nodeBytes + 4 * v + 3 * 4) + (nodeBytes + 7 * v + 6 * 4),
+              stats.bytesPerReplay);
+    EXPECT_EQ(5 * nodeBytes + 9 * sizeof(uint32_t) + 2 * sizeof(uint32_t) + 3 * sizeof(uint32_t),
+              g.memory());
+}
+
+TEST(JITGraphStats, opcodeNames)
+{
+    EXPECT_STREQ("Input", xad::jitOpCodeName(JITOpCode::Input));
+    EXPECT_STREQ("Fma", xad::jitOpCodeName(JITOpCode::Fma));
+    EXPECT_STREQ("RandNormal", xad::jitOpCodeName(JITOpCode::RandNormal));
+    EXPECT_STREQ("CSqrt", xad::jitOpCodeName(JITOpCode::CSqrt));
+    EXPECT_STREQ("Unknown", xad::jitOpCodeName(static_cast<JITOpCode>(xad::jitOpCodeCount)));
+
+    std::set<std::string> names;
+    for (std::size_t i = 0; i < xad::jitOpCodeCount; ++i)
+        names.insert(xad::jitOpCodeName(static_cast<JITOpCode>(i)));
+    EXPECT_EQ(xad::jitOpCodeCount, names.size());
+    EXPECT_EQ(0u, names.count("Unknown"));
+}
+
+TEST(JITGraphStats, compilerReportsGraphMemory)
+{
+    using AD = xad::AReal<double, 1>;
+    xad::JITCompiler<double> jit;
+    AD x = 1.5;
+    jit.registerInput(x);
+    AD y = 3.0 * x + 4.0 * exp(x);
+    jit.registerOutput(y);
+
+    const JITGraph& g = jit.getGraph();
+    EXPECT_GT(g.memory(), g.nodeCount() * sizeof(xad::JITNode));
+    EXPECT_LE(g.memory(), jit.getMemory());
+
+    xad::JITGraphStats stats = jit.getStats();
+    EXPECT_EQ(g.nodeCount(), stats.nodes);
+    EXPECT_EQ(1u, stats.count(JITOpCode::Exp));
+    EXPECT_EQ(1u, stats.inputs);
+    EXPECT_EQ(1u, stats.outputs);
+
+    jit.compile();
+    jit.computeAdjoints();
+    EXPECT_EQ(g.memory() + sizeof(double), jit.getMemory());
+}
+
+TEST(JITGraphStats, interpreterProfilesOpcodes)
+{
+    using AD = xad::AReal<double, 1>;
+    auto* interpreter = new xad::JITGraphInterpreter<double>();
+    xad::JITCompiler<double> jit{std::unique_ptr<xad::JITBackend<double>>(interpreter)};
+    AD x = 0.5, y = 2.0;
+    jit.registerInput(x);
+    jit.registerInput(y);
+    AD z = sin(x) * y + exp(y) * sin(y);
+    jit.registerOutput(z);
+    jit.compile();
+
+    EXPECT_FALSE(interpreter->profiling());
+    jit.computeAdjoints();
+    EXPECT_EQ(0u, interpreter->profile().forwardPasses);
+
+    double out = 0.0;
+    interpreter->setProfiling(true);
+    EXPECT_TRUE(interpreter->profiling());
+    jit.forward(&out);
+    jit.computeAdjoints();
+    const xad::JITProfile& profile = interpreter->profile();
+    EXPECT_EQ(2u, profile.forwardPasses);
+    EXPECT_EQ(1u, profile.backwardPasses);
+    EXPECT_EQ(4u, profile[JITOpCode::Sin].evaluations);
+    EXPECT_EQ(2u, profile[JITOpCode::Sin].propagations);
+    EXPECT_EQ(2u, profile[JITOpCode::Exp].evaluations);
+    EXPECT_EQ(0u, profile[JITOpCode::Div].evaluations);
+    EXPECT_GE(profile[JITOpCode::Sin].forwardSeconds, 0.0);
+    EXPECT_GE(profile.forwardSeconds(), profile[JITOpCode::Exp].forwardSeconds);
+    EXPECT_GE(profile.backwardSeconds(), 0.0);
+
+    // profiling does not change the results
+    EXPECT_DOUBLE_EQ(std::cos(0.5) * 2.0, jit.getDerivative(x.getSlot()));
+    EXPECT_DOUBLE_EQ(std::sin(0.5) + std::exp(2.0) * (std::sin(2.0) + std::cos(2.0)),
+                     jit.getDerivative(y.getSlot()));
+
+    interpreter->setProfiling(false);
+    jit.forward(&out);
+    EXPECT_EQ(2u, interpreter->profile().forwardPasses);
+    interpreter->resetProfile();
+    EXPECT_EQ(0u, interpreter->profile().forwardPasses);
+    EXPECT_EQ(0u, interpreter->profile()[JITOpCode::Sin].evaluations);
+}
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,192 @@
+/*******************************************************************************
+
+   Unit tests for JITMixedPrecisionBackend
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+using AD = xad::AReal<double, 1>;
+
+namespace
+{
+
+struct Recording
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x;
+
+    Recording() : x(3)
+    {
+        x[0] = 1.0;
+        x[1] = 0.2;
+        x[2] = 0.5;
+        jit.registerInputs(x);
+        AD d1 = (log(x[0]) + 0.5 * x[1] * x[1] * x[2]) / (x[1] * sqrt(x[2]));
+        AD price = x[0] * 0.5 * erfc(-d1 / std::sqrt(2.0)) + exp(-x[2]) * sin(x[1]);
+        AD other = x[0] * x[1] + x[2];
+        jit.registerOutput(price);
+        jit.registerOutput(other);
+    }
+};
+
+double laneInput(std::size_t i, std::size_t l)
+{
+    return (i == 0 ? 0.8 : i == 1 ? 0.15 : 0.3) + 0.01 * double(l);
+}
+
+void setLanes(xad::JITBackend<double>& backend, std::size_t w)
+{
+    std::vector<double> values(3 * w);
+    for (std::size_t i = 0; i < 3; ++i)
+        for (std::size_t l = 0; l < w; ++l) values[i * w + l] = laneInput(i, l);
+    backend.setInputs(values.data());
+}
+
+}  // namespace
+
+TEST(JITMixedPrecision, matchesDoubleWithinSinglePrecision)
+{
+    Recording rec;
+    xad::JITMixedPrecisionBackend mixed;
+    mixed.compile(rec.jit.getGraph());
+    const std::size_t w = mixed.vectorWidth();
+    EXPECT_EQ(16u, w);
+    EXPECT_EQ(3u, mixed.numInputs());
+    EXPECT_EQ(2u, mixed.numOutputs());
+
+    setLanes(mixed, w);
+    std::vector<double> out(2 * w), grad(3 * w);
+    mixed.forwardAndBackward(out.data(), grad.data());
+
+    xad::JITGraphInterpreter<double> ref;
+    ref.compile(rec.jit.getGraph());
+    for (std::size_t l = 0; l < w; ++l)
+    {
+        double in[3] = {laneInput(0, l), laneInput(1, l), laneInput(2, l)}, rOut[2], rGrad[3];
+        ref.setInputs(in);
+        ref.forwardAndBackward(rOut, rGrad);
+        for (std::size_t o = 0; o < 2; ++o)
+            EXPECT_NEAR(rOut[o], out[o * w + l], 1e-5 * std::fabs(rOut[o])) << "lane " << l;
+        for (std::size_t i = 0; i < 3; ++i)
+            EXPECT_NEAR(rGrad[i], grad[i * w + l], 1e-4 * (1.0 + std::fabs(rGrad[i])))
+                << "lane " << l;
+    }
+
+    // validation is off by default
+    EXPECT_EQ(0u, mixed.validatedRuns());
+    EXPECT_EQ(0u, mixed.outputErrors()[0].samples);
+}
+
+TEST(JITMixedPrecision, validationSampleCollectsErrorStatistics)
+{
+    Recording rec;
+    const std::size_t w = 4;
+    xad::JITMixedPrecisionBackend mixed(w, 3);
+    EXPECT_EQ(3u, mixed.validationInterval());
+    mixed.compile(rec.jit.getGraph());
+    setLanes(mixed, w);
+
+    std::vector<double> out(2 * w), grad(3 * w);
+    for (int run = 0; run < 7; ++run) mixed.forward(out.data());
+    // runs 0, 3 and 6 are validated
+    EXPECT_EQ(3u, mixed.validatedRuns());
+    ASSERT_EQ(2u, mixed.outputErrors().size());
+    for (const auto& s : mixed.outputErrors())
+    {
+        EXPECT_EQ(3 * w, s.samples);
+        EXPECT_GT(s.maxAbsError, 0.0);
+        EXPECT_LT(s.maxRelError, 1e-6);
+        EXPECT_LE(s.meanAbsError(), s.maxAbsError);
+    }
+    EXPECT_EQ(0u, mixed.gradientErrors()[0].samples);
+
+    mixed.resetStatistics();
+    mixed.setValidationInterval(1);
+    mixed.forwardAndBackward(out.data(), grad.data());
+    EXPECT_EQ(1u, mixed.validatedRuns());
+    EXPECT_EQ(w, mixed.outputErrors()[1].samples);
+    for (const auto& s : mixed.gradientErrors())
+    {
+        EXPECT_EQ(w, s.samples);
+        EXPECT_LT(s.maxRelError, 1e-5);
+    }
+}
+
+TEST(JITMixedPrecision, worksAsCompilerBackend)
+{
+    xad::JITCompiler<double> jit(
+        std::unique_ptr<xad::JITBackend<double>>(new xad::JITMixedPrecisionBackend(8)));
+    AD x = 3.0, y = 0.5;
+    jit.registerInput(x);
+    jit.registerInput(y);
+    AD z = x * exp(y);
+    jit.registerOutput(z);
+    jit.compile();
+
+    jit.computeAdjoints();
+    EXPECT_NEAR(std::exp(0.5), derivative(x), 1e-6);
+    EXPECT_NEAR(3.0 * std::exp(0.5), derivative(y), 1e-6);
+}
+
+TEST(JITMixedPrecision, customBackends)
+{
+    Recording rec;
+    xad::JITMixedPrecisionBackend mixed(
+        std::unique_ptr<xad::JITBackend<float>>(new xad::JITGraphInterpreter<float>()),
+        std::unique_ptr<xad::JITBackend<double>>(new xad::JITGraphInterpreter<double>()), 1);
+    mixed.compile(rec.jit.getGraph());
+    EXPECT_EQ(1u, mixed.vectorWidth());
+    double in[3] = {0.8, 0.15, 0.3}, out[2];
+    mixed.setInputs(in);
+    mixed.forward(out);
+    EXPECT_EQ(1u, mixed.outputErrors()[0].samples);
+    EXPECT_NEAR(0.8 * 0.15 + 0.3, out[1], 1e-6);
+}
+
+TEST(JITMixedPrecision, errors)
+{
+    EXPECT_THROW(xad::JITMixedPrecisionBackend(
+                     std::unique_ptr<xad::JITBackend<float>>(new xad::JITGraphInterpreter<float>()),
+                     std::unique_ptr<xad::JITBackend<double>>(
+                         new xad::JITBatchInterpreter<double>(4)),
+                     1),
+                 std::invalid_argument);
+
+    xad::JITMixedPrecisionBackend mixed(4);
+    double v[4] = {};
+    EXPECT_THROW(mixed.forward(v), std::runtime_error);
+    EXPECT_THROW(mixed.setInput(0, v), std::runtime_error);
+
+    Recording rec;
+    mixed.compile(rec.jit.getGraph());
+    EXPECT_THROW(mixed.setInput(3, v), std::runtime_error);
+    mixed.reset();
+    EXPECT_EQ(0u, mixed.numInputs());
+}
+
+#endif
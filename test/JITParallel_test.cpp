@@ -0,0 +1,173 @@
+/*******************************************************************************
+
+   Tests for recording and compiling JIT graphs on several threads.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+namespace
+{
+
+using AD = xad::AReal<double, 1>;
+
+// A small "trade": a payoff of two market inputs whose shape depends on the index
+AD trade(const std::vector<AD>& x, std::size_t index)
+{
+    const double strike = 0.5 + 0.01 * double(index % 100);
+    AD fwd = x[0] * exp(-0.1 * x[1]);
+    AD payoff = xad::greater(fwd, strike).If(fwd - strike, 0.0 * fwd);
+    for (std::size_t i = 0; i < index % 5; ++i) payoff = payoff + 0.01 * sin(fwd * double(i));
+    return payoff * exp(-x[1]);
+}
+
+void recordTrade(xad::JITCompiler<double>& jit, std::size_t index)
+{
+    std::vector<AD> x = {1.0, 0.05};
+    jit.registerInputs(x);
+    AD y = trade(x, index);
+    jit.registerOutput(y);
+}
+
+void replay(xad::JITBackend<double>& backend, const std::vector<double>& inputs, double& value,
+            std::vector<double>& gradient)
+{
+    gradient.assign(2, 0.0);
+    backend.setInputs(inputs.data());
+    backend.forwardAndBackward(&value, gradient.data());
+}
+
+}  // namespace
+
+TEST(JITParallel, recordsAndCompilesGraphsConcurrently)
+{
+    const std::size_t count = 300;
+    std::vector<xad::JITCompiler<double>> jits =
+        xad::recordJITGraphsParallel<double>(count, recordTrade, 4);
+    ASSERT_EQ(count, jits.size());
+
+    const std::vector<double> inputs = {1.2, 0.03};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        EXPECT_FALSE(jits[i].isActive());
+        EXPECT_EQ(2u, jits[i].numInputs());
+
+        // the same graph recorded on this thread
+        double expected, actual;
+        std::vector<double> expectedGradient, actualGradient;
+        {
+            xad::JITCompiler<double> serial;
+            recordTrade(serial, i);
+            serial.compile();
+            replay(*serial.getBackend(), inputs, expected, expectedGradient);
+        }
+        replay(*jits[i].getBackend(), inputs, actual, actualGradient);
+        EXPECT_EQ(expected, actual) << i;
+        EXPECT_EQ(expectedGradient, actualGradient) << i;
+    }
+}
+
+TEST(JITParallel, callingThreadKeepsItsActiveTapeAndCompiler)
+{
+    {
+        xad::Tape<double> tape;
+        auto jits = xad::recordJITGraphsParallel<double>(8, recordTrade, 2);
+        EXPECT_EQ(&tape, xad::Tape<double>::getActive());
+        EXPECT_EQ(nullptr, xad::JITCompiler<double>::getActive());
+    }
+    {
+        xad::JITCompiler<double> jit;
+        auto jits = xad::recordJITGraphsParallel<double>(8, recordTrade, 2);
+        EXPECT_EQ(&jit, xad::JITCompiler<double>::getActive());
+        EXPECT_EQ(0u, jit.getGraph().nodeCount());
+    }
+}
+
+TEST(JITParallel, eachThreadHasItsOwnActiveCompiler)
+{
+    const std::size_t numThreads = 4;
+    std::vector<double> results(numThreads);
+    std::vector<int> sawOwnCompiler(numThreads, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            xad::JITCompiler<double> jit;
+            sawOwnCompiler[t] = xad::JITCompiler<double>::getActive() == &jit;
+            AD x = 1.0;
+            jit.registerInput(x);
+            AD y = x * double(t + 1);
+            jit.registerOutput(y);
+            jit.compile();
+            double out;
+            jit.forward(&out);
+            results[t] = out;
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    for (std::size_t t = 0; t < numThreads; ++t)
+    {
+        EXPECT_TRUE(sawOwnCompiler[t]) << t;
+        EXPECT_EQ(double(t + 1), results[t]) << t;
+    }
+}
+
+TEST(JITParallel, customBackendsAndSingleThread)
+{
+    auto jits = xad::recordJITGraphsParallel<double>(
+        3,
+        [](xad::JITCompiler<double>& jit, std::size_t i) {
+            jit.setBackend(std::unique_ptr<xad::JITBackend<double>>(
+                new xad::JITGraphInterpreter<double>()));
+            recordTrade(jit, i);
+        },
+        1);
+    ASSERT_EQ(3u, jits.size());
+    double value;
+    std::vector<double> gradient;
+    replay(*jits[2].getBackend(), {1.0, 0.05}, value, gradient);
+    EXPECT_NEAR(value, (1.0 * std::exp(-0.005) - 0.52) * std::exp(-0.05) +
+                           0.01 * std::sin(std::exp(-0.005)) * std::exp(-0.05),
+                1e-14);
+
+    EXPECT_TRUE(xad::recordJITGraphsParallel<double>(0, recordTrade).empty());
+}
+
+TEST(JITParallel, rethrowsTheFirstRecordingError)
+{
+    auto failing = [](xad::JITCompiler<double>& jit, std::size_t i) {
+        if (i == 17)
+            throw std::runtime_error("cannot record trade 17");
+        recordTrade(jit, i);
+    };
+    EXPECT_THROW(xad::recordJITGraphsParallel<double>(100, failing, 4), std::runtime_error);
+    EXPECT_EQ(nullptr, xad::JITCompiler<double>::getActive());
+}
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,219 @@
+/*******************************************************************************
+
+   Unit tests for the JIT random number nodes
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+using AD = xad::AReal<double, 1>;
+
+TEST(JITRandom, philoxKnownAnswers)
+{
+    // test vectors from the Random123 distribution
+    uint32_t ctr[4] = {0u, 0u, 0u, 0u};
+    const uint32_t key[2] = {0u, 0u};
+    xad::jitPhilox4x32(ctr, key);
+    EXPECT_EQ(0x6627e8d5u, ctr[0]);
+    EXPECT_EQ(0xe169c58du, ctr[1]);
+    EXPECT_EQ(0xbc57ac4cu, ctr[2]);
+    EXPECT_EQ(0x9b00dbd8u, ctr[3]);
+
+    uint32_t ctr2[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u};
+    const uint32_t key2[2] = {0xa4093822u, 0x299f31d0u};
+    xad::jitPhilox4x32(ctr2, key2);
+    EXPECT_EQ(0xd16cfe09u, ctr2[0]);
+    EXPECT_EQ(0x94fdccebu, ctr2[1]);
+    EXPECT_EQ(0x5001e420u, ctr2[2]);
+    EXPECT_EQ(0x24126ea1u, ctr2[3]);
+}
+
+TEST(JITRandom, inverseNormalInvertsDistribution)
+{
+    for (int i = 1; i < 1000; ++i)
+    {
+        double p = i / 1000.0;
+        double x = xad::jitInverseNormal(p);
+        EXPECT_NEAR(p, 0.5 * std::erfc(-x / std::sqrt(2.0)), 1e-15) << p;
+    }
+    // deep tails, where erfc amplifies the error of x by about x^2
+    for (double p : {1e-10, 1e-16, 1e-100, 1e-300})
+    {
+        double x = xad::jitInverseNormal(p);
+        EXPECT_NEAR(1.0, 0.5 * std::erfc(-x / std::sqrt(2.0)) / p, 1e-11) << p;
+    }
+    EXPECT_EQ(0.0, xad::jitInverseNormal(0.5));
+}
+
+TEST(JITRandom, drawsAreUniformAndNormal)
+{
+    const int n = 20000;
+    double su = 0.0, sn = 0.0, sn2 = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        double u = xad::jitRandomUniform(uint64_t(i), 3, 7);
+        ASSERT_GT(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        su += u;
+        double z = xad::jitRandomNormal(uint64_t(i), 3, 8);
+        sn += z;
+        sn2 += z * z;
+    }
+    EXPECT_NEAR(0.5, su / n, 0.01);
+    EXPECT_NEAR(0.0, sn / n, 0.03);
+    EXPECT_NEAR(1.0, sn2 / n, 0.03);
+
+    // streams and draws give different numbers for the same path
+    EXPECT_NE(xad::jitRandomUniform(5, 0, 0), xad::jitRandomUniform(5, 1, 0));
+    EXPECT_NE(xad::jitRandomUniform(5, 0, 0), xad::jitRandomUniform(5, 0, 1));
+    EXPECT_NE(xad::jitRandomUniform(5, 0, 0), xad::jitRandomUniform(6, 0, 0));
+    EXPECT_NE(xad::jitRandomUniform(uint64_t(1) << 32, 0, 0), xad::jitRandomUniform(0, 0, 0));
+}
+
+TEST(JITRandom, withoutJITComputesDirectly)
+{
+    AD path = 42.0;
+    AD z = xad::randNormal(path, 1, 2);
+    EXPECT_EQ(xad::jitRandomNormal(42, 1, 2), value(z));
+}
+
+TEST(JITRandom, replayDrawsForEachPath)
+{
+    xad::JITCompiler<double> jit;
+    AD path = 0.0;
+    jit.registerInput(path);
+    std::vector<AD> z;
+    for (uint32_t k = 0; k < 4; ++k) z.push_back(xad::randNormal(path, 9, k));
+    AD u = xad::randUniform(path, 9, 4);
+    jit.registerOutputs(z);
+    jit.registerOutput(u);
+    jit.compile();
+
+    EXPECT_EQ(xad::jitRandomNormal(0, 9, 2), value(z[2]));
+    for (uint64_t p : {uint64_t(3), uint64_t(1000000), uint64_t(123456789012)})
+    {
+        value(path) = double(p);
+        double out[5];
+        jit.forward(out);
+        for (uint32_t k = 0; k < 4; ++k) EXPECT_EQ(xad::jitRandomNormal(p, 9, k), out[k]);
+        EXPECT_EQ(xad::jitRandomUniform(p, 9, 4), out[4]);
+    }
+}
+
+TEST(JITRandom, monteCarloNeedsOnlyThePathIndex)
+{
+    // European call under GBM with a 4-step Euler scheme, sensitivities to spot and vol
+    const double K = 1.0, r = 0.02, T = 1.0;
+    const int steps = 4, paths = 2000;
+    auto payoff = [&](const AD& path, const AD& s0, const AD& vol) {
+        const double dt = T / steps;
+        AD s = s0;
+        for (int i = 0; i < steps; ++i)
+        {
+            AD z = xad::randNormal(path, 0, static_cast<uint32_t>(i));
+            s = s * (1.0 + r * dt + vol * std::sqrt(dt) * z);
+        }
+        return max(s - K, 0.0) * std::exp(-r * T);
+    };
+
+    xad::JITCompiler<double> jit;
+    AD path = 0.0, s0 = 1.0, vol = 0.2;
+    jit.registerInput(path);
+    jit.registerInput(s0);
+    jit.registerInput(vol);
+    AD v = payoff(path, s0, vol);
+    jit.registerOutput(v);
+    jit.compile();
+
+    double price = 0.0, delta = 0.0, vega = 0.0;
+    for (int p = 0; p < paths; ++p)
+    {
+        double pv = double(p);
+        jit.setInput(0, &pv);  // spot and vol stay as uploaded by the first set
+        if (p == 0)
+        {
+            double sv = 1.0, vv = 0.2;
+            jit.setInput(1, &sv);
+            jit.setInput(2, &vv);
+        }
+        double out, grads[3];
+        jit.forwardAndBackward(&out, grads);
+        price += out;
+        delta += grads[1];
+        vega += grads[2];
+        EXPECT_EQ(0.0, grads[0]);
+    }
+    jit.deactivate();
+
+    // the same draws, computed outside the JIT
+    xad::Tape<double> tape;
+    double tprice = 0.0, tdelta = 0.0, tvega = 0.0;
+    for (int p = 0; p < paths; ++p)
+    {
+        tape.clearAll();
+        AD tp = double(p), ts0 = 1.0, tvol = 0.2;
+        tape.registerInput(ts0);
+        tape.registerInput(tvol);
+        tape.newRecording();
+        AD tv = payoff(tp, ts0, tvol);
+        tape.registerOutput(tv);
+        derivative(tv) = 1.0;
+        tape.computeAdjoints();
+        tprice += value(tv);
+        tdelta += derivative(ts0);
+        tvega += derivative(tvol);
+    }
+    EXPECT_NEAR(tprice, price, 1e-12 * paths);
+    EXPECT_NEAR(tdelta, delta, 1e-12 * paths);
+    EXPECT_NEAR(tvega, vega, 1e-12 * paths);
+    // Black-Scholes price is 0.0894, within Monte-Carlo error
+    EXPECT_NEAR(0.0894, price / paths, 0.01);
+}
+
+TEST(JITRandom, batchInterpreterLanesArePaths)
+{
+    xad::JITCompiler<double> jit;
+    AD path = 0.0;
+    jit.registerInput(path);
+    AD z = xad::randNormal(path, 2, 0) * 2.0 + xad::randUniform(path, 2, 1);
+    jit.registerOutput(z);
+
+    xad::JITBatchInterpreter<double> batch(4);
+    batch.compile(jit.getGraph());
+    double paths[4] = {10.0, 11.0, 12.0, 13.0};
+    batch.setInput(0, paths);
+    double out[4];
+    batch.forward(out);
+    for (std::size_t l = 0; l < 4; ++l)
+    {
+        uint64_t p = uint64_t(paths[l]);
+        EXPECT_EQ(xad::jitRandomNormal(p, 2, 0) * 2.0 + xad::jitRandomUniform(p, 2, 1), out[l]);
+    }
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*******************************************************************************
+
+   Tests that replaying a compiled JIT graph does not allocate.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+// the replacements below pair malloc with free, but GCC checks them against the builtins
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Counts the calls to the global allocation function while enabled. All other
+// global operator new variants forward to this one.
+namespace
+{
+std::atomic<bool> countAllocations(false);
+std::atomic<std::size_t> allocations(0);
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using AD = xad::AReal<double, 1>;
+
+namespace
+{
+
+struct Recorded
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x;
+
+    explicit Recorded(std::unique_ptr<xad::JITBackend<double>> backend)
+        : jit(std::move(backend)), x(6)
+    {
+        for (std::size_t i = 0; i < x.size(); ++i) x[i] = 0.5 + 0.1 * double(i);
+        jit.registerInputs(x);
+        AD y = 0.0;
+        for (std::size_t i = 0; i < x.size(); ++i)
+            y += exp(-x[i]) * x[(i + 1) % x.size()] + xad::less(x[i], 0.7).If(x[i], log(x[i]));
+        jit.registerOutput(y);
+        jit.compile();
+    }
+
+    // counts the allocations made by n replays with varying inputs
+    std::size_t replayAllocations(int n)
+    {
+        jit.computeAdjoints();  // warm-up
+        allocations = 0;
+        countAllocations = true;
+        double sum = 0.0;
+        for (int k = 0; k < n; ++k)
+        {
+            for (auto& xi : x) xi.value() += 0.01;
+            jit.computeAdjoints();
+            sum += jit.getDerivative(x[0].getSlot());
+        }
+        countAllocations = false;
+        EXPECT_NE(0.0, sum);
+        return allocations;
+    }
+};
+
+}  // namespace
+
+TEST(JITReplayAllocation, counterSeesAllocations)
+{
+    allocations = 0;
+    countAllocations = true;
+    std::unique_ptr<std::vector<double>> v(new std::vector<double>(10));
+    countAllocations = false;
+    EXPECT_EQ(2u, allocations.load());
+}
+
+TEST(JITReplayAllocation, computeAdjointsWithInterpreter)
+{
+    Recorded r(std::unique_ptr<xad::JITBackend<double>>(new xad::JITGraphInterpreter<double>()));
+    EXPECT_EQ(0u, r.replayAllocations(100));
+}
+
+TEST(JITReplayAllocation, computeAdjointsWithBatchInterpreter)
+{
+    Recorded r(std::unique_ptr<xad::JITBackend<double>>(new xad::JITBatchInterpreter<double>(4)));
+    EXPECT_EQ(0u, r.replayAllocations(100));
+}
+
+TEST(JITReplayAllocation, forward)
+{
+    Recorded r(std::unique_ptr<xad::JITBackend<double>>(new xad::JITGraphInterpreter<double>()));
+    double out = 0.0;
+    r.jit.forward(&out);
+    allocations = 0;
+    countAllocations = true;
+    for (int k = 0; k < 100; ++k) r.jit.forward(&out);
+    countAllocations = false;
+    EXPECT_EQ(0u, allocations.load());
+}
+
+TEST(JITReplayAllocation, derivativesCoverInputsOnly)
+{
+    Recorded r(std::unique_ptr<xad::JITBackend<double>>(new xad::JITGraphInterpreter<double>()));
+    r.jit.computeAdjoints();
+    // one derivative per input slot, not one per recorded node
+    EXPECT_EQ(r.jit.getGraph().memory() + 6 * sizeof(double), r.jit.getMemory());
+    EXPECT_DOUBLE_EQ(-std::exp(-0.5) * 0.6 + 1.0 + std::exp(-1.0),
+                     r.jit.getDerivative(r.x[0].getSlot()));
+}
+
+#endif
@@ -0,0 +1,211 @@
+/*******************************************************************************
+
+   Tests for the memory-bounded segmented replay of the JIT interpreter.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+namespace
+{
+
+using AD = xad::AReal<double, 1>;
+
+// A long recurrence with branches, reductions and uses of the inputs throughout,
+// so that values cross many segment boundaries
+struct LongRecording
+{
+    xad::JITCompiler<double> jit;
+    std::vector<double> inputs;
+
+    explicit LongRecording(int steps = 1500)
+    {
+        std::vector<AD> x(8);
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            x[i] = 0.1 * double(i + 1);
+            inputs.push_back(0.15 * double(i) - 0.4);
+        }
+        jit.registerInputs(x);
+
+        AD s = x[0], acc = 0.0, dot = 0.0;
+        for (int i = 0; i < steps; ++i)
+        {
+            const AD& xi = x[std::size_t(i) % x.size()];
+            s = 0.9 * s + sin(xi) * exp(-0.01 * s);
+            s = xad::less(s, 0.2).If(s + xi * xi, s / (1.0 + xi * xi));
+            acc += s;
+            if (i % 7 == 0)
+                dot += s * x[std::size_t(i / 7) % x.size()];
+        }
+        AD y1 = acc + dot, y2 = s * x[3];
+        jit.registerOutput(y1);
+        jit.registerOutput(y2);
+        jit.deactivate();
+        xad::fuseJITReductions(jit.getGraph());
+    }
+
+    const xad::JITGraph& graph() const { return jit.getGraph(); }
+};
+
+void replay(xad::JITGraphInterpreter<double>& backend, const std::vector<double>& inputs,
+            std::vector<double>& outputs, std::vector<double>& gradients)
+{
+    outputs.assign(backend.numOutputs(), 0.0);
+    gradients.assign(backend.numInputs(), -1.0);
+    backend.setInputs(inputs.data());
+    backend.forwardAndBackward(outputs.data(), gradients.data());
+}
+
+// The stored replay visits the nodes in its branch schedule and the segmented one in
+// recording order, so adjoints are accumulated in a different order
+void expectClose(const std::vector<double>& expected, const std::vector<double>& actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+        EXPECT_NEAR(expected[i], actual[i], 1e-13 * (1.0 + std::abs(expected[i]))) << i;
+}
+
+}  // namespace
+
+TEST(JITSegmentedReplay, matchesStoredReplayWithinBudget)
+{
+    LongRecording r;
+    const xad::JITGraph& g = r.graph();
+    ASSERT_GT(g.nodeCount(), 10000u);
+
+    xad::JITGraphInterpreter<double> stored, segmented;
+    stored.compile(g);
+    const std::size_t budget = 64 * 1024;
+    segmented.setMemoryBudget(budget);
+    segmented.compile(g);
+
+    EXPECT_EQ(1u, stored.numSegments());
+    EXPECT_EQ(2 * g.nodeCount() * sizeof(double), stored.replayMemory());
+    EXPECT_GT(segmented.numSegments(), 1u);
+    EXPECT_LE(segmented.replayMemory(), budget);
+    EXPECT_EQ(budget, segmented.memoryBudget());
+
+    std::vector<double> out1, grad1, out2, grad2;
+    replay(stored, r.inputs, out1, grad1);
+    replay(segmented, r.inputs, out2, grad2);
+    EXPECT_EQ(out1, out2);
+    expectClose(grad1, grad2);
+
+    // replays reuse the segment storage
+    for (double& v : r.inputs) v *= 1.1;
+    replay(stored, r.inputs, out1, grad1);
+    replay(segmented, r.inputs, out2, grad2);
+    expectClose(grad1, grad2);
+
+    std::vector<double> fwd(2);
+    segmented.forward(fwd.data());
+    EXPECT_EQ(out1, fwd);
+}
+
+TEST(JITSegmentedReplay, budgetBelowBoundaryStorageStillReplays)
+{
+    LongRecording r(400);
+    xad::JITGraphInterpreter<double> stored, segmented;
+    stored.compile(r.graph());
+    segmented.setMemoryBudget(1);
+    segmented.compile(r.graph());
+    EXPECT_GT(segmented.numSegments(), 1u);
+    EXPECT_LT(segmented.replayMemory(), stored.replayMemory());
+
+    std::vector<double> out1, grad1, out2, grad2;
+    replay(stored, r.inputs, out1, grad1);
+    replay(segmented, r.inputs, out2, grad2);
+    EXPECT_EQ(out1, out2);
+    expectClose(grad1, grad2);
+}
+
+TEST(JITSegmentedReplay, budgetCanChangeAfterCompile)
+{
+    LongRecording r(400);
+    xad::JITGraphInterpreter<double> backend;
+    backend.compile(r.graph());
+    std::vector<double> out1, grad1, out2, grad2;
+    replay(backend, r.inputs, out1, grad1);
+
+    backend.setMemoryBudget(16 * 1024);
+    EXPECT_GT(backend.numSegments(), 1u);
+    replay(backend, r.inputs, out2, grad2);
+    EXPECT_EQ(out1, out2);
+    expectClose(grad1, grad2);
+
+    // a budget that holds the whole graph disables the segments
+    backend.setMemoryBudget(std::size_t(1) << 30);
+    EXPECT_EQ(1u, backend.numSegments());
+    replay(backend, r.inputs, out2, grad2);
+    expectClose(grad1, grad2);
+}
+
+TEST(JITSegmentedReplay, seededReplayFallsBackToStoredValues)
+{
+    LongRecording r(400);
+    xad::JITGraphInterpreter<double> stored, segmented;
+    stored.compile(r.graph());
+    segmented.setMemoryBudget(16 * 1024);
+    segmented.compile(r.graph());
+
+    const std::vector<double> seeds = {1.0, 0.0, 0.5, 2.0};
+    std::vector<double> out1(2), grad1(16), out2(2), grad2(16);
+    stored.setInputs(r.inputs.data());
+    segmented.setInputs(r.inputs.data());
+    stored.forwardAndBackwardSeeded(out1.data(), seeds.data(), grad1.data(), 2);
+    segmented.forwardAndBackwardSeeded(out2.data(), seeds.data(), grad2.data(), 2);
+    EXPECT_EQ(out1, out2);
+    EXPECT_EQ(grad1, grad2);
+
+    // and the segmented replay still works afterwards
+    std::vector<double> out3, grad3, out4, grad4;
+    replay(stored, r.inputs, out3, grad3);
+    replay(segmented, r.inputs, out4, grad4);
+    expectClose(grad3, grad4);
+}
+
+TEST(JITSegmentedReplay, profilesRecomputation)
+{
+    LongRecording r(400);
+    xad::JITGraphInterpreter<double> backend;
+    backend.setMemoryBudget(16 * 1024);
+    backend.compile(r.graph());
+    const std::size_t sines = xad::computeJITGraphStats(r.graph()).count(xad::JITOpCode::Sin);
+
+    backend.setProfiling(true);
+    std::vector<double> out, grad;
+    replay(backend, r.inputs, out, grad);
+    const xad::JITProfile& profile = backend.profile();
+    EXPECT_EQ(1u, profile.forwardPasses);
+    EXPECT_EQ(1u, profile.backwardPasses);
+    // every segment but the last one is evaluated twice
+    EXPECT_GT(profile[xad::JITOpCode::Sin].evaluations, sines);
+    EXPECT_LT(profile[xad::JITOpCode::Sin].evaluations, 2 * sines);
+    EXPECT_EQ(sines, profile[xad::JITOpCode::Sin].propagations);
+}
+
+#endif  // XAD_ENABLE_JIT
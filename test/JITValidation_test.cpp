@@ -0,0 +1,231 @@
+/*******************************************************************************
+
+   Tests for checking JIT replays against tape recordings and for detecting
+   conditions baked into JIT graphs.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+namespace
+{
+
+using AD = xad::AReal<double, 1>;
+
+// Branches with plain C++ control flow - the branch taken is baked into a JIT graph
+AD plainIf(const AD& x)
+{
+    if (x < 2.0)
+        return 1.0 * x;
+    return 7.0 * x;
+}
+
+// The same function with a recorded condition
+AD recordedIf(const AD& x) { return xad::less(x, 2.0).If(1.0 * x, 7.0 * x); }
+
+void plainModel(const std::vector<AD>& x, std::vector<AD>& y)
+{
+    y.push_back(plainIf(x[0]) * x[1]);
+}
+
+void recordedModel(const std::vector<AD>& x, std::vector<AD>& y)
+{
+    y.push_back(recordedIf(x[0]) * x[1]);
+    y.push_back(sin(x[0]) + exp(x[1]));
+}
+
+}  // namespace
+
+TEST(JITValidation, notesComparisonsOfRecordedValues)
+{
+    xad::JITCompiler<double> jit;
+    AD x = 1.0, passive = 3.0;
+    jit.registerInput(x);
+    AD y = plainIf(x);
+    EXPECT_EQ(1u, jit.numBakedConditions());
+    EXPECT_EQ(1u, jit.bakedConditions()[0]);  // the input only
+
+    if (x * x > passive)  // expressions
+        y = 2.0 * y;
+    EXPECT_EQ(2u, jit.numBakedConditions());
+    if (passive > 1.0 || passive == 1.0 + passive)  // not recorded
+        y = y + 1.0;
+    EXPECT_EQ(2u, jit.numBakedConditions());
+    if (bool(x - 1.0))  // explicit conversion
+        y = y * x;
+    EXPECT_EQ(3u, jit.numBakedConditions());
+
+    jit.newRecording();
+    EXPECT_EQ(0u, jit.numBakedConditions());
+    jit.deactivate();
+    EXPECT_TRUE(x < 2.0);  // no active compiler
+    jit.activate();
+    EXPECT_EQ(0u, jit.numBakedConditions());
+}
+
+TEST(JITValidation, recordedConditionsAreNotBaked)
+{
+    xad::JITCompiler<double> jit;
+    AD x = 1.0, z = 0.5;
+    jit.registerInput(x);
+    jit.registerInput(z);
+    AD y = recordedIf(x) + max(x, z) + abs(z) + fmin(x, z) + smooth_abs(x - z);
+    jit.registerOutput(y);
+    EXPECT_EQ(0u, jit.numBakedConditions());
+
+    // converting the recorded condition to bool bakes it after all
+    if (xad::greater(x, z))
+        y = y * 2.0;
+    EXPECT_EQ(1u, jit.numBakedConditions());
+}
+
+TEST(JITValidation, matchingReplaysPass)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.0, 0.5};
+    jit.registerInputs(x);
+    std::vector<AD> y;
+    recordedModel(x, y);
+    jit.registerOutputs(y);
+    jit.compile();
+    jit.enableValidation(recordedModel);
+    EXPECT_TRUE(jit.isValidating());
+
+    for (double x0 : {1.0, 3.0, -0.5})
+    {
+        value(x[0]) = x0;
+        jit.computeAdjoints();
+        EXPECT_NEAR((x0 < 2.0 ? 0.5 : 3.5) + std::cos(x0), derivative(x[0]), 1e-14);
+    }
+    const xad::JITValidationStats& stats = jit.validationStats();
+    EXPECT_EQ(3u, stats.replays);
+    EXPECT_EQ(3u, stats.checks);
+    EXPECT_EQ(0u, stats.mismatches);
+    EXPECT_LT(stats.maxValueError, 1e-15);
+    EXPECT_LT(stats.maxGradientError, 1e-15);
+    EXPECT_EQ(&jit, xad::JITCompiler<double>::getActive());
+    EXPECT_EQ(nullptr, xad::Tape<double>::getActive());
+}
+
+TEST(JITValidation, detectsBakedBranch)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.0, 0.5};
+    jit.registerInputs(x);
+    std::vector<AD> y;
+    plainModel(x, y);
+    jit.registerOutputs(y);
+    jit.compile();
+    EXPECT_EQ(1u, jit.numBakedConditions());
+    jit.enableValidation(plainModel);
+
+    jit.computeAdjoints();  // same branch as recorded
+    value(x[0]) = 3.0;
+    EXPECT_THROW(jit.computeAdjoints(), xad::JITValidationError);
+    EXPECT_EQ(1u, jit.validationStats().mismatches);
+    EXPECT_EQ(&jit, xad::JITCompiler<double>::getActive());
+    EXPECT_EQ(nullptr, xad::Tape<double>::getActive());
+
+    // counted only
+    jit.enableValidation(plainModel, 1, 1e-10, false);
+    EXPECT_NO_THROW(jit.computeAdjoints());
+    EXPECT_EQ(1u, jit.validationStats().mismatches);
+    EXPECT_DOUBLE_EQ(6.0 / 7.0, jit.validationStats().maxValueError);
+    EXPECT_DOUBLE_EQ(6.0 / 7.0, jit.validationStats().maxGradientError);
+    // the replay results are kept
+    EXPECT_EQ(0.5, derivative(x[0]));
+}
+
+TEST(JITValidation, samplesReplaysAndKeepsOuterTape)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.0, 0.5};
+    jit.registerInputs(x);
+    std::vector<AD> y;
+    recordedModel(x, y);
+    jit.registerOutputs(y);
+    jit.compile();
+    jit.deactivate();
+    jit.enableValidation(recordedModel, 3);
+
+    xad::Tape<double> tape;
+    for (int i = 0; i < 7; ++i) jit.computeAdjoints();
+    EXPECT_EQ(7u, jit.validationStats().replays);
+    EXPECT_EQ(3u, jit.validationStats().checks);
+    EXPECT_EQ(&tape, xad::Tape<double>::getActive());
+    EXPECT_EQ(nullptr, xad::JITCompiler<double>::getActive());
+
+    jit.disableValidation();
+    jit.computeAdjoints();
+    EXPECT_FALSE(jit.isValidating());
+    EXPECT_EQ(7u, jit.validationStats().replays);
+}
+
+TEST(JITValidation, rejectsFunctionWithOtherOutputs)
+{
+    xad::JITCompiler<double> jit;
+    std::vector<AD> x = {1.0, 0.5};
+    jit.registerInputs(x);
+    std::vector<AD> y;
+    recordedModel(x, y);
+    jit.registerOutputs(y);
+    jit.compile();
+    jit.enableValidation(plainModel);
+    EXPECT_THROW(jit.computeAdjoints(), xad::JITValidationError);
+    EXPECT_EQ(&jit, xad::JITCompiler<double>::getActive());
+}
+
+TEST(JITValidation, vectorModeComparesAllDirections)
+{
+    typedef xad::AReal<double, 2> AD2;
+    auto model = [](const std::vector<AD2>& x, std::vector<AD2>& y) {
+        y.push_back(x[0] * x[1]);
+        AD2 y1 = xad::less(x[0], x[1]).If(x[1] - x[0], log(x[0]));
+        y.push_back(y1);
+    };
+    xad::JITCompiler<double, 2> jit;
+    std::vector<AD2> x = {0.5, 2.0};
+    jit.registerInputs(x);
+    std::vector<AD2> y;
+    model(x, y);
+    jit.registerOutputs(y);
+    jit.compile();
+    jit.enableValidation(model);
+
+    for (double x0 : {0.5, 3.0})
+    {
+        value(x[0]) = x0;
+        derivative(y[0]) = {1.0, 0.0};
+        derivative(y[1]) = {0.0, 2.0};
+        jit.computeAdjoints();
+        EXPECT_DOUBLE_EQ(2.0, derivative(x[0])[0]);
+        EXPECT_DOUBLE_EQ(x0 < 2.0 ? -2.0 : 2.0 / x0, derivative(x[0])[1]);
+    }
+    EXPECT_EQ(2u, jit.validationStats().checks);
+    EXPECT_EQ(0u, jit.validationStats().mismatches);
+}
+
+#endif  // XAD_ENABLE_JIT
@@ -0,0 +1,214 @@
+/*******************************************************************************
+
+   Unit tests for the batch JIT math kernels
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#ifdef XAD_ENABLE_JIT
+
+using xad::JITMathAccuracy;
+
+namespace
+{
+
+// distance between two doubles in units in the last place, via their ordered bit patterns
+double ulpDistance(double a, double b)
+{
+    if (std::isnan(a) && std::isnan(b))
+        return 0.0;
+    int64_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(a));
+    std::memcpy(&ib, &b, sizeof(b));
+    if (ia < 0)
+        ia = std::numeric_limits<int64_t>::min() - ia;
+    if (ib < 0)
+        ib = std::numeric_limits<int64_t>::min() - ib;
+    uint64_t d = ia > ib ? uint64_t(ia) - uint64_t(ib) : uint64_t(ib) - uint64_t(ia);
+    return static_cast<double>(d);
+}
+
+float ulpDistance(float a, float b)
+{
+    if (std::isnan(a) && std::isnan(b))
+        return 0.0f;
+    int32_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(a));
+    std::memcpy(&ib, &b, sizeof(b));
+    if (ia < 0)
+        ia = std::numeric_limits<int32_t>::min() - ia;
+    if (ib < 0)
+        ib = std::numeric_limits<int32_t>::min() - ib;
+    return static_cast<float>(std::abs(static_cast<int64_t>(ia) - static_cast<int64_t>(ib)));
+}
+
+std::vector<double> uniform(double lo, double hi, std::size_t n, unsigned seed)
+{
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> x(n);
+    for (auto& v : x) v = dist(gen);
+    return x;
+}
+
+typedef void (*UnaryKernel)(const double*, double*, std::size_t, JITMathAccuracy);
+typedef double (*UnaryRef)(double);
+
+double maxUlpError(UnaryKernel f, UnaryRef ref, const std::vector<double>& x)
+{
+    std::vector<double> y(x.size());
+    f(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    double worst = 0.0;
+    for (std::size_t i = 0; i < x.size(); ++i)
+        worst = (std::max)(worst, ulpDistance(y[i], ref(x[i])));
+    return worst;
+}
+
+double stdExp(double x) { return std::exp(x); }
+double stdLog(double x) { return std::log(x); }
+double stdSqrt(double x) { return std::sqrt(x); }
+double stdSin(double x) { return std::sin(x); }
+double stdCos(double x) { return std::cos(x); }
+double stdErf(double x) { return std::erf(x); }
+double stdErfc(double x) { return std::erfc(x); }
+
+const std::size_t samples = 20000;
+
+}  // namespace
+
+TEST(JITVectorMath, libmTierIsBitIdentical)
+{
+    std::vector<double> x = uniform(-30.0, 30.0, 1000, 1);
+    std::vector<double> ax(x.size()), y(x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) ax[i] = std::fabs(x[i]);
+
+    xad::vecmath::exp(x.data(), y.data(), x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_EQ(std::exp(x[i]), y[i]);
+    xad::vecmath::log(ax.data(), y.data(), x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_EQ(std::log(ax[i]), y[i]);
+    xad::vecmath::sin(x.data(), y.data(), x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_EQ(std::sin(x[i]), y[i]);
+    xad::vecmath::cos(x.data(), y.data(), x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_EQ(std::cos(x[i]), y[i]);
+    xad::vecmath::erf(x.data(), y.data(), x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_EQ(std::erf(x[i]), y[i]);
+    xad::vecmath::erfc(x.data(), y.data(), x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_EQ(std::erfc(x[i]), y[i]);
+    xad::vecmath::pow(ax.data(), x.data(), y.data(), x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_EQ(std::pow(ax[i], x[i]), y[i]);
+}
+
+TEST(JITVectorMath, fastExpLog)
+{
+    EXPECT_LE(maxUlpError(xad::vecmath::exp<double>, stdExp, uniform(-1.0, 1.0, samples, 2)), 1.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::exp<double>, stdExp, uniform(-708.0, 709.0, samples, 3)),
+              1.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::log<double>, stdLog, uniform(0.5, 2.0, samples, 4)), 1.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::log<double>, stdLog, uniform(1e-300, 1e300, samples, 5)),
+              1.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::sqrt<double>, stdSqrt, uniform(0.0, 1e10, samples, 6)),
+              0.0);
+}
+
+TEST(JITVectorMath, fastSinCos)
+{
+    EXPECT_LE(maxUlpError(xad::vecmath::sin<double>, stdSin, uniform(-4.0, 4.0, samples, 7)), 2.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::cos<double>, stdCos, uniform(-4.0, 4.0, samples, 8)), 2.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::sin<double>, stdSin, uniform(-1e5, 1e5, samples, 9)), 2.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::cos<double>, stdCos, uniform(-1e5, 1e5, samples, 10)),
+              2.0);
+}
+
+TEST(JITVectorMath, fastErfErfc)
+{
+    EXPECT_LE(maxUlpError(xad::vecmath::erf<double>, stdErf, uniform(-0.6, 0.6, samples, 11)), 1.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::erf<double>, stdErf, uniform(-7.0, 7.0, samples, 12)), 1.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::erfc<double>, stdErfc, uniform(-7.0, 7.0, samples, 13)),
+              5.0);
+    EXPECT_LE(maxUlpError(xad::vecmath::erfc<double>, stdErfc, uniform(3.5, 27.0, samples, 14)),
+              5.0);
+}
+
+TEST(JITVectorMath, fastPow)
+{
+    std::vector<double> x = uniform(0.01, 10.0, samples, 15);
+    std::vector<double> p = uniform(-5.0, 5.0, samples, 16);
+    std::vector<double> y(samples);
+    xad::vecmath::pow(x.data(), p.data(), y.data(), samples, JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < samples; ++i)
+    {
+        double bound = 1.0 + 2.0 * std::fabs(p[i] * std::log(x[i]));
+        EXPECT_LE(ulpDistance(y[i], std::pow(x[i], p[i])), bound) << x[i] << "^" << p[i];
+    }
+}
+
+TEST(JITVectorMath, fastSpecialValues)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> x = {0.0, -0.0, inf, -inf, nan, 1000.0, -1000.0, -1.0, 1e-310, 30.0};
+    std::vector<double> y(x.size());
+
+    xad::vecmath::exp(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_LE(ulpDistance(std::exp(x[i]), y[i]), 1.0);
+    xad::vecmath::log(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_LE(ulpDistance(std::log(x[i]), y[i]), 1.0);
+    xad::vecmath::sin(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_LE(ulpDistance(std::sin(x[i]), y[i]), 2.0);
+    xad::vecmath::erf(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_LE(ulpDistance(std::erf(x[i]), y[i]), 1.0);
+    xad::vecmath::erfc(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_LE(ulpDistance(std::erfc(x[i]), y[i]), 5.0);
+
+    std::vector<double> base = {-2.0, 0.0, 2.0, -8.0, inf};
+    std::vector<double> expo = {3.0, 2.0, nan, 1.0 / 3.0, -1.0};
+    std::vector<double> res(base.size());
+    xad::vecmath::pow(base.data(), expo.data(), res.data(), base.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < base.size(); ++i)
+        EXPECT_EQ(0.0, ulpDistance(std::pow(base[i], expo[i]), res[i])) << i;
+}
+
+TEST(JITVectorMath, fastSinglePrecision)
+{
+    std::vector<double> xd = uniform(-20.0, 20.0, samples, 17);
+    std::vector<float> x(xd.begin(), xd.end());
+    std::vector<float> y(x.size());
+
+    xad::vecmath::exp(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i)
+        EXPECT_LE(ulpDistance(static_cast<float>(std::exp(double(x[i]))), y[i]), 1.0f);
+    xad::vecmath::erfc(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i)
+        EXPECT_LE(ulpDistance(static_cast<float>(std::erfc(double(x[i]))), y[i]), 1.0f);
+    xad::vecmath::cos(x.data(), y.data(), x.size(), JITMathAccuracy::Fast);
+    for (std::size_t i = 0; i < x.size(); ++i)
+        EXPECT_LE(ulpDistance(static_cast<float>(std::cos(double(x[i]))), y[i]), 1.0f);
+}
+
+#endif
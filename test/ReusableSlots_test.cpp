@@ -0,0 +1,130 @@
+/*******************************************************************************
+
+   Tests for ReusableSlots, used in Tape to keep track of slots that can be
+   re-used.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+#include <XAD/ReusableSlots.hpp>
+
+namespace
+{
+std::vector<std::pair<unsigned, unsigned>> ranges(const xad::ReusableSlots<unsigned>& s)
+{
+    std::vector<std::pair<unsigned, unsigned>> r;
+    s.forEachRange([&r](unsigned first, unsigned last) { r.emplace_back(first, last); });
+    return r;
+}
+}  // namespace
+
+TEST(ReusableSlots, DefaultIsEmpty)
+{
+    xad::ReusableSlots<unsigned> s;
+    unsigned slot;
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(0u, s.size());
+    EXPECT_FALSE(s.take(slot));
+    EXPECT_EQ(0u, s.numRanges());
+}
+
+TEST(ReusableSlots, TakesMostRecentlyInsertedFirst)
+{
+    xad::ReusableSlots<unsigned> s;
+    s.insert(5);
+    s.insert(200);
+    s.insert(3);
+    EXPECT_EQ(3u, s.size());
+    EXPECT_TRUE(s.contains(200));
+    EXPECT_FALSE(s.contains(4));
+    EXPECT_FALSE(s.contains(100000));
+
+    unsigned slot = 0;
+    ASSERT_TRUE(s.take(slot));
+    EXPECT_EQ(3u, slot);
+    ASSERT_TRUE(s.take(slot));
+    EXPECT_EQ(200u, slot);
+    EXPECT_FALSE(s.contains(200));
+    EXPECT_EQ(1u, s.size());
+}
+
+TEST(ReusableSlots, SkipsErasedSlots)
+{
+    xad::ReusableSlots<unsigned> s;
+    s.insert(1);
+    s.insert(2);
+    s.insert(7);
+    EXPECT_TRUE(s.erase(7));
+    EXPECT_FALSE(s.erase(7));
+    EXPECT_EQ(2u, s.size());
+
+    unsigned slot = 0;
+    ASSERT_TRUE(s.take(slot));
+    EXPECT_EQ(2u, slot);
+    s.insert(7);  // inserted again after being erased
+    ASSERT_TRUE(s.take(slot));
+    EXPECT_EQ(7u, slot);
+    ASSERT_TRUE(s.take(slot));
+    EXPECT_EQ(1u, slot);
+    EXPECT_FALSE(s.take(slot));
+    EXPECT_TRUE(s.empty());
+}
+
+TEST(ReusableSlots, TakesOnlyAfterPosition)
+{
+    xad::ReusableSlots<unsigned> s;
+    s.insert(4);
+    auto pos = s.position();
+    unsigned slot = 0;
+    EXPECT_FALSE(s.take(slot, pos));
+    s.insert(9);
+    s.insert(10);
+    ASSERT_TRUE(s.take(slot, pos));
+    EXPECT_EQ(10u, slot);
+
+    s.truncate(pos);
+    EXPECT_EQ(1u, s.size());
+    EXPECT_FALSE(s.contains(9));
+    EXPECT_TRUE(s.contains(4));
+}
+
+TEST(ReusableSlots, ReportsRanges)
+{
+    xad::ReusableSlots<unsigned> s;
+    for (unsigned i : {3u, 4u, 5u, 8u, 63u, 64u, 130u}) s.insert(i);
+    typedef std::pair<unsigned, unsigned> range;
+    EXPECT_EQ((std::vector<range>{{3, 6}, {8, 9}, {63, 65}, {130, 131}}), ranges(s));
+    EXPECT_EQ(4u, s.numRanges());
+
+    s.eraseFrom(64);
+    EXPECT_EQ((std::vector<range>{{3, 6}, {8, 9}, {63, 64}}), ranges(s));
+    EXPECT_EQ(5u, s.size());
+    s.eraseFrom(4);
+    EXPECT_EQ((std::vector<range>{{3, 4}}), ranges(s));
+    EXPECT_EQ(1u, s.size());
+
+    s.clear();
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(0u, s.numRanges());
+}
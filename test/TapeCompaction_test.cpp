@@ -0,0 +1,186 @@
+/*******************************************************************************
+
+   Tests for compacting the adjoint slots of a tape recording.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+// compressed tapes cannot be compacted
+#ifndef XAD_TAPE_COMPRESSED
+
+namespace
+{
+
+using AD = xad::AReal<double, 1>;
+using tape_type = xad::Tape<double, 1>;
+
+// Euler path keeping every state alive, with reassigned and temporary variables
+std::vector<AD> eulerPath(const std::vector<AD>& x, int steps)
+{
+    std::vector<AD> path = {x[0]};
+    AD drift = x[1] * 0.01;
+    for (int i = 0; i < steps; ++i)
+    {
+        AD z = sin(0.1 * double(i) + x[2]);
+        drift = drift * 0.999 + 0.001 * z;
+        path.push_back(path.back() * (1.0 + drift) + x[2] * z * path.back() * 0.01);
+    }
+    return path;
+}
+
+struct NoopCallback : xad::CheckpointCallback<tape_type>
+{
+    void computeAdjoint(tape_type*) override {}
+};
+
+}  // namespace
+
+TEST(TapeCompaction, matchesUncompactedAdjointsWithFewerSlots)
+{
+    tape_type tape;
+    std::vector<AD> x = {100.0, 0.05, 0.2};
+    tape.registerInputs(x);
+    tape.newRecording();
+    std::vector<AD> path = eulerPath(x, 200);
+    std::vector<AD> y = {path.back(), path[100] * path[50] + x[0]};
+    tape.registerOutputs(y);
+
+    derivative(y[0]) = 1.0;
+    derivative(y[1]) = 2.0;
+    tape.computeAdjoints();
+    std::vector<double> expected;
+    for (auto& xi : x) expected.push_back(derivative(xi));
+    const std::size_t variablesBefore = tape.getNumVariables();
+    const std::size_t memoryBefore = tape.getMemory();
+
+    tape_type::size_type slots = tape.compact(x, y);
+    EXPECT_GE(variablesBefore, 200u);
+    EXPECT_LT(slots, 16u);
+    EXPECT_EQ(0.0, derivative(x[0]));  // adjoints start over
+
+    derivative(y[0]) = 1.0;
+    derivative(y[1]) = 2.0;
+    tape.computeAdjoints();
+    for (std::size_t i = 0; i < x.size(); ++i) EXPECT_DOUBLE_EQ(expected[i], derivative(x[i])) << i;
+    EXPECT_LT(tape.getMemory(), memoryBefore);
+
+    // replays again, one output at a time
+    std::vector<double> g[2];
+    for (std::size_t j = 0; j < 2; ++j)
+    {
+        tape.clearDerivatives();
+        derivative(y[j]) = 1.0;
+        tape.computeAdjoints();
+        for (auto& xi : x) g[j].push_back(derivative(xi));
+    }
+    for (std::size_t i = 0; i < x.size(); ++i)
+        EXPECT_NEAR(expected[i], g[0][i] + 2.0 * g[1][i], 1e-12 * std::abs(expected[i])) << i;
+}
+
+TEST(TapeCompaction, keepsSharedOperandsAndDuplicates)
+{
+    tape_type tape;
+    AD a = 1.5, b = -0.5;
+    tape.registerInput(a);
+    tape.registerInput(b);
+    tape.newRecording();
+    AD t = a * a + b;
+    AD u = t * t * a;  // duplicate operands
+    AD v = u + t;
+    tape.registerOutput(v);
+
+    std::vector<AD*> keep = {&a, &b, &v, &a};
+    EXPECT_EQ(5u, tape.compact(keep));  // a, b and v, plus u and t
+
+    derivative(v) = 1.0;
+    tape.computeAdjoints();
+    const double tv = 1.5 * 1.5 - 0.5;
+    EXPECT_DOUBLE_EQ(2.0 * tv * 2.0 * 1.5 * 1.5 + tv * tv + 2.0 * 1.5, derivative(a));
+    EXPECT_DOUBLE_EQ(2.0 * tv * 1.5 + 1.0, derivative(b));
+}
+
+TEST(TapeCompaction, recordingContinuesAfterCompaction)
+{
+    tape_type tape;
+    std::vector<AD> x = {1.0, 2.0, 0.3};
+    tape.registerInputs(x);
+    tape.newRecording();
+    std::vector<AD> y;
+    {
+        std::vector<AD> path = eulerPath(x, 20);
+        y.push_back(path.back());
+        tape.compact(x, y);
+    }  // stale variables go out of scope
+
+    AD w = y[0] * x[0];
+    AD extra = 3.0 * x[1];
+    w += extra;
+    derivative(w) = 1.0;
+    tape.computeAdjoints();
+    const double dw0 = derivative(x[0]), dw1 = derivative(x[1]);
+
+    tape.deactivate();
+    tape_type reference;
+    std::vector<AD> xr = {1.0, 2.0, 0.3};
+    reference.registerInputs(xr);
+    reference.newRecording();
+    AD wr = eulerPath(xr, 20).back() * xr[0] + 3.0 * xr[1];
+    derivative(wr) = 1.0;
+    reference.computeAdjoints();
+    EXPECT_DOUBLE_EQ(derivative(xr[0]), dw0);
+    EXPECT_DOUBLE_EQ(derivative(xr[1]), dw1);
+}
+
+TEST(TapeCompaction, rejectsCheckpointsAndForeignVariables)
+{
+    std::vector<AD> z = {2.0, 0.1, 0.2};
+    std::vector<AD> w;
+    {
+        tape_type other;
+        other.registerInputs(z);
+        other.newRecording();
+        w = eulerPath(z, 10);
+    }
+
+    tape_type tape;
+    AD x = 1.0;
+    tape.registerInput(x);
+    tape.newRecording();
+    AD y = x * x;
+    std::vector<AD*> keep = {&w.back()};
+    EXPECT_THROW(tape.compact(keep), xad::OutOfRange);
+
+    std::vector<AD*> keepY = {&x, &y};
+    EXPECT_EQ(2u, tape.compact(keepY));
+    derivative(y) = 1.0;
+    tape.computeAdjoints();
+    EXPECT_DOUBLE_EQ(2.0, derivative(x));
+
+    NoopCallback cb;
+    tape.insertCallback(&cb);
+    EXPECT_THROW(tape.compact(keepY), xad::Exception);
+}
+
+#endif
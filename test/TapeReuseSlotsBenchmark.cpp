@@ -0,0 +1,125 @@
+/*******************************************************************************
+
+   Benchmark for recording with many out-of-order variable destructions, which
+   exercises the slot allocator of XAD_TAPE_REUSE_SLOTS.
+
+   Build the tests with and without XAD_TAPE_REUSE_SLOTS to compare.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+// set this to true to run the slot reuse benchmark
+constexpr bool RUN_BENCHMARKS = false;
+
+using AD = xad::AReal<double>;
+
+// Evolves a basket, replacing the state vector each step, so that the previous states are
+// destroyed from the first to the last - all but one of them in the middle of the slots
+AD basket(const std::vector<AD>& x, int steps)
+{
+    std::vector<AD> spots(x);
+    for (int step = 0; step < steps; ++step)
+    {
+        std::vector<AD> next;
+        next.reserve(spots.size());
+        for (std::size_t i = 0; i < spots.size(); ++i)
+        {
+            AD z = sin(double(step * 31 + int(i)));
+            next.push_back(spots[i] * (1.0 + 0.01 * z) + 0.001 * spots[(i + 1) % spots.size()]);
+        }
+        spots.swap(next);
+    }
+    AD total = 0.0;
+    for (auto& s : spots) total += s;
+    return total;
+}
+
+// Replaces the states one at a time in a scattered order, so that slots are freed all over
+AD scattered(const std::vector<AD>& x, int steps)
+{
+    const std::size_t n = x.size();
+    std::vector<std::unique_ptr<AD>> states;
+    for (auto& xi : x) states.emplace_back(new AD(xi));
+    for (int step = 0; step < steps; ++step)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t j = (i * 37 + std::size_t(step)) % n;
+            AD z = sin(double(step * 31 + int(i)));
+            states[j].reset(new AD(*states[j] * (1.0 + 0.01 * z) + 0.001 * *states[(j + 1) % n]));
+        }
+    }
+    AD total = 0.0;
+    for (auto& s : states) total += *s;
+    return total;
+}
+
+template <class F>
+void runBenchmark(const char* name, F model)
+{
+    xad::Tape<double> tape;
+    std::vector<AD> x(64, 100.0);
+    const int repetitions = 50;
+    double recordSeconds = 0.0, sweepSeconds = 0.0;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        tape.registerInputs(x);
+        tape.newRecording();
+        auto t0 = std::chrono::steady_clock::now();
+        AD y = model(x, 2000);
+        auto t1 = std::chrono::steady_clock::now();
+        tape.registerOutput(y);
+        derivative(y) = 1.0;
+        tape.computeAdjoints();
+        auto t2 = std::chrono::steady_clock::now();
+        recordSeconds += std::chrono::duration<double>(t1 - t0).count();
+        sweepSeconds += std::chrono::duration<double>(t2 - t1).count();
+        if (r + 1 == repetitions)
+            std::cout << name << " - statements: " << tape.getNumStatements()
+                      << ", memory: " << tape.getMemory() / 1024 << " kB";
+        tape.clearAll();
+    }
+    std::cout << ", record: " << 1e3 * recordSeconds / repetitions
+              << " ms, sweep: " << 1e3 * sweepSeconds / repetitions << " ms" << std::endl;
+}
+}  // namespace
+
+TEST(TapeReuseSlotsBenchmark, inOrderDestruction)
+{
+    if (!RUN_BENCHMARKS)
+        GTEST_SKIP() << "Skipping benchmark by default";
+    runBenchmark("in order", basket);
+}
+
+TEST(TapeReuseSlotsBenchmark, scatteredDestruction)
+{
+    if (!RUN_BENCHMARKS)
+        GTEST_SKIP() << "Skipping benchmark by default";
+    runBenchmark("scattered", scattered);
+}
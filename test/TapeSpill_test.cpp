@@ -0,0 +1,220 @@
+/*******************************************************************************
+
+   Tests for spilling tape chunks to disk.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/ChunkContainer.hpp>
+#include <XAD/OperationsContainer.hpp>
+#include <XAD/OperationsContainerPaired.hpp>
+#include <XAD/XAD.hpp>
+#include <gmock/gmock.h>
+
+#include <utility>
+#include <vector>
+
+using namespace testing;
+
+template <typename C>
+class OperationsContainerSpillTest : public Test
+{
+};
+
+using spill_containers = ::testing::Types<xad::OperationsContainer<double, int, 4>,
+                                          xad::OperationsContainerPaired<double, int, 4>>;
+
+TYPED_TEST_SUITE(OperationsContainerSpillTest, spill_containers);
+
+TYPED_TEST(OperationsContainerSpillTest, readsSpilledChunksBack)
+{
+    auto c = TypeParam();
+    c.push_back(0.0, 0);
+    c.enable_spill(TempDir());
+    EXPECT_TRUE(c.spilling());
+    for (int i = 1; i < 50; ++i) c.push_back(double(i), i);
+    EXPECT_EQ(12u, c.spilled_chunks());
+    EXPECT_EQ(12u * std::size_t(TypeParam::CHUNK_BYTES), c.spilled_bytes());
+
+    // reverse sweep, as in computeAdjoints
+    std::vector<int> seen;
+    for (int i = 49; i > 0; --i)
+        c.for_each(std::size_t(i - 1), std::size_t(i),
+                   [&](double m, int s)
+                   {
+                       EXPECT_EQ(double(s), m);
+                       seen.push_back(s);
+                   });
+    ASSERT_EQ(49u, seen.size());
+    for (int i = 0; i < 49; ++i) EXPECT_EQ(48 - i, seen[std::size_t(i)]);
+
+    // random access
+    for (int i : {3, 41, 0, 17, 18, 49, 2}) EXPECT_THAT(c[std::size_t(i)], Pair(double(i), i));
+}
+
+TYPED_TEST(OperationsContainerSpillTest, resizesBackIntoSpilledChunks)
+{
+    auto c = TypeParam();
+    c.enable_spill(TempDir());
+    auto m = {0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0};
+    auto s = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    for (int i = 0; i < 4; ++i) c.append_n(m.begin(), s.begin(), 10);
+    EXPECT_EQ(10u, c.spilled_chunks());
+
+    c.resize(13);
+    EXPECT_EQ(3u, c.spilled_chunks());
+    EXPECT_EQ(13u, c.size());
+    for (int i = 0; i < 20; ++i) c.push_back(-1.0, -1);
+    EXPECT_EQ(8u, c.spilled_chunks());
+    for (int i = 0; i < 33; ++i)
+    {
+        if (i < 13)
+            EXPECT_THAT(c[std::size_t(i)], Pair(double(i % 10), i % 10));
+        else
+            EXPECT_THAT(c[std::size_t(i)], Pair(-1.0, -1));
+    }
+
+    c.clear();
+    EXPECT_EQ(0u, c.spilled_chunks());
+    c.push_back(1.0, 1);
+    EXPECT_THAT(c[0], Pair(1.0, 1));
+}
+
+TYPED_TEST(OperationsContainerSpillTest, disablingReadsAllChunksBack)
+{
+    auto c = TypeParam();
+    c.enable_spill(TempDir());
+    for (int i = 0; i < 30; ++i) c.push_back(double(i), i);
+    c.disable_spill();
+    EXPECT_FALSE(c.spilling());
+    EXPECT_EQ(0u, c.spilled_chunks());
+    for (int i = 29; i >= 0; --i) EXPECT_THAT(c[std::size_t(i)], Pair(double(i), i));
+}
+
+TYPED_TEST(OperationsContainerSpillTest, rejectsMissingDirectory)
+{
+    auto c = TypeParam();
+    EXPECT_THROW(c.enable_spill("/nonexistent-xad-directory/sub"), xad::Exception);
+    EXPECT_FALSE(c.spilling());
+}
+
+TEST(ChunkContainerSpill, readsSpilledChunksBack)
+{
+    xad::ChunkContainer<std::pair<int, int>, 8> c;
+    c.enable_spill(TempDir());
+    for (int i = 0; i < 100; ++i) c.push_back(std::make_pair(i, -i));
+    EXPECT_EQ(12u, c.spilled_chunks());
+
+    for (std::size_t k = 12; k-- > 0;)
+    {
+        c.load_chunk(k);
+        auto chunk = c.chunk_begin()[k];
+        for (int i = 0; i < 8; ++i) EXPECT_EQ(int(k) * 8 + i, chunk[i].first);
+    }
+
+    c.resize(20);
+    EXPECT_EQ(2u, c.spilled_chunks());
+    c.push_back(std::make_pair(-1, 1));
+    EXPECT_EQ(19, c[19].first);
+    EXPECT_EQ(-1, c[20].first);
+    EXPECT_EQ(5, c[5].first);
+}
+
+// compressed tapes are not spilled
+#ifndef XAD_TAPE_COMPRESSED
+
+namespace
+{
+// 9M statements of one operation each, over one chunk of both - multiplying by 2 and 0.5
+// in turn keeps all adjoints exact
+const int SPILL_STATEMENTS = 9000000;
+
+template <class AD>
+AD recordLong(std::vector<AD>& x)
+{
+    AD y = x[0];
+    for (int i = 1; i <= SPILL_STATEMENTS; ++i)
+    {
+        if (i % (SPILL_STATEMENTS / 10) == 0 && i < SPILL_STATEMENTS)
+            y = y * 0.5 + x[std::size_t(i / (SPILL_STATEMENTS / 10))] * double(i);
+        else if (i % 2 == 0)
+            y = y * 0.5;
+        else
+            y = y * 2.0;
+    }
+    return y;
+}
+}  // namespace
+
+TEST(TapeSpill, adjointsOfSpilledRecording)
+{
+    using tape_type = xad::Tape<double>;
+    using AD = xad::AReal<double>;
+    tape_type tape;
+    tape.enableSpill(TempDir());
+    EXPECT_TRUE(tape.isSpilling());
+
+    std::vector<AD> x(10, 1.0);
+    tape.registerInputs(x);
+    tape.newRecording();
+    AD y = recordLong(x);
+    tape.registerOutput(y);
+    EXPECT_GT(tape.getSpilledMemory(), 0u);
+
+    for (double seed : {1.0, 3.0})
+    {
+        tape.clearDerivatives();
+        derivative(y) = seed;
+        tape.computeAdjoints();
+        EXPECT_EQ(seed, derivative(x[0]));
+        for (std::size_t k = 1; k < 10; ++k)
+            EXPECT_EQ(seed * double(k * std::size_t(SPILL_STATEMENTS / 10)), derivative(x[k])) << k;
+    }
+
+    // recording again re-uses the file
+    tape.newRecording();
+    AD z = x[1] * x[2];
+    tape.registerOutput(z);
+    derivative(z) = 1.0;
+    tape.computeAdjoints();
+    EXPECT_EQ(1.0, derivative(x[1]));
+
+    EXPECT_THROW(tape.compact(x, x), xad::Exception);
+    tape.disableSpill();
+    EXPECT_FALSE(tape.isSpilling());
+    EXPECT_EQ(0u, tape.getSpilledMemory());
+}
+
+TEST(TapeSpill, smallRecordingsStayInMemory)
+{
+    xad::Tape<double> tape;
+    tape.enableSpill(TempDir());
+    xad::AReal<double> x = 2.0;
+    tape.registerInput(x);
+    tape.newRecording();
+    xad::AReal<double> y = sin(x) * x;
+    tape.registerOutput(y);
+    derivative(y) = 1.0;
+    tape.computeAdjoints();
+    EXPECT_DOUBLE_EQ(std::cos(2.0) * 2.0 + std::sin(2.0), derivative(x));
+    EXPECT_EQ(0u, tape.getSpilledMemory());
+}
+
+#endif
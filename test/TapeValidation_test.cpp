@@ -0,0 +1,124 @@
+/*******************************************************************************
+
+   Tests for validating tape gradients against forward mode.
+
+   This file is part of XAD, a comprehensive C++ library for
+   automatic differentiation.
+
+   Copyright (C) 2010-2025 Xcelerit Computing Ltd.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <XAD/TapeValidation.hpp>
+#include <XAD/XAD.hpp>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+// discounted payoffs of a few strikes on a log-normal path, with multipliers that are
+// not representable in single precision
+template <class T>
+std::vector<T> payoffs(std::vector<T>& x)
+{
+    T s = x[0];
+    for (int i = 0; i < 50; ++i)
+        s = s * exp(x[1] * 0.01 - 0.5 * x[2] * x[2] * 0.01 + x[2] * std::sin(double(i)) * 0.1);
+    std::vector<T> y;
+    for (double k : {90.0, 100.0, 110.0}) y.push_back(max(s - k, 0.0) * exp(-x[3]));
+    return y;
+}
+
+std::vector<xad::AReal<double>> adjointPayoffs(std::vector<xad::AReal<double>>& x)
+{
+    return payoffs(x);
+}
+
+std::vector<xad::FReal<double>> forwardPayoffs(std::vector<xad::FReal<double>>& x)
+{
+    return payoffs(x);
+}
+}  // namespace
+
+TEST(TapeValidation, comparesAgainstForwardMode)
+{
+    xad::Tape<double> tape;
+    std::vector<double> x = {105.0, 0.03, 0.2, 0.02};
+    auto result = xad::validateTapeGradients<double>(x, adjointPayoffs, forwardPayoffs, &tape);
+
+    ASSERT_EQ(3u, result.adjoint.size());
+    ASSERT_EQ(3u, result.reference.size());
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(4u, result.adjoint[i].size());
+        for (std::size_t j = 0; j < 4; ++j)
+            EXPECT_NEAR(result.reference[i][j], result.adjoint[i][j],
+                        1e-5 * std::abs(result.reference[i][0]))
+                << i << ", " << j;
+    }
+    EXPECT_GT(std::abs(result.reference[0][0]), 0.5);
+    EXPECT_LT(result.output, 3u);
+    EXPECT_LT(result.input, 4u);
+
+#ifdef XAD_TAPE_FLOAT_MULTIPLIERS
+    // single-precision rounding of the multipliers
+    EXPECT_GT(result.maxRelError, 1e-12);
+    EXPECT_LT(result.maxRelError, 1e-5);
+#else
+    EXPECT_LT(result.maxRelError, 1e-12);
+#endif
+}
+
+TEST(TapeValidation, createsTapeIfNoneIsActive)
+{
+    std::vector<double> x = {95.0, 0.01, 0.3, 0.0};
+    auto result = xad::validateTapeGradients<double>(x, adjointPayoffs, forwardPayoffs, nullptr);
+    EXPECT_EQ(3u, result.adjoint.size());
+    // out of the money for the last strike
+    for (double d : result.reference[2]) EXPECT_EQ(0.0, d);
+    EXPECT_LT(result.maxRelError, 1e-5);
+}
+
+TEST(TapeValidation, reportsLargestError)
+{
+    std::vector<double> x = {1.0, 2.0};
+    xad::Tape<double> tape;
+    auto result = xad::validateTapeGradients<double>(
+        x,
+        [](std::vector<xad::AReal<double>>& v)
+        { return std::vector<xad::AReal<double>>{v[0] * v[1], v[0] + v[1]}; },
+        // a wrong derivative of the second output with respect to the first input
+        [](std::vector<xad::FReal<double>>& v)
+        { return std::vector<xad::FReal<double>>{v[0] * v[1], 1.5 * v[0] + v[1]}; },
+        &tape);
+    EXPECT_DOUBLE_EQ(0.5, result.maxAbsError);
+    EXPECT_DOUBLE_EQ(0.5 / 1.5, result.maxRelError);
+    EXPECT_EQ(1u, result.output);
+    EXPECT_EQ(0u, result.input);
+}
+
+#ifdef XAD_TAPE_FLOAT_MULTIPLIERS
+TEST(TapeValidation, floatMultipliersForDoubleTapesOnly)
+{
+    EXPECT_TRUE((std::is_same<xad::TapeContainerTraits<double>::mul_type, float>::value));
+    EXPECT_TRUE((std::is_same<xad::TapeContainerTraits<float>::mul_type, float>::value));
+    EXPECT_TRUE((std::is_same<xad::TapeContainerTraits<xad::FReal<double>>::mul_type,
+                              xad::FReal<double>>::value));
+}
+#endif